@@ -0,0 +1,254 @@
+/* This example converts every object map of a directory to another label image format, or every
+label image of a directory to an object map.  The files are converted in parallel, outputs that are
+newer than their inputs are skipped, and the throughput of every file is reported.  Object maps
+hold no geometry, so the spacing, origin and direction of an object map are taken from the header
+of a .nii, .nii.gz or .hdr file next to it with the same name, when there is one.
+
+ConvertObjectMaps labels/ converted/ .nii.gz 8
+ConvertObjectMaps converted/ labels/ .obj
+*/
+
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkAnalyzeObjectLabelMapImageIO.h"
+#include "itkAnalyzeObjectLabelMapImageIOFactory.h"
+#include "itkAnalyzeObjectLabelMapImageIOPool.h"
+#include "itkMultiThreaderBase.h"
+#include "itksys/Directory.hxx"
+#include "itksys/SystemTools.hxx"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+constexpr unsigned int Dimension = 3;
+
+// The extensions of the label images converted to object maps.
+const char * const LabelImageExtensions[] = { ".nii", ".nii.gz", ".hdr", ".nrrd", ".nhdr", ".mha", ".mhd" };
+
+bool
+HasExtension(const std::string & fileName, const std::string & extension)
+{
+  return fileName.size() > extension.size() &&
+         fileName.compare(fileName.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+// Returns the file name without its directory and extension, .nii.gz being a single extension.
+std::string
+GetStem(const std::string & fileName)
+{
+  std::string name = itksys::SystemTools::GetFilenameName(fileName);
+  if (HasExtension(name, ".gz"))
+  {
+    name.resize(name.size() - 3);
+  }
+  return itksys::SystemTools::GetFilenameWithoutLastExtension(name);
+}
+
+// Returns true if outputFileName exists and is not older than any of the inputs.
+bool
+IsUpToDate(const std::string & outputFileName, const std::vector<std::string> & inputFileNames)
+{
+  if (!itksys::SystemTools::FileExists(outputFileName, true))
+  {
+    return false;
+  }
+  for (const std::string & inputFileName : inputFileNames)
+  {
+    int result = 0;
+    if (!itksys::SystemTools::FileTimeCompare(outputFileName, inputFileName, &result) || result < 0)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Reads inputFileName and writes its labels to outputFileName, reading or writing the object map
+// with io.  The geometry of object maps is taken from the image next to them.  Returns the number
+// of voxels.
+template <typename TPixel>
+itk::SizeValueType
+ConvertFile(const std::string &                 inputFileName,
+            const std::string &                 outputFileName,
+            itk::AnalyzeObjectLabelMapImageIO * io)
+{
+  using ImageType = itk::Image<TPixel, Dimension>;
+  using ReaderType = itk::ImageFileReader<ImageType>;
+  using WriterType = itk::ImageFileWriter<ImageType>;
+
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(inputFileName);
+  if (HasExtension(inputFileName, ".obj"))
+  {
+    // The IO goes back to the pool with the setting it came with, even if the read throws.
+    const bool useSiblingGeometry = io->GetUseSiblingGeometry();
+    io->SetUseSiblingGeometry(true);
+    reader->SetImageIO(io);
+    try
+    {
+      reader->Update();
+    }
+    catch (...)
+    {
+      io->SetUseSiblingGeometry(useSiblingGeometry);
+      throw;
+    }
+    io->SetUseSiblingGeometry(useSiblingGeometry);
+  }
+  else
+  {
+    reader->Update();
+  }
+
+  typename WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(reader->GetOutput());
+  writer->SetFileName(outputFileName);
+  if (HasExtension(outputFileName, ".obj"))
+  {
+    writer->SetImageIO(io);
+  }
+  writer->Update();
+  return reader->GetOutput()->GetLargestPossibleRegion().GetNumberOfPixels();
+}
+} // namespace
+
+int
+main(int argc, char ** argv)
+{
+  if (argc != 4 && argc != 5)
+  {
+    std::cerr << "USAGE: " << argv[0] << " <inputDirectory> <outputDirectory> <outputExtension> [numberOfThreads]"
+              << std::endl;
+    std::cerr << "  With an outputExtension of .obj, the label images of inputDirectory are converted to object maps;"
+              << std::endl;
+    std::cerr << "  otherwise its object maps are converted to label images of the given extension." << std::endl;
+    return EXIT_FAILURE;
+  }
+  const std::string  InputDirectory = argv[1];
+  const std::string  OutputDirectory = argv[2];
+  const std::string  OutputExtension = argv[3];
+  const unsigned int NumberOfThreads =
+    argc == 5 ? std::max(1, std::atoi(argv[4])) : itk::MultiThreaderBase::GetGlobalDefaultNumberOfThreads();
+  const bool         ToObjectMaps = OutputExtension == ".obj";
+
+  // This is very important to use if you are not going to install the Analyze Object map code directly into
+  // itk.  This means that you can build the Analyze Object map outside of ITK and still use it and treat
+  // the code as if it is in ITK.
+  itk::ObjectFactoryBase::RegisterFactory(itk::AnalyzeObjectLabelMapImageIOFactory::New());
+
+  itksys::Directory directory;
+  if (!directory.Load(InputDirectory))
+  {
+    std::cerr << "Could not list " << InputDirectory << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::vector<std::string> inputFileNames;
+  for (unsigned long i = 0; i < directory.GetNumberOfFiles(); i++)
+  {
+    const std::string name = directory.GetFile(i);
+    bool              isInput = false;
+    if (ToObjectMaps)
+    {
+      for (const char * extension : LabelImageExtensions)
+      {
+        isInput = isInput || HasExtension(name, extension);
+      }
+    }
+    else
+    {
+      isInput = HasExtension(name, ".obj");
+    }
+    if (isInput)
+    {
+      inputFileNames.push_back(InputDirectory + "/" + name);
+    }
+  }
+  std::sort(inputFileNames.begin(), inputFileNames.end());
+  if (!itksys::SystemTools::MakeDirectory(OutputDirectory))
+  {
+    std::cerr << "Could not create " << OutputDirectory << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Every thread takes the next unconverted file until none is left, so a few large files do not
+  // hold up the others.  The object map IOs come from a pool, so that their buffers are allocated
+  // once per thread rather than once per file.
+  itk::AnalyzeObjectLabelMapImageIOPool pool;
+  std::atomic<itk::SizeValueType> nextFile(0);
+  std::atomic<itk::SizeValueType> numberOfConverted(0), numberOfSkipped(0), numberOfFailed(0);
+  std::atomic<itk::SizeValueType> totalBytes(0);
+  std::mutex                      outputMutex;
+  const auto                      start = std::chrono::steady_clock::now();
+
+  auto convertFiles = [&]() {
+    for (itk::SizeValueType i = nextFile++; i < inputFileNames.size(); i = nextFile++)
+    {
+      const std::string & inputFileName = inputFileNames[i];
+      const std::string   outputFileName = OutputDirectory + "/" + GetStem(inputFileName) + OutputExtension;
+
+      // An object map is out of date when the image its geometry comes from has changed as well.
+      std::vector<std::string>                    sources(1, inputFileName);
+      itk::AnalyzeObjectSiblingGeometry::Geometry geometry;
+      if (!ToObjectMaps && itk::AnalyzeObjectSiblingGeometry::GetInstance().Find(inputFileName, geometry))
+      {
+        sources.push_back(geometry.FileName);
+      }
+      if (IsUpToDate(outputFileName, sources))
+      {
+        numberOfSkipped++;
+        continue;
+      }
+
+      std::ostringstream report;
+      const auto         fileStart = std::chrono::steady_clock::now();
+      try
+      {
+        itk::AnalyzeObjectLabelMapImageIOPool::Lease io(pool);
+        const itk::SizeValueType                     numberOfVoxels =
+          ToObjectMaps ? ConvertFile<unsigned short>(inputFileName, outputFileName, io.Get())
+                       : ConvertFile<unsigned char>(inputFileName, outputFileName, io.Get());
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - fileStart).count();
+        const auto   bytes = static_cast<itk::SizeValueType>(itksys::SystemTools::FileLength(inputFileName));
+        totalBytes += bytes;
+        numberOfConverted++;
+        report << std::fixed << std::setprecision(3) << inputFileName << " -> " << outputFileName << ": "
+               << numberOfVoxels << " voxels, " << bytes / 1.0e6 << " MB in " << seconds << " s ("
+               << numberOfVoxels / 1.0e6 / std::max(seconds, 1e-9) << " Mvoxels/s)" << std::endl;
+      }
+      catch (itk::ExceptionObject & err)
+      {
+        numberOfFailed++;
+        report << "Could not convert " << inputFileName << ": " << err.GetDescription() << std::endl;
+      }
+      const std::lock_guard<std::mutex> lock(outputMutex);
+      std::cout << report.str() << std::flush;
+    }
+  };
+  std::vector<std::thread> threads;
+  for (unsigned int t = 1; t < NumberOfThreads; t++)
+  {
+    threads.emplace_back(convertFiles);
+  }
+  convertFiles();
+  for (auto & thread : threads)
+  {
+    thread.join();
+  }
+
+  const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::cout << std::fixed << std::setprecision(3) << numberOfConverted << " converted, " << numberOfSkipped
+            << " up to date, " << numberOfFailed << " failed; " << totalBytes / 1.0e6 << " MB read in " << seconds
+            << " s (" << numberOfConverted / std::max(seconds, 1e-9) << " files/s) with " << NumberOfThreads
+            << " threads" << std::endl;
+
+  return numberOfFailed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -29,6 +29,7 @@
 #include "itksys/SystemTools.hxx"
 #include "itkImageIOBase.h"
 
+#include "itkAnalyzeObjectEntryRecord.h"
 #include "AnalyzeObjectLabelMapExport.h"
 
 namespace itk
@@ -78,6 +79,22 @@ public:
   void
   Copy(AnalyzeObjectEntry::Pointer rhs);
 
+  /**
+   * \brief CopyFromRecord
+   *
+   * Sets every ivar, the name included, from a plain entry record decoded from a file.
+   */
+  void
+  CopyFromRecord(const AnalyzeObjectEntryRecord & record);
+
+  /**
+   * \brief CopyToRecord
+   *
+   * Copies every ivar, the name included, into a plain entry record that can be encoded into a file.
+   */
+  void
+  CopyToRecord(AnalyzeObjectEntryRecord & record) const;
+
   /**
    * \brief getName/setName
    *
@@ -559,7 +576,9 @@ public:
    *\brief SwapObjectEndeness
    *
    *This function will change the object endedness if the computer is a little endian machine,
-   *since the object maps are written in big endian.
+   *since the object maps are written in big endian.  It changes the entry itself; the object maps
+   *are written through CopyToRecord() and AnalyzeObjectMapHeaderRecord::Encode() instead, which
+   *leave the entries untouched.
    */
   void
   SwapObjectEndedness();
@@ -0,0 +1,163 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkAnalyzeObjectEntryRecord_h
+#define itkAnalyzeObjectEntryRecord_h
+
+#include "itkIntTypes.h"
+#include "AnalyzeObjectLabelMapExport.h"
+
+#include <string>
+#include <vector>
+
+namespace itk
+{
+/** \class AnalyzeObjectEntryRecord
+ *  \ingroup AnalyzeObjectLabelMap
+ *  \ingroup AnalyzeObjectMapIO
+ *  \brief A plain copy of one object entry of an object map, in native byte order.
+ *
+ * Holds the same fields as AnalyzeObjectEntry, in the order they are stored in the file, but is
+ * a plain struct: decoding it allocates nothing, so catalogues of many files can be built
+ * without creating an ITK object per entry.
+ */
+struct AnalyzeObjectLabelMap_EXPORT AnalyzeObjectEntryRecord
+{
+  /** Number of bytes of an entry in the file. */
+  static constexpr SizeValueType SizeInFile = 152;
+
+  char          Name[33]; // The 32 bytes of the file, always followed by a terminating null.
+  int           DisplayFlag;
+  unsigned char CopyFlag;
+  unsigned char MirrorFlag;
+  unsigned char StatusFlag;
+  unsigned char NeighborsUsedFlag;
+  int           Shades;
+  int           StartRed;
+  int           StartGreen;
+  int           StartBlue;
+  int           EndRed;
+  int           EndGreen;
+  int           EndBlue;
+  int           XRotation;
+  int           YRotation;
+  int           ZRotation;
+  int           XTranslation;
+  int           YTranslation;
+  int           ZTranslation;
+  int           XCenter;
+  int           YCenter;
+  int           ZCenter;
+  int           XRotationIncrement;
+  int           YRotationIncrement;
+  int           ZRotationIncrement;
+  int           XTranslationIncrement;
+  int           YTranslationIncrement;
+  int           ZTranslationIncrement;
+  short int     MinimumXValue;
+  short int     MinimumYValue;
+  short int     MinimumZValue;
+  short int     MaximumXValue;
+  short int     MaximumYValue;
+  short int     MaximumZValue;
+  float         Opacity;
+  int           OpacityThickness;
+  float         BlendFactor;
+
+  /** Decodes the SizeInFile bytes of an entry, stored big endian when bigEndian is true and
+   * little endian otherwise. */
+  void
+  Decode(const unsigned char * bytes, bool bigEndian);
+
+  /** Encodes the entry into SizeInFile bytes, big endian when bigEndian is true and little
+   * endian otherwise. */
+  void
+  Encode(unsigned char * bytes, bool bigEndian) const;
+
+  /** Appends to fieldNames the name of every field, Name included, whose value differs from the
+   * one of other. */
+  void
+  GetDifferingFields(const AnalyzeObjectEntryRecord & other, std::vector<std::string> & fieldNames) const;
+};
+
+/** \class AnalyzeObjectMapHeaderRecord
+ *  \ingroup AnalyzeObjectLabelMap
+ *  \ingroup AnalyzeObjectMapIO
+ *  \brief The header and, optionally, the object entries of an object map.
+ *
+ * Filled by AnalyzeObjectLabelMapImageIO::ProbeHeader() without creating any ITK object, and
+ * serialized by AnalyzeObjectLabelMapImageIO when an object map is written.
+ */
+struct AnalyzeObjectLabelMap_EXPORT AnalyzeObjectMapHeaderRecord
+{
+  /** Number of bytes of the largest header, the one of VERSION7 files. */
+  static constexpr SizeValueType MaximumHeaderSizeInFile = 24;
+
+  /** True if the header could be decoded. */
+  bool Valid{ false };
+
+  /** True if the file is big endian, as all valid object maps should be. */
+  bool BigEndian{ true };
+
+  /** One of VERSION1 to VERSION7. */
+  int Version{ 0 };
+
+  /** Size of the x, y, z and t dimensions. */
+  int Dimensions[4]{ 0, 0, 0, 0 };
+
+  /** Number of object entries, the background included. */
+  int NumberOfObjects{ 0 };
+
+  /** Byte offset of the run length encoded data in the file. */
+  SizeValueType DataOffset{ 0 };
+
+  /** The object entries, empty unless they were requested. */
+  std::vector<AnalyzeObjectEntryRecord> Entries;
+
+  /**
+   * \brief Decode
+   *
+   * Decodes the header, and the entries if readEntries is true, from the first numberOfBytes
+   * bytes of a file.  Both byte orders and all versions are recognized.  Returns false, and
+   * leaves Valid false, if the bytes do not start with a valid header or are too few to hold
+   * the requested entries.
+   */
+  bool
+  Decode(const unsigned char * bytes, SizeValueType numberOfBytes, bool readEntries);
+
+  /**
+   * \brief Encode
+   *
+   * Serializes the header and the entries into bytes, in the layout of Version and in the byte
+   * order given by bigEndian.  The number of objects written is the number of entries, and the
+   * t dimension is only written for VERSION7.  The fields are stored in native byte order and
+   * then converted in a single pass over the buffer; neither the record nor the entries it was
+   * filled from are changed.
+   */
+  void
+  Encode(std::vector<unsigned char> & bytes, bool bigEndian) const;
+
+  /** Size of the header in the file: 24 bytes for VERSION7, 20 bytes for earlier versions. */
+  SizeValueType
+  GetHeaderSizeInFile() const
+  {
+    return this->DataOffset - this->NumberOfObjects * AnalyzeObjectEntryRecord::SizeInFile;
+  }
+};
+} // end namespace itk
+
+#endif // itkAnalyzeObjectEntryRecord_h
@@ -0,0 +1,236 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkAnalyzeObjectEntryTable_h
+#define itkAnalyzeObjectEntryTable_h
+
+#include "itkAnalyzeObjectEntry.h"
+#include "itkAnalyzeObjectEntryRecord.h"
+#include "AnalyzeObjectLabelMapExport.h"
+
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace itk
+{
+constexpr const char * const ANALYZE_OBJECT_LABEL_MAP_ENTRY_TABLE{ "ANALYZE_OBJECT_LABEL_MAP_ENTRY_TABLE" };
+
+/** Defines the Get and Set methods of a field of an entry view. */
+#define itkAnalyzeObjectEntryViewFieldMacro(name, type, argumentType) \
+  type Get##name() const { return this->m_Record->name; }             \
+  void Set##name(argumentType _arg) { this->m_Record->name = static_cast<type>(_arg); }
+
+/** \class AnalyzeObjectEntryView
+ *  \ingroup AnalyzeObjectLabelMap
+ *  \ingroup AnalyzeObjectMapIO
+ *  \brief The getters and setters of AnalyzeObjectEntry on an entry record held elsewhere.
+ *
+ * A view is a pointer to a record of an AnalyzeObjectEntryTable, and is as cheap to copy.  The
+ * setters are only available when TRecord is not const.  A view is invalidated when the number
+ * of entries of its table changes.
+ */
+template <typename TRecord>
+class AnalyzeObjectEntryView
+{
+public:
+  explicit AnalyzeObjectEntryView(TRecord * record)
+    : m_Record(record)
+  {}
+
+  /** The record the view looks at. */
+  TRecord &
+  GetRecord() const
+  {
+    return *this->m_Record;
+  }
+
+  std::string
+  GetName() const
+  {
+    return std::string(this->m_Record->Name);
+  }
+
+  /** Sets the name, truncated to 31 characters as AnalyzeObjectEntry::SetName() does. */
+  void
+  SetName(const std::string & _arg)
+  {
+    std::memset(this->m_Record->Name, 0, sizeof(this->m_Record->Name));
+    std::strncpy(this->m_Record->Name, _arg.c_str(), 31);
+  }
+
+  itkAnalyzeObjectEntryViewFieldMacro(DisplayFlag, int, int);
+  itkAnalyzeObjectEntryViewFieldMacro(CopyFlag, unsigned char, unsigned char);
+  itkAnalyzeObjectEntryViewFieldMacro(MirrorFlag, unsigned char, unsigned char);
+  itkAnalyzeObjectEntryViewFieldMacro(StatusFlag, unsigned char, unsigned char);
+  itkAnalyzeObjectEntryViewFieldMacro(NeighborsUsedFlag, unsigned char, unsigned char);
+  itkAnalyzeObjectEntryViewFieldMacro(Shades, int, int);
+  itkAnalyzeObjectEntryViewFieldMacro(StartRed, int, int);
+  itkAnalyzeObjectEntryViewFieldMacro(StartGreen, int, int);
+  itkAnalyzeObjectEntryViewFieldMacro(StartBlue, int, int);
+  itkAnalyzeObjectEntryViewFieldMacro(EndRed, int, int);
+  itkAnalyzeObjectEntryViewFieldMacro(EndGreen, int, int);
+  itkAnalyzeObjectEntryViewFieldMacro(EndBlue, int, int);
+  itkAnalyzeObjectEntryViewFieldMacro(XRotation, int, int);
+  itkAnalyzeObjectEntryViewFieldMacro(YRotation, int, int);
+  itkAnalyzeObjectEntryViewFieldMacro(ZRotation, int, int);
+  itkAnalyzeObjectEntryViewFieldMacro(XTranslation, int, int);
+  itkAnalyzeObjectEntryViewFieldMacro(YTranslation, int, int);
+  itkAnalyzeObjectEntryViewFieldMacro(ZTranslation, int, int);
+  itkAnalyzeObjectEntryViewFieldMacro(XCenter, int, int);
+  itkAnalyzeObjectEntryViewFieldMacro(YCenter, int, int);
+  itkAnalyzeObjectEntryViewFieldMacro(ZCenter, int, int);
+  itkAnalyzeObjectEntryViewFieldMacro(XRotationIncrement, int, int);
+  itkAnalyzeObjectEntryViewFieldMacro(YRotationIncrement, int, int);
+  itkAnalyzeObjectEntryViewFieldMacro(ZRotationIncrement, int, int);
+  itkAnalyzeObjectEntryViewFieldMacro(XTranslationIncrement, int, int);
+  itkAnalyzeObjectEntryViewFieldMacro(YTranslationIncrement, int, int);
+  itkAnalyzeObjectEntryViewFieldMacro(ZTranslationIncrement, int, int);
+  itkAnalyzeObjectEntryViewFieldMacro(MinimumXValue, short int, int);
+  itkAnalyzeObjectEntryViewFieldMacro(MinimumYValue, short int, int);
+  itkAnalyzeObjectEntryViewFieldMacro(MinimumZValue, short int, int);
+  itkAnalyzeObjectEntryViewFieldMacro(MaximumXValue, short int, int);
+  itkAnalyzeObjectEntryViewFieldMacro(MaximumYValue, short int, int);
+  itkAnalyzeObjectEntryViewFieldMacro(MaximumZValue, short int, int);
+  itkAnalyzeObjectEntryViewFieldMacro(Opacity, float, float);
+  itkAnalyzeObjectEntryViewFieldMacro(OpacityThickness, int, int);
+  itkAnalyzeObjectEntryViewFieldMacro(BlendFactor, float, float);
+
+  /** Copies every field but the name from another view, as AnalyzeObjectEntry::Copy() does. */
+  template <typename TOtherRecord>
+  void
+  Copy(const AnalyzeObjectEntryView<TOtherRecord> & rhs)
+  {
+    char name[sizeof(this->m_Record->Name)];
+    std::memcpy(name, this->m_Record->Name, sizeof(name));
+    *this->m_Record = rhs.GetRecord();
+    std::memcpy(this->m_Record->Name, name, sizeof(name));
+  }
+
+private:
+  TRecord * m_Record;
+};
+
+#undef itkAnalyzeObjectEntryViewFieldMacro
+
+/** \class AnalyzeObjectEntryTable
+ *  \ingroup AnalyzeObjectLabelMap
+ *  \ingroup AnalyzeObjectMapIO
+ *  \brief The object entries of an object map, stored as one contiguous array of plain records.
+ *
+ * An AnalyzeObjectEntryArrayType holds every entry in its own AnalyzeObjectEntry, each a separate
+ * allocation with the bookkeeping of an itk::Object.  The table holds the same fields in a single
+ * std::vector of AnalyzeObjectEntryRecord, about 150 bytes per entry, so that creating, copying
+ * and iterating a full table of 256 entries costs at most one allocation.  Entries are read and
+ * changed through views that offer the getters and setters of AnalyzeObjectEntry.
+ *
+ * AnalyzeObjectLabelMapImageIO stores a table in the meta data dictionary, under
+ * ANALYZE_OBJECT_LABEL_MAP_ENTRY_TABLE, when its UseEntryTable option is on, and writes the
+ * entries of a table found there.
+ *
+ * \code
+ *   itk::AnalyzeObjectEntryTable table;
+ *   itk::ExposeMetaData(dictionary, itk::ANALYZE_OBJECT_LABEL_MAP_ENTRY_TABLE, table);
+ *   for (itk::SizeValueType i = 0; i < table.GetNumberOfEntries(); i++)
+ *   {
+ *     table[i].SetOpacity(0.5f * table[i].GetOpacity());
+ *   }
+ * \endcode
+ */
+class AnalyzeObjectLabelMap_EXPORT AnalyzeObjectEntryTable
+{
+public:
+  using RecordType = AnalyzeObjectEntryRecord;
+  using RecordContainerType = std::vector<AnalyzeObjectEntryRecord>;
+  using EntryView = AnalyzeObjectEntryView<RecordType>;
+  using ConstEntryView = AnalyzeObjectEntryView<const RecordType>;
+  using EntryArrayType = std::vector<AnalyzeObjectEntry::Pointer>;
+
+  AnalyzeObjectEntryTable() = default;
+
+  /** A table of numberOfEntries entries with the values of a new AnalyzeObjectEntry. */
+  explicit AnalyzeObjectEntryTable(SizeValueType numberOfEntries);
+
+  SizeValueType
+  GetNumberOfEntries() const
+  {
+    return this->m_Records.size();
+  }
+
+  /** Resizes the table.  The entries added take the values of a new AnalyzeObjectEntry. */
+  void
+  SetNumberOfEntries(SizeValueType numberOfEntries);
+
+  EntryView operator[](SizeValueType i) { return EntryView(&this->m_Records[i]); }
+  ConstEntryView operator[](SizeValueType i) const { return ConstEntryView(&this->m_Records[i]); }
+
+  /** Appends an entry named name with the values of a new AnalyzeObjectEntry, and returns it. */
+  EntryView
+  AddEntry(const std::string & name);
+
+  /** The records of the entries, for loops over every entry and for encoding. */
+  RecordContainerType &
+  GetRecords()
+  {
+    return this->m_Records;
+  }
+  const RecordContainerType &
+  GetRecords() const
+  {
+    return this->m_Records;
+  }
+
+  /** The record of a new AnalyzeObjectEntry: a display flag, shades and opacity thickness of
+   * one, an opacity of 0.5, and zero for the other fields. */
+  static const RecordType &
+  GetDefaultRecord();
+
+  /** Replaces the entries of the table by copies of entries. */
+  void
+  CopyFromEntryArray(const EntryArrayType & entries);
+
+  /** Replaces entries by copies of the entries of the table.  Entries that nobody else holds are
+   * filled in again rather than allocated. */
+  void
+  CopyToEntryArray(EntryArrayType & entries) const
+  {
+    CopyRecordsToEntryArray(this->m_Records, entries);
+  }
+
+  /** Replaces entries by copies of records, as CopyToEntryArray() does. */
+  static void
+  CopyRecordsToEntryArray(const RecordContainerType & records, EntryArrayType & entries);
+
+  bool
+  operator==(const AnalyzeObjectEntryTable & other) const;
+  bool
+  operator!=(const AnalyzeObjectEntryTable & other) const
+  {
+    return !(*this == other);
+  }
+
+private:
+  RecordContainerType m_Records;
+};
+
+/** Prints the number of entries and their names, for MetaDataObject. */
+AnalyzeObjectLabelMap_EXPORT std::ostream &
+operator<<(std::ostream & os, const AnalyzeObjectEntryTable & table);
+} // end namespace itk
+
+#endif // itkAnalyzeObjectEntryTable_h
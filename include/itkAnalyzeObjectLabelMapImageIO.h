@@ -23,6 +23,12 @@
 #endif
 
 #include "itkAnalyzeObjectEntry.h"
+#include "itkAnalyzeObjectEntryRecord.h"
+#include "itkAnalyzeObjectEntryTable.h"
+#include "itkAnalyzeObjectMapCache.h"
+#include "itkAnalyzeObjectPlaneIndex.h"
+#include "itkAnalyzeObjectRunLengthCodec.h"
+#include "itkAnalyzeObjectSiblingGeometry.h"
 #include "AnalyzeObjectLabelMapExport.h"
 #include "itkImageRegionIterator.h"
 
@@ -32,11 +38,6 @@ namespace itk
 {
 using AnalyzeObjectEntryArrayType = std::vector<AnalyzeObjectEntry::Pointer>;
 
-/**
- * Buffer size for reading in the run length encoded object data
- */
-constexpr int NumberOfRunLengthElementsPerRead = 1;
-
 /** \class AnalyzeObjectLabelMapImageIO
  *  \ingroup AnalyzeObjectLabelMap
  *  \ingroup AnalyzeObjectMapIO
@@ -53,6 +54,8 @@ public:
 
   using RGBPixelType = itk::RGBPixel<int>;
   using ImageType = itk::Image<unsigned char, 4>;
+  using ProjectionImageType = itk::Image<unsigned char, 2>;
+  using LabelCompactionTableType = AnalyzeObjectRunLengthCodec::LabelCompactionTableType;
 
   /** Method for creation through the object factory. */
   itkNewMacro(Self);
@@ -63,6 +66,9 @@ public:
   /*-------- This part of the interfaces deals with reading data. ----- */
 
   /** Determine if the file can be read with this ImageIO implementation.
+   * Besides the .obj extension, the first bytes of the file must hold a valid object map
+   * header, of any version and in either byte order.  The header is kept for the
+   * ReadImageInformation() that follows.
    * \author Hans J Johnson
    * \param FileNameToRead The name of the file to test for reading.
    * \post Sets classes ImageIOBase::m_FileName variable to be FileNameToWrite
@@ -75,10 +81,65 @@ public:
   void
   ReadImageInformation() override;
 
-  /** Reads the data from disk into the memory buffer provided. */
+  /**
+   * \brief ProbeHeader
+   *
+   * Reads the header of fileName, and its object entries if readEntries is true, into record.
+   * Only the bytes of the header and the entry table are read, and no ITK object is created, so
+   * this is much cheaper than ReadImageInformation() when cataloguing many files.  Returns
+   * false if the file cannot be read or does not start with a valid object map header.
+   */
+  static bool
+  ProbeHeader(const std::string & fileName, AnalyzeObjectMapHeaderRecord & record, bool readEntries = true);
+
+  /**
+   * \brief ProbeHeaders
+   *
+   * Probes every file of fileNames, as ProbeHeader() does, reading several files at once.
+   * records[i] receives the header of fileNames[i]; its Valid member tells whether the probe
+   * succeeded.  numberOfThreads defaults to the global default number of threads; as the work is
+   * mostly waiting for the disk, more threads than cores may help on network storage.
+   */
+  static void
+  ProbeHeaders(const std::vector<std::string> &            fileNames,
+               std::vector<AnalyzeObjectMapHeaderRecord> & records,
+               bool                                        readEntries = true,
+               ThreadIdType                                numberOfThreads = 0);
+
+  /** Removes what was derived from the object map of fileName before it is written: its sidecar
+   * plane index and its entry in the object map cache.  Their length and modification time checks
+   * may miss a file that is rewritten quickly, so every writer of object maps calls this. */
+  static void
+  InvalidateDerivedData(const std::string & fileName);
+
+  /** Reads the data from disk into the memory buffer provided.  The runs are
+   * expanded directly into the component type reported by ReadImageInformation(). */
   void
   Read(void * buffer) override;
 
+  /**
+   * \brief ReadToBuffer
+   *
+   * Decodes the voxel data of the IO region into a caller owned buffer, for example a NumPy
+   * array or a staging buffer, without allocating an ITK image.  ReadImageInformation() must
+   * have been called first; it sets the IO region to the whole image.  The buffer must hold
+   * GetIORegion().GetNumberOfPixels() elements of componentType, which may be any of the types
+   * accepted by SetOutputComponentType().
+   */
+  void
+  ReadToBuffer(void * buffer, IOComponentEnum componentType);
+
+  /**
+   * \brief GetOutputComponentType/SetOutputComponentType
+   *
+   * The component type reported by ReadImageInformation().  Object maps are stored as unsigned
+   * char, but setting this to the pixel type of the image being read (UCHAR, CHAR, USHORT, SHORT,
+   * UINT, INT, FLOAT or DOUBLE) lets Read() expand the runs into that type directly, instead of
+   * ImageFileReader converting a temporary unsigned char buffer.  Default is UCHAR.
+   */
+  itkSetMacro(OutputComponentType, IOComponentEnum);
+  itkGetConstMacro(OutputComponentType, IOComponentEnum);
+
   /*-------- This part of the interfaces deals with writing data. ----- */
 
   /** Determine if the file can be written with this ImageIO implementation.
@@ -95,25 +156,217 @@ public:
   WriteImageInformation() override;
 
   /** Writes the data to disk from the memory buffer provided. Make sure
-   * that the IORegions has been set properly. */
+   * that the IORegions has been set properly.  Any integer component type is
+   * accepted; the values are narrowed to unsigned char while they are encoded. */
   void
   Write(const void * buffer) override;
 
-  // Streaming not yet supported, so use the default base class to return the LargestPossibleRegion
-#if _USE_STREAMABLE_REGION_FOR_AOLM
-  /** Calculate the region of the image that can be efficiently read
-   *  in response to a given requested region. */
-  virtual ImageIORegion
-  GenerateStreamableReadRegionFromRequestedRegion(const ImageIORegion & requestedRegion) const;
+  /**
+   * \brief ReadImageInformationFromMemory/ReadFromMemory
+   *
+   * Read an object map held in the numberOfBytes bytes at data, for example a payload received
+   * from a message bus, as ReadImageInformation() and Read() read a file.  ReadFromMemory() must
+   * be given the same bytes, and decodes the IO region into buffer, which holds pixels of the
+   * component type.  The runs of a region smaller than the image are all expanded, as no plane
+   * index is built in memory.  The cache and the sidecar plane index are never used.  Throw if
+   * the bytes do not hold a valid object map.
+   */
+  void
+  ReadImageInformationFromMemory(const void * data, SizeValueType numberOfBytes);
+  void
+  ReadFromMemory(const void * data, SizeValueType numberOfBytes, void * buffer);
 
-#endif
+  /**
+   * \brief WriteToMemory
+   *
+   * Encodes buffer as Write() does, but replaces the content of output by the object map instead
+   * of writing a file.  output keeps its capacity, so a buffer reused for many maps is allocated
+   * once.  The dimensions and component type must be set as for Write().
+   */
+  void
+  WriteToMemory(const void * buffer, AnalyzeObjectRunLengthCodec::BufferType & output);
+
+  /**
+   * \brief ComputeEncodedSizeInBytes
+   *
+   * Returns the exact number of bytes Write(buffer) writes: the header, the object entries and the
+   * runs.  The runs are counted, not encoded, a plane at a time on numberOfThreads threads; 0 uses
+   * the global default number of threads.  Nothing is written, so the size can be checked against
+   * a quota first.  The dimensions and component type must be set as for Write(), and the entries
+   * are taken from the meta data dictionary as Write() takes them.  Throws if Write() would throw
+   * for the labels of buffer.
+   */
+  SizeValueType
+  ComputeEncodedSizeInBytes(const void * buffer, ThreadIdType numberOfThreads = 0);
+
+  /**
+   * \brief GetUseLabelCompaction/SetUseLabelCompaction
+   *
+   * When an image written by Write() holds values outside of [0,255] but uses no more than 256
+   * distinct values, the values are remapped to consecutive labels and an object entry named
+   * after each original value is written.  When off, such images cause an exception.
+   * Default is on.
+   */
+  itkSetMacro(UseLabelCompaction, bool);
+  itkGetConstMacro(UseLabelCompaction, bool);
+  itkBooleanMacro(UseLabelCompaction);
+
+  /** The table used by the last call to Write() to remap the labels.  Entry i holds the image
+   * value that was written as label i.  Empty if no remapping was needed. */
+  itkGetConstReferenceMacro(LabelCompactionTable, LabelCompactionTableType);
+
+  /**
+   * \brief GetUseAtomicWrite/SetUseAtomicWrite
+   *
+   * When on, WriteImageInformation() leaves the file alone, and Write() writes the header, the
+   * entries and the runs to a new temporary file in the directory of the file, preallocated to
+   * their size, which then replaces the file by a rename.  A crash, a full disk or an error then
+   * leaves either the previous file or the new one, never a truncated one.  The file written is a
+   * new file, so links to the previous one and its permissions are not kept.  Default is off.
+   */
+  itkSetMacro(UseAtomicWrite, bool);
+  itkGetConstMacro(UseAtomicWrite, bool);
+  itkBooleanMacro(UseAtomicWrite);
+
+  /**
+   * \brief GetUseSynchronousWrite/SetUseSynchronousWrite
+   *
+   * When on, together with UseAtomicWrite, the temporary file is flushed to the disk before it
+   * replaces the file, and the directory after, so that the new file survives a power failure
+   * once Write() returns.  Default is off.
+   */
+  itkSetMacro(UseSynchronousWrite, bool);
+  itkGetConstMacro(UseSynchronousWrite, bool);
+  itkBooleanMacro(UseSynchronousWrite);
+
+  /** Calculate the region of the image that can be efficiently read
+   *  in response to a given requested region.  Any region can be read: planes
+   *  outside of it are skipped using a plane index and the runs of the other
+   *  planes are only expanded where they overlap the region. */
+  ImageIORegion
+  GenerateStreamableReadRegionFromRequestedRegion(const ImageIORegion & requestedRegion) const override;
 
   bool
   CanStreamRead() override
   {
-    return false;
+    return true;
+  }
+
+  /**
+   * \brief GetUsePlaneIndexFile/SetUsePlaneIndexFile
+   *
+   * When on, the plane index of a file is loaded from a sidecar file (foo.obj.idx) when one
+   * matching the length and modification time of the object map exists, and saved to it after it
+   * has been built otherwise.  Repeated opens of the same file then seek directly to any plane
+   * without first scanning the runs.  A sidecar that cannot be written is silently ignored.
+   * Default is off.
+   */
+  itkSetMacro(UsePlaneIndexFile, bool);
+  itkGetConstMacro(UsePlaneIndexFile, bool);
+  itkBooleanMacro(UsePlaneIndexFile);
+
+  /**
+   * \brief GetUseCache/SetUseCache
+   *
+   * When on, ReadImageInformation() and Read() go through the process wide
+   * AnalyzeObjectMapCache.  The first read of the whole of a file, or ReadSharedVoxels(), caches
+   * the header, the object entries and the voxels; later reads of the same, unchanged, file copy
+   * the requested region out of the cached voxels instead of parsing and decoding the file.  A
+   * read of a region of a file that is not cached yet is streamed and caches nothing, so it never
+   * costs the decoding of the whole file.  The object entries are copied as well, so changing them
+   * does not alter the cache.  Default is off.
+   */
+  itkSetMacro(UseCache, bool);
+  itkGetConstMacro(UseCache, bool);
+  itkBooleanMacro(UseCache);
+
+  /**
+   * \brief GetUseSiblingGeometry/SetUseSiblingGeometry
+   *
+   * When on, ReadImageInformation() takes the spacing, origin and direction of the image from
+   * the header of foo.nii, foo.nii.gz or foo.hdr next to foo.obj, looked up through the process
+   * wide AnalyzeObjectSiblingGeometry.  Axes the sibling image does not have keep a spacing of 1.
+   * Without a readable sibling of the same size the geometry is left at its defaults.  Default is
+   * off.
+   */
+  itkSetMacro(UseSiblingGeometry, bool);
+  itkGetConstMacro(UseSiblingGeometry, bool);
+  itkBooleanMacro(UseSiblingGeometry);
+
+  /**
+   * \brief GetUseEntryTable/SetUseEntryTable
+   *
+   * When on, ReadImageInformation() stores the object entries in the meta data dictionary as an
+   * AnalyzeObjectEntryTable, under ANALYZE_OBJECT_LABEL_MAP_ENTRY_TABLE, instead of as an
+   * AnalyzeObjectEntryArrayType of separately allocated entries.  Write() takes the entries from
+   * a table when the dictionary holds one, whatever this option.  Default is off.
+   */
+  itkSetMacro(UseEntryTable, bool);
+  itkGetConstMacro(UseEntryTable, bool);
+  itkBooleanMacro(UseEntryTable);
+
+  /**
+   * \brief ReadSharedVoxels
+   *
+   * Returns the voxels of the whole file as the read only container shared with every other
+   * reader of the file through the object map cache, without copying them into a buffer.  A file
+   * that is not cached yet is decoded whole and cached.  ReadImageInformation() must have been
+   * called with UseCache on.
+   */
+  AnalyzeObjectMapCache::VoxelContainerType::ConstPointer
+  ReadSharedVoxels();
+
+  /**
+   * \brief GetCachedVoxels
+   *
+   * The shared, read only, voxels of the file cached by the last ReadImageInformation(), Read() or
+   * ReadSharedVoxels(), or a null pointer if UseCache is off or the voxels were not decoded yet.
+   */
+  AnalyzeObjectMapCache::VoxelContainerType::ConstPointer
+  GetCachedVoxels() const
+  {
+    return this->m_CachedObjectMap.Voxels;
   }
 
+  /**
+   * \brief GetPlanesContainingLabel
+   *
+   * Returns the numbers (z + t * zDimension) of the planes that hold at least one voxel of label,
+   * using the plane index so that no voxel is expanded.  ReadImageInformation() must have been
+   * called first.  Throws if the planes of the file cannot be indexed.
+   */
+  std::vector<SizeValueType>
+  GetPlanesContainingLabel(unsigned char label);
+
+  /**
+   * \brief GetLabelProjections
+   *
+   * Returns, for every label of labels, a 2D image of the size of a plane that is 1 where a voxel
+   * of the column (x, y) holds the label in any plane, of any frame, and 0 elsewhere.  The runs are
+   * scanned a plane at a time into a bit per column and label, without expanding any voxel, and
+   * planes the plane index shows to hold none of the labels are not read.  The planes are split
+   * between numberOfThreads threads, each with its own bits; 0 uses the global default number of
+   * threads.  The images have the spacing, origin and direction of the x and y axes of the map,
+   * or an identity direction if those axes hardly span the plane.  ReadImageInformation() must
+   * have been called first.  Throws if the planes of the file cannot be indexed.
+   */
+  std::vector<ProjectionImageType::Pointer>
+  GetLabelProjections(const std::vector<unsigned char> & labels, ThreadIdType numberOfThreads = 0);
+
+  /**
+   * \brief ReleaseScratchBuffers
+   *
+   * Frees the buffers kept between calls.  An IO reused for many files keeps the run length,
+   * header and entry buffers of the largest file it has read or written, so that later calls do
+   * not allocate them again; this returns that memory, for example after an unusually large file.
+   */
+  void
+  ReleaseScratchBuffers();
+
+  /** The number of bytes held by the buffers kept between calls. */
+  SizeValueType
+  GetScratchBufferSizeInBytes() const;
+
 protected:
   AnalyzeObjectLabelMapImageIO();
   ~AnalyzeObjectLabelMapImageIO() override;
@@ -121,8 +374,121 @@ protected:
   PrintSelf(std::ostream & os, Indent indent) const override;
 
 private:
-  std::ifstream m_InputFileStream;
-  int           m_LocationOfFile;
+  /** Encodes the image buffer into m_RunLengthBuffer, and the entries to write with it into
+   * m_HeaderRecord. */
+  void
+  EncodeImageBuffer(const void * buffer);
+
+  /** Encodes the image buffer into runLengthBuffer, building the compaction table if needed. */
+  template <typename TPixel>
+  void
+  EncodeRunLengthBuffer(const TPixel * buffer, AnalyzeObjectRunLengthCodec::BufferType & runLengthBuffer);
+
+  /** Counts the bytes of the runs of the image buffer on numberOfThreads threads, and sets
+   * numberOfEntries to the number of entries Write() writes with them. */
+  template <typename TPixel>
+  SizeValueType
+  CountRunLengthBytes(const TPixel * buffer, ThreadIdType numberOfThreads, SizeValueType & numberOfEntries);
+
+  /** Expands the run length encoded data of the file into buffer. */
+  template <typename TPixel>
+  void
+  DecodeRunLengthData(TPixel * buffer);
+
+  /** Expands the IO region of the file into buffer. */
+  template <typename TPixel>
+  void
+  DecodeRunLengthRegion(TPixel * buffer);
+
+  /** Builds the plane index of the file unless it is already up to date.  Returns false if
+   * the planes of the file cannot be indexed. */
+  bool
+  UpdatePlaneIndex();
+
+  /** Decodes the header, without the entries, from the first bytes of fileName. */
+  static bool
+  SniffHeader(const std::string & fileName, AnalyzeObjectMapHeaderRecord & record);
+
+  /** Sets the component type and the pixel type read from OutputComponentType. */
+  void
+  SetComponentTypeToRead();
+
+  /** Sets the image information and the entries from m_HeaderRecord, and copies them into the
+   * cached map when cacheEntries is true. */
+  void
+  SetImageInformationFromHeaderRecord(bool cacheEntries);
+
+  /** Sets the dimensions, spacing, origin and direction described by a header in native byte order. */
+  void
+  SetImageInformationFromHeader(const int header[6]);
+
+  /** Applies the geometry of the image next to the file, if there is one. */
+  void
+  SetImageInformationFromSibling();
+
+  /** Sets the IO region to the whole image and stores entries in the meta data dictionary. */
+  void
+  SetLargestRegionAndEntries(const AnalyzeObjectEntryArrayType & entries);
+  void
+  SetLargestRegionAndEntries(const AnalyzeObjectEntryTable & table);
+
+  /** Sets the IO region to the whole image. */
+  void
+  SetLargestRegion();
+
+  /** Decodes the whole file into the cache unless its voxels are already cached. */
+  void
+  UpdateCachedVoxels();
+
+  /** Sets the version and the dimensions of m_HeaderRecord to those written.  Throws if they, or
+   * its entries, cannot be written. */
+  void
+  UpdateHeaderRecordToWrite();
+
+  /** Writes the header, the entries of m_HeaderRecord and then numberOfRunLengthBytes of run
+   * length encoded data, truncating the file or, with UseAtomicWrite, replacing it.  Throws if the
+   * file cannot be written. */
+  void
+  WriteHeaderAndEntryTable(const unsigned char * runLengthBytes = nullptr, SizeValueType numberOfRunLengthBytes = 0);
+
+  /** Copies the entries of the table or entry array of the meta data dictionary into records.
+   * Returns false, leaving records empty, if the dictionary holds neither. */
+  bool
+  GetEntryRecordsFromMetaData(AnalyzeObjectEntryTable::RecordContainerType & records);
+
+  /** The entries of the meta data dictionary, or blank entries if it holds none. */
+  void
+  GetEntryRecordsToWrite(AnalyzeObjectEntryTable::RecordContainerType & records);
+
+  std::ifstream                          m_InputFileStream;
+  std::ofstream                          m_OutputFileStream;
+  const unsigned char *                  m_MemoryBytes{ nullptr };
+  SizeValueType                          m_NumberOfMemoryBytes{ 0 };
+  AnalyzeObjectPlaneIndex::OffsetType    m_LocationOfFile{ 0 };
+  IOComponentEnum                        m_OutputComponentType{ IOComponentEnum::UCHAR };
+  AnalyzeObjectPlaneIndex                m_PlaneIndex;
+  std::string                            m_PlaneIndexFileName;
+  SizeValueType                          m_PlaneIndexFileLength{ 0 };
+  long                                   m_PlaneIndexModifiedTime{ 0 };
+  bool                                   m_UsePlaneIndexFile{ false };
+  bool                                   m_UseCache{ false };
+  bool                                   m_UseSiblingGeometry{ false };
+  bool                                   m_UseEntryTable{ false };
+  bool                                   m_UseAtomicWrite{ false };
+  bool                                   m_UseSynchronousWrite{ false };
+  AnalyzeObjectMapCache::CachedObjectMap m_CachedObjectMap;
+  std::string                            m_SniffedFileName;
+  AnalyzeObjectMapHeaderRecord           m_SniffedHeader;
+  bool                                   m_UseLabelCompaction{ true };
+  LabelCompactionTableType               m_LabelCompactionTable;
+
+  // Buffers kept between calls, so that an IO reused for many files does not allocate them again.
+  AnalyzeObjectRunLengthCodec::BufferType      m_RunLengthBuffer;
+  std::vector<unsigned char>                   m_HeaderBuffer;
+  AnalyzeObjectMapHeaderRecord                 m_HeaderRecord;
+  AnalyzeObjectEntryArrayType                  m_Entries;
+  AnalyzeObjectEntryTable                      m_EntryTable;
+  AnalyzeObjectEntryTable::RecordContainerType m_EntryRecordsToWrite;
   //  int           m_CollapsedDims[8];
 };
 
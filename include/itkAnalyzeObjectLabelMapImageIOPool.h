@@ -0,0 +1,105 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkAnalyzeObjectLabelMapImageIOPool_h
+#define itkAnalyzeObjectLabelMapImageIOPool_h
+
+#include "itkAnalyzeObjectLabelMapImageIO.h"
+#include "AnalyzeObjectLabelMapExport.h"
+
+#include <mutex>
+#include <vector>
+
+namespace itk
+{
+/** \class AnalyzeObjectLabelMapImageIOPool
+ *  \ingroup AnalyzeObjectLabelMap
+ *  \ingroup AnalyzeObjectMapIO
+ *  \brief A thread safe pool of AnalyzeObjectLabelMapImageIO objects reused across files.
+ *
+ * An AnalyzeObjectLabelMapImageIO keeps its scratch buffers, its header record and the object
+ * entries nobody else holds between calls.  Batch workers that read or write many files can take an
+ * IO from a pool for each file instead of creating one, so that these are allocated once per
+ * worker rather than once per file.  An IO is only used by one thread at a time.
+ *
+ * \code
+ *   itk::AnalyzeObjectLabelMapImageIOPool pool;
+ *   // In every worker thread:
+ *   itk::AnalyzeObjectLabelMapImageIOPool::Lease io(pool);
+ *   reader->SetImageIO(io.Get());
+ * \endcode
+ */
+class AnalyzeObjectLabelMap_EXPORT AnalyzeObjectLabelMapImageIOPool
+{
+public:
+  using ImageIOType = AnalyzeObjectLabelMapImageIO;
+  using ImageIOPointer = ImageIOType::Pointer;
+
+  /** Holds an IO of a pool, and gives it back when destroyed. */
+  class Lease
+  {
+  public:
+    explicit Lease(AnalyzeObjectLabelMapImageIOPool & pool)
+      : m_Pool(pool)
+      , m_ImageIO(pool.Acquire())
+    {}
+    ~Lease() { this->m_Pool.Release(this->m_ImageIO); }
+    Lease(const Lease &) = delete;
+    Lease &
+    operator=(const Lease &) = delete;
+
+    ImageIOType *
+    Get() const
+    {
+      return this->m_ImageIO.GetPointer();
+    }
+    ImageIOType *
+    operator->() const
+    {
+      return this->m_ImageIO.GetPointer();
+    }
+
+  private:
+    AnalyzeObjectLabelMapImageIOPool & m_Pool;
+    ImageIOPointer                     m_ImageIO;
+  };
+
+  /** Returns an idle IO of the pool, or a new one if every IO is in use.  The settings of an IO
+   * that was used before are those it was released with. */
+  ImageIOPointer
+  Acquire();
+
+  /** Gives an IO back to the pool.  Its meta data dictionary is cleared, so that the object
+   * entries of the last file are not held by the pool; its buffers are kept. */
+  void
+  Release(ImageIOType * imageIO);
+
+  /** The number of IOs waiting to be acquired. */
+  SizeValueType
+  GetNumberOfIdleImageIOs() const;
+
+  /** Frees the idle IOs.  The IOs in use are added to the pool when they are released. */
+  void
+  Clear();
+
+private:
+  mutable std::mutex          m_Mutex;
+  std::vector<ImageIOPointer> m_IdleImageIOs;
+};
+} // end namespace itk
+
+#endif // itkAnalyzeObjectLabelMapImageIOPool_h
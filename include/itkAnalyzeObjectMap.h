@@ -18,14 +18,18 @@
 #ifndef itkAnalyzeObjectMap_h
 #define itkAnalyzeObjectMap_h
 
+#include <array>
+#include <bitset>
 #include <cstdio>
 #include <string>
 #include <vector>
 #include "itkAnalyzeObjectEntry.h"
+#include "itkAnalyzeObjectEntryTable.h"
 #include "itkObject.h"
 #include <itkMetaDataDictionary.h>
 #include "itkMetaDataObject.h"
 #include "itkThresholdImageFilter.h"
+#include "itkTimeStamp.h"
 
 namespace itk
 {
@@ -53,6 +57,27 @@ public:
 
   using PixelType = typename TImage::PixelType;
 
+  /** Number of labels described by the display tables, the most an object map file can hold. */
+  static constexpr unsigned int NumberOfDisplayLabels = 256;
+
+  /** The display attributes of the object entries, packed by attribute and indexed by label, so
+   * that they can be uploaded to a renderer or used in a vector loop as they are.  Labels without
+   * an entry are black, transparent and hidden. */
+  struct DisplayTables
+  {
+    /** EndRed, EndGreen, EndBlue and the opacity of every label, clamped to [0,255].  The alpha of
+     * labels whose DisplayFlag is zero is zero, so that the table alone hides them. */
+    std::array<unsigned char, 4 * NumberOfDisplayLabels> RGBA;
+
+    /** Opacity, BlendFactor and Shades of every label. */
+    std::array<float, NumberOfDisplayLabels> Opacity;
+    std::array<float, NumberOfDisplayLabels> BlendFactor;
+    std::array<int, NumberOfDisplayLabels>   Shades;
+
+    /** Whether the DisplayFlag of every label is non zero. */
+    std::bitset<NumberOfDisplayLabels> Visible;
+  };
+
   /** Method for creation through the object factory. */
   itkNewMacro(Self);
 
@@ -189,6 +214,17 @@ public:
   void
   ImageToObjectMap(ImageType * image);
 
+  /**
+   * \brief GetDisplayTables
+   *
+   * Returns the display attributes of the entries, packed into arrays.  The tables are rebuilt
+   * when an entry has been modified, added, removed or replaced since they were last built, so
+   * they always agree with the entries, and otherwise cost a check of the modification time of
+   * each entry.  The reference stays valid until the next call.  Not thread safe.
+   */
+  const DisplayTables &
+  GetDisplayTables() const;
+
 protected:
   /**
    * \brief the default constructor
@@ -214,6 +250,11 @@ private:
   int m_NumberOfObjects{ 1 };
   /** Pointers to individual objects in the object map, maximum of 256 */
   AnalyzeObjectEntryArrayType m_AnaylzeObjectEntryArray;
+
+  /** The display tables, the entries they were built from and the time they were built at. */
+  mutable DisplayTables                           m_DisplayTables;
+  mutable std::vector<const AnalyzeObjectEntry *> m_DisplayTablesEntries;
+  mutable TimeStamp                               m_DisplayTablesTime;
 };
 } // namespace itk
 #ifndef ITK_MANUAL_INSTANTIATION
@@ -24,6 +24,8 @@
 #include "itkAnalyzeObjectMap.h"
 #include "itkImageRegionIterator.h"
 
+#include <algorithm>
+
 namespace itk
 {
 
@@ -104,13 +106,18 @@ AnalyzeObjectMap<TImage, TRGBImage>::ObjectMapToRGBImage()
   itk::ImageRegionIterator<ImageType> ObjectIterator(this, this->GetLargestPossibleRegion());
   /*std::ofstream myfile;
   myfile.open("RGBImageVoxels2.txt");*/
+  // The colors are looked up in the packed table rather than in the entries; labels beyond it are black.
+  const unsigned char * RGBA = this->GetDisplayTables().RGBA.data();
+  const unsigned char   black[4] = { 0, 0, 0, 0 };
   for (ObjectIterator.GoToBegin(), RGBIterator.GoToBegin(); !ObjectIterator.IsAtEnd(); ++ObjectIterator, ++RGBIterator)
   {
     typename itk::ImageRegionIterator<TRGBImage>::PixelType setColors;
     //      typename RGBImage->ImageType setColors;
-    setColors.SetBlue(this->m_AnaylzeObjectEntryArray[ObjectIterator.Get()]->GetEndBlue());
-    setColors.SetGreen(this->m_AnaylzeObjectEntryArray[ObjectIterator.Get()]->GetEndGreen());
-    setColors.SetRed(this->m_AnaylzeObjectEntryArray[ObjectIterator.Get()]->GetEndRed());
+    const auto            label = static_cast<SizeValueType>(ObjectIterator.Get());
+    const unsigned char * color = label < NumberOfDisplayLabels ? RGBA + 4 * label : black;
+    setColors.SetBlue(color[2]);
+    setColors.SetGreen(color[1]);
+    setColors.SetRed(color[0]);
 
     RGBIterator.Set(setColors);
     // myfile<<RGBIterator.Get()<<std::endl;
@@ -250,14 +257,67 @@ AnalyzeObjectMap<TImage, TRGBImage>::ImageToObjectMap(TImage * image)
   this->Allocate();
   this->SetPixelContainer(image->GetPixelContainer());
   itk::AnalyzeObjectEntryArrayType * my_reference = this->GetAnalyzeObjectEntryArrayPointer();
+  AnalyzeObjectEntryTable table;
   if (itk::ExposeMetaData<itk::AnalyzeObjectEntryArrayType>(
         image->GetMetaDataDictionary(), ANALYZE_OBJECT_LABEL_MAP_ENTRY_ARRAY, *my_reference))
   {
     this->SetNumberOfObjects(this->GetAnalyzeObjectEntryArrayPointer()->size());
   }
+  else if (itk::ExposeMetaData<AnalyzeObjectEntryTable>(
+             image->GetMetaDataDictionary(), ANALYZE_OBJECT_LABEL_MAP_ENTRY_TABLE, table))
+  {
+    // Images read with an entry table get entries of their own.
+    table.CopyToEntryArray(*my_reference);
+    this->SetNumberOfObjects(my_reference->size());
+  }
   this->PlaceObjectMapEntriesIntoMetaData();
 }
 
+template <class TImage, class TRGBImage>
+auto
+AnalyzeObjectMap<TImage, TRGBImage>::GetDisplayTables() const -> const DisplayTables &
+{
+  const SizeValueType numberOfEntries =
+    std::min<SizeValueType>(this->m_AnaylzeObjectEntryArray.size(), NumberOfDisplayLabels);
+  bool upToDate = this->m_DisplayTablesEntries.size() == numberOfEntries && this->m_DisplayTablesTime.GetMTime() > 0;
+  for (SizeValueType i = 0; i < numberOfEntries && upToDate; i++)
+  {
+    const AnalyzeObjectEntry * entry = this->m_AnaylzeObjectEntryArray[i];
+    upToDate = entry == this->m_DisplayTablesEntries[i] && entry->GetMTime() < this->m_DisplayTablesTime.GetMTime();
+  }
+  if (upToDate)
+  {
+    return this->m_DisplayTables;
+  }
+
+  DisplayTables & tables = this->m_DisplayTables;
+  tables.RGBA.fill(0);
+  tables.Opacity.fill(0.0f);
+  tables.BlendFactor.fill(0.0f);
+  tables.Shades.fill(0);
+  tables.Visible.reset();
+  this->m_DisplayTablesEntries.resize(numberOfEntries);
+  const auto toByte = [](double value) -> unsigned char {
+    return static_cast<unsigned char>(std::min(255.0, std::max(0.0, value)));
+  };
+  for (SizeValueType i = 0; i < numberOfEntries; i++)
+  {
+    const AnalyzeObjectEntry * entry = this->m_AnaylzeObjectEntryArray[i];
+    this->m_DisplayTablesEntries[i] = entry;
+    const bool visible = entry->GetDisplayFlag() != 0;
+    tables.RGBA[4 * i] = toByte(entry->GetEndRed());
+    tables.RGBA[4 * i + 1] = toByte(entry->GetEndGreen());
+    tables.RGBA[4 * i + 2] = toByte(entry->GetEndBlue());
+    tables.RGBA[4 * i + 3] = visible ? toByte(255.0 * entry->GetOpacity() + 0.5) : 0;
+    tables.Opacity[i] = entry->GetOpacity();
+    tables.BlendFactor[i] = entry->GetBlendFactor();
+    tables.Shades[i] = entry->GetShades();
+    tables.Visible[i] = visible;
+  }
+  this->m_DisplayTablesTime.Modified();
+  return tables;
+}
+
 template <class TImage, class TRGBImage>
 void
 AnalyzeObjectMap<TImage, TRGBImage>::PrintSelf(std::ostream & os, Indent indent) const
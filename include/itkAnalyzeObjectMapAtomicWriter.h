@@ -0,0 +1,99 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkAnalyzeObjectMapAtomicWriter_h
+#define itkAnalyzeObjectMapAtomicWriter_h
+
+#include "itkMacro.h"
+#include "itkIntTypes.h"
+#include "AnalyzeObjectLabelMapExport.h"
+
+#include <cstdio>
+#include <string>
+
+namespace itk
+{
+/** \class AnalyzeObjectMapAtomicWriter
+ *  \ingroup AnalyzeObjectLabelMap
+ *  \ingroup AnalyzeObjectMapIO
+ *  \brief Replaces a file whole, through a temporary file that is renamed over it.
+ *
+ * Open() creates a new temporary file in the directory of the file, with a name unique to the
+ * process and the write, so that concurrent writers of the same file never share a temporary
+ * file.  Write() appends to it, and Commit() renames it over the file, so that a crash, a full
+ * disk or an error leaves either the old file or the new one, never a truncated file.  A
+ * temporary file that is not committed is removed.  Errors throw exceptions.
+ *
+ * A writer of object maps calls AnalyzeObjectLabelMapImageIO::InvalidateDerivedData() before
+ * Open() and again after Commit(), since a reader may derive a sidecar plane index or a cached
+ * map from the old file until the rename.
+ *
+ * \code
+ *   itk::AnalyzeObjectMapAtomicWriter writer;
+ *   writer.Open("segmentation.obj", header.size() + runs.size());
+ *   writer.Write(header.data(), header.size());
+ *   writer.Write(runs.data(), runs.size());
+ *   writer.Commit();
+ * \endcode
+ */
+class AnalyzeObjectLabelMap_EXPORT AnalyzeObjectMapAtomicWriter
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(AnalyzeObjectMapAtomicWriter);
+
+  AnalyzeObjectMapAtomicWriter() = default;
+
+  /** Removes the temporary file, unless it was committed. */
+  ~AnalyzeObjectMapAtomicWriter();
+
+  /** Creates the temporary file that will replace fileName.  When numberOfBytes is known, they
+   * are allocated on the disk where the system can, so that a full disk is found before anything
+   * is written. */
+  void
+  Open(const std::string & fileName, SizeValueType numberOfBytes = 0);
+
+  /** Appends numberOfBytes bytes of data to the temporary file. */
+  void
+  Write(const void * data, SizeValueType numberOfBytes);
+
+  /** Closes the temporary file and renames it over the file.  When synchronous is true, the
+   * temporary file is flushed to the disk before the rename and the directory after it. */
+  void
+  Commit(bool synchronous = false);
+
+  /** Closes and removes the temporary file, leaving the file as it was. */
+  void
+  Abort();
+
+  const std::string &
+  GetTemporaryFileName() const
+  {
+    return this->m_TemporaryFileName;
+  }
+
+  /** Replaces fileName by the numberOfBytes bytes of data. */
+  static void
+  WriteFile(const std::string & fileName, const void * data, SizeValueType numberOfBytes, bool synchronous = false);
+
+private:
+  std::string m_FileName;
+  std::string m_TemporaryFileName;
+  std::FILE * m_File{ nullptr };
+};
+} // end namespace itk
+
+#endif // itkAnalyzeObjectMapAtomicWriter_h
@@ -0,0 +1,178 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkAnalyzeObjectMapBatchReader_h
+#define itkAnalyzeObjectMapBatchReader_h
+
+#include "itkAnalyzeObjectMap.h"
+#include "itkAnalyzeObjectLabelMapImageIO.h"
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace itk
+{
+/** \class AnalyzeObjectMapBatchReader
+ *  \ingroup AnalyzeObjectLabelMap
+ *  \ingroup AnalyzeObjectMapIO
+ *  \brief Reads a list of object map files into AnalyzeObjectMap objects, overlapping I/O and decoding.
+ *
+ * A read-ahead thread loads whole files into memory, one after the other, while a pool of
+ * worker threads decodes the loaded files through AnalyzeObjectLabelMapImageIO::ReadFromMemory(),
+ * each worker with an IO of its own.  GetNext() hands out the decoded object maps in
+ * the order of the file names.  At most QueueCapacity files are loaded or decoded ahead of the
+ * one GetNext() waits for, which bounds the memory held by the reader.  The throughput is then
+ * limited by the slower of the disk and the decoders, instead of by their sum.
+ *
+ * \code
+ *   auto reader = itk::AnalyzeObjectMapBatchReader<ObjectMapType>::New();
+ *   reader->SetFileNames(fileNames);
+ *   reader->Start();
+ *   ObjectMapType::Pointer map;
+ *   while (reader->GetNext(map))
+ *   {
+ *     ...
+ *   }
+ * \endcode
+ */
+template <typename TObjectMap = AnalyzeObjectMap<>>
+class ITK_TEMPLATE_EXPORT AnalyzeObjectMapBatchReader : public Object
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(AnalyzeObjectMapBatchReader);
+
+  /** Standard class type alias. */
+  using Self = AnalyzeObjectMapBatchReader;
+  using Superclass = Object;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  using ObjectMapType = TObjectMap;
+  using ObjectMapPointer = typename ObjectMapType::Pointer;
+  using PixelType = typename ObjectMapType::PixelType;
+  using FileNamesContainer = std::vector<std::string>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(AnalyzeObjectMapBatchReader, Object);
+
+  /** The files to read, in the order in which GetNext() returns them.  Must be set before Start(). */
+  void
+  SetFileNames(const FileNamesContainer & fileNames)
+  {
+    this->m_FileNames = fileNames;
+    this->Modified();
+  }
+  itkGetConstReferenceMacro(FileNames, FileNamesContainer);
+
+  /** Number of decoding threads.  Default is the global default number of threads. */
+  itkSetMacro(NumberOfWorkUnits, unsigned int);
+  itkGetConstMacro(NumberOfWorkUnits, unsigned int);
+
+  /** Largest number of files loaded or decoded but not yet returned by GetNext().  Default is twice
+   * the number of decoding threads. */
+  itkSetMacro(QueueCapacity, unsigned int);
+  itkGetConstMacro(QueueCapacity, unsigned int);
+
+  /** Passed to the IO of every decoding thread, see
+   * AnalyzeObjectLabelMapImageIO::SetUseSiblingGeometry().  Default is off. */
+  itkSetMacro(UseSiblingGeometry, bool);
+  itkGetConstMacro(UseSiblingGeometry, bool);
+  itkBooleanMacro(UseSiblingGeometry);
+
+  /** Passed to the IO of every decoding thread, see AnalyzeObjectLabelMapImageIO::SetUseCache().
+   * When on, the files are read through the object map cache by the decoding threads instead of
+   * being loaded ahead, since a cached file is not read at all.  Default is off. */
+  itkSetMacro(UseCache, bool);
+  itkGetConstMacro(UseCache, bool);
+  itkBooleanMacro(UseCache);
+
+  /** Starts the read-ahead and decoding threads.  Calling it again restarts the batch. */
+  void
+  Start();
+
+  /**
+   * \brief GetNext
+   *
+   * Waits for the next object map and returns true, or returns false once every file has been
+   * returned.  If the next file could not be read or decoded, the exception raised for it is
+   * rethrown; the batch can then be continued with the next file.  fileName, when given,
+   * receives the name of the file the object map was read from.
+   */
+  bool
+  GetNext(ObjectMapPointer & objectMap, std::string * fileName = nullptr);
+
+  /** Stops the threads, discarding the files not returned yet. */
+  void
+  Stop();
+
+protected:
+  AnalyzeObjectMapBatchReader();
+  ~AnalyzeObjectMapBatchReader() override;
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  /** The progress of a single file through the reader. */
+  struct Slot
+  {
+    std::vector<unsigned char> Bytes;
+    ObjectMapPointer           ObjectMap;
+    std::exception_ptr         Error;
+    bool                       Loaded{ false };
+    bool                       Done{ false };
+  };
+
+  void
+  ReadAhead();
+
+  void
+  Decode();
+
+  /** Reads the whole of fileName, held in bytes unless UseCache is on, through io.  The file may
+   * have more dimensions than the object map only if their size is one. */
+  ObjectMapPointer
+  ReadObjectMap(AnalyzeObjectLabelMapImageIO *     io,
+                const std::vector<unsigned char> & bytes,
+                const std::string &                fileName) const;
+
+  FileNamesContainer       m_FileNames;
+  unsigned int             m_NumberOfWorkUnits;
+  unsigned int             m_QueueCapacity{ 0 };
+  bool                     m_UseSiblingGeometry{ false };
+  bool                     m_UseCache{ false };
+  std::vector<Slot>        m_Slots;
+  SizeValueType            m_NextToDecode{ 0 };
+  SizeValueType            m_NextToReturn{ 0 };
+  bool                     m_Stopping{ false };
+  std::mutex               m_Mutex;
+  std::condition_variable  m_Condition;
+  std::vector<std::thread> m_Threads;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkAnalyzeObjectMapBatchReader.hxx"
+#endif
+
+#endif // itkAnalyzeObjectMapBatchReader_h
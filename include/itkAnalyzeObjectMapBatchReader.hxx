@@ -0,0 +1,290 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkAnalyzeObjectMapBatchReader_hxx
+#define itkAnalyzeObjectMapBatchReader_hxx
+
+#include "itkAnalyzeObjectMapBatchReader.h"
+#include "itkAnalyzeObjectMapFileTools.h"
+#include "itkMetaDataObject.h"
+#include "itkMultiThreaderBase.h"
+
+#include <algorithm>
+
+namespace itk
+{
+
+template <typename TObjectMap>
+AnalyzeObjectMapBatchReader<TObjectMap>::AnalyzeObjectMapBatchReader()
+  : m_NumberOfWorkUnits(MultiThreaderBase::GetGlobalDefaultNumberOfThreads())
+{}
+
+template <typename TObjectMap>
+AnalyzeObjectMapBatchReader<TObjectMap>::~AnalyzeObjectMapBatchReader()
+{
+  this->Stop();
+}
+
+template <typename TObjectMap>
+void
+AnalyzeObjectMapBatchReader<TObjectMap>::Start()
+{
+  this->Stop();
+  this->m_Slots = std::vector<Slot>(this->m_FileNames.size());
+  this->m_NextToDecode = 0;
+  this->m_NextToReturn = 0;
+  this->m_Stopping = false;
+
+  const unsigned int numberOfWorkUnits = std::max(1u, this->m_NumberOfWorkUnits);
+  this->m_Threads.emplace_back(&Self::ReadAhead, this);
+  for (unsigned int i = 0; i < numberOfWorkUnits; i++)
+  {
+    this->m_Threads.emplace_back(&Self::Decode, this);
+  }
+}
+
+template <typename TObjectMap>
+void
+AnalyzeObjectMapBatchReader<TObjectMap>::Stop()
+{
+  {
+    const std::lock_guard<std::mutex> lock(this->m_Mutex);
+    this->m_Stopping = true;
+  }
+  this->m_Condition.notify_all();
+  for (auto & thread : this->m_Threads)
+  {
+    thread.join();
+  }
+  this->m_Threads.clear();
+}
+
+template <typename TObjectMap>
+bool
+AnalyzeObjectMapBatchReader<TObjectMap>::GetNext(ObjectMapPointer & objectMap, std::string * fileName)
+{
+  std::unique_lock<std::mutex> lock(this->m_Mutex);
+  if (this->m_NextToReturn >= this->m_Slots.size())
+  {
+    return false;
+  }
+  if (this->m_Threads.empty())
+  {
+    itkExceptionMacro(<< "Start() must be called before GetNext().");
+  }
+  Slot & slot = this->m_Slots[this->m_NextToReturn];
+  this->m_Condition.wait(lock, [&slot] { return slot.Done; });
+  if (fileName != nullptr)
+  {
+    *fileName = this->m_FileNames[this->m_NextToReturn];
+  }
+  objectMap = slot.ObjectMap;
+  slot.ObjectMap = nullptr;
+  const std::exception_ptr error = slot.Error;
+  slot.Error = nullptr;
+  ++this->m_NextToReturn;
+  lock.unlock();
+  // The read-ahead thread may be waiting for room in the queue.
+  this->m_Condition.notify_all();
+
+  if (error)
+  {
+    std::rethrow_exception(error);
+  }
+  return true;
+}
+
+template <typename TObjectMap>
+void
+AnalyzeObjectMapBatchReader<TObjectMap>::ReadAhead()
+{
+  const SizeValueType queueCapacity =
+    this->m_QueueCapacity > 0 ? this->m_QueueCapacity : 2 * std::max(1u, this->m_NumberOfWorkUnits);
+  for (SizeValueType i = 0; i < this->m_Slots.size(); i++)
+  {
+    {
+      std::unique_lock<std::mutex> lock(this->m_Mutex);
+      this->m_Condition.wait(lock, [this, i, queueCapacity] {
+        return this->m_Stopping || i < this->m_NextToReturn + queueCapacity;
+      });
+      if (this->m_Stopping)
+      {
+        return;
+      }
+    }
+
+    // The file is read without holding the lock, so the decoders keep working meanwhile.
+    std::vector<unsigned char> bytes;
+    std::exception_ptr         error;
+    try
+    {
+      if (!this->m_UseCache)
+      {
+        AnalyzeObjectMapFileTools::ReadFile(this->m_FileNames[i], bytes);
+      }
+    }
+    catch (...)
+    {
+      error = std::current_exception();
+    }
+
+    {
+      const std::lock_guard<std::mutex> lock(this->m_Mutex);
+      Slot &                            slot = this->m_Slots[i];
+      slot.Bytes = std::move(bytes);
+      slot.Error = error;
+      slot.Loaded = true;
+      slot.Done = static_cast<bool>(error);
+    }
+    this->m_Condition.notify_all();
+  }
+}
+
+template <typename TObjectMap>
+void
+AnalyzeObjectMapBatchReader<TObjectMap>::Decode()
+{
+  // Every decoding thread has an IO of its own, which keeps its buffers from one file to the next.
+  const AnalyzeObjectLabelMapImageIO::Pointer io = AnalyzeObjectLabelMapImageIO::New();
+  io->SetOutputComponentType(ImageIOBase::MapPixelType<PixelType>::CType);
+  io->SetUseSiblingGeometry(this->m_UseSiblingGeometry);
+  io->SetUseCache(this->m_UseCache);
+  while (true)
+  {
+    // Files are decoded in order, as soon as they are loaded.
+    SizeValueType              i;
+    std::vector<unsigned char> bytes;
+    {
+      std::unique_lock<std::mutex> lock(this->m_Mutex);
+      this->m_Condition.wait(lock, [this] {
+        return this->m_Stopping || this->m_NextToDecode >= this->m_Slots.size() ||
+               this->m_Slots[this->m_NextToDecode].Loaded;
+      });
+      if (this->m_Stopping || this->m_NextToDecode >= this->m_Slots.size())
+      {
+        return;
+      }
+      i = this->m_NextToDecode++;
+      if (this->m_Slots[i].Done)
+      {
+        continue;
+      }
+      bytes = std::move(this->m_Slots[i].Bytes);
+    }
+
+    ObjectMapPointer   objectMap;
+    std::exception_ptr error;
+    try
+    {
+      objectMap = this->ReadObjectMap(io, bytes, this->m_FileNames[i]);
+    }
+    catch (...)
+    {
+      error = std::current_exception();
+    }
+
+    {
+      const std::lock_guard<std::mutex> lock(this->m_Mutex);
+      Slot &                            slot = this->m_Slots[i];
+      slot.ObjectMap = objectMap;
+      slot.Error = error;
+      slot.Done = true;
+    }
+    this->m_Condition.notify_all();
+  }
+}
+
+template <typename TObjectMap>
+auto
+AnalyzeObjectMapBatchReader<TObjectMap>::ReadObjectMap(AnalyzeObjectLabelMapImageIO *     io,
+                                                       const std::vector<unsigned char> & bytes,
+                                                       const std::string &                fileName) const
+  -> ObjectMapPointer
+{
+  // The file name is set even for the bytes in memory, for the options that look next to the file.
+  io->SetFileName(fileName);
+  if (this->m_UseCache)
+  {
+    io->ReadImageInformation();
+  }
+  else
+  {
+    io->ReadImageInformationFromMemory(bytes.data(), bytes.size());
+  }
+
+  constexpr unsigned int Dimension = ObjectMapType::ImageDimension;
+  const unsigned int     numberOfDimensions = io->GetNumberOfDimensions();
+  if (numberOfDimensions > Dimension)
+  {
+    itkGenericExceptionMacro(<< "Error: " << fileName.c_str() << " has more than " << Dimension << " dimensions.");
+  }
+  // Axes the file does not have keep a size and spacing of one and the identity direction.
+  typename ObjectMapType::RegionType    region;
+  typename ObjectMapType::SpacingType   spacing;
+  typename ObjectMapType::PointType     origin;
+  typename ObjectMapType::DirectionType direction;
+  for (unsigned int d = 0; d < Dimension; d++)
+  {
+    const bool inFile = d < numberOfDimensions;
+    region.SetSize(d, inFile ? io->GetDimensions(d) : 1);
+    spacing[d] = inFile ? io->GetSpacing(d) : 1.0;
+    origin[d] = inFile ? io->GetOrigin(d) : 0.0;
+    for (unsigned int i = 0; i < Dimension; i++)
+    {
+      direction[i][d] = inFile && i < numberOfDimensions ? io->GetDirection(d)[i] : (i == d ? 1.0 : 0.0);
+    }
+  }
+
+  ObjectMapPointer objectMap = ObjectMapType::New();
+  objectMap->SetRegions(region);
+  objectMap->SetSpacing(spacing);
+  objectMap->SetOrigin(origin);
+  objectMap->SetDirection(direction);
+  objectMap->Allocate();
+  if (this->m_UseCache)
+  {
+    io->Read(objectMap->GetBufferPointer());
+  }
+  else
+  {
+    io->ReadFromMemory(bytes.data(), bytes.size(), objectMap->GetBufferPointer());
+  }
+
+  // The entries are shared with the IO, which allocates new ones for the next file while these are held.
+  AnalyzeObjectEntryArrayType * entries = objectMap->GetAnalyzeObjectEntryArrayPointer();
+  ExposeMetaData<AnalyzeObjectEntryArrayType>(
+    io->GetMetaDataDictionary(), ANALYZE_OBJECT_LABEL_MAP_ENTRY_ARRAY, *entries);
+  objectMap->SetNumberOfObjects(static_cast<int>(entries->size()));
+  objectMap->PlaceObjectMapEntriesIntoMetaData();
+  return objectMap;
+}
+
+template <typename TObjectMap>
+void
+AnalyzeObjectMapBatchReader<TObjectMap>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfFileNames: " << this->m_FileNames.size() << std::endl;
+  os << indent << "NumberOfWorkUnits: " << this->m_NumberOfWorkUnits << std::endl;
+  os << indent << "QueueCapacity: " << this->m_QueueCapacity << std::endl;
+  os << indent << "UseSiblingGeometry: " << this->m_UseSiblingGeometry << std::endl;
+  os << indent << "UseCache: " << this->m_UseCache << std::endl;
+}
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,137 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkAnalyzeObjectMapCache_h
+#define itkAnalyzeObjectMapCache_h
+
+#include "itkAnalyzeObjectEntry.h"
+#include "itkImportImageContainer.h"
+#include "AnalyzeObjectLabelMapExport.h"
+
+#include <array>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace itk
+{
+/** \class AnalyzeObjectMapCache
+ *  \ingroup AnalyzeObjectLabelMap
+ *  \ingroup AnalyzeObjectMapIO
+ *  \brief A process wide cache of decoded object maps.
+ *
+ * Holds the header, the object entries and the decoded voxels of recently read object maps,
+ * keyed by file name.  A cached map is only returned while the length and modification time of
+ * the file still match those recorded when it was decoded.  When the total size of the cached
+ * maps exceeds the byte budget the least recently used maps are evicted.  The voxels are shared,
+ * read only, between the cache and every reader of the map.  All methods are thread safe.
+ */
+class AnalyzeObjectLabelMap_EXPORT AnalyzeObjectMapCache
+{
+public:
+  using EntryArrayType = std::vector<AnalyzeObjectEntry::Pointer>;
+  using VoxelContainerType = ImportImageContainer<SizeValueType, unsigned char>;
+
+  /** A decoded object map. */
+  struct CachedObjectMap
+  {
+    /** Length and modification time of the file the map was decoded from. */
+    SizeValueType FileLength{ 0 };
+    long          ModifiedTime{ 0 };
+
+    /** The header in native byte order: version, x, y, z, number of objects, t. */
+    std::array<int, 6> Header{ { 0, 1, 1, 1, 0, 1 } };
+
+    /** Byte offset of the run length encoded data in the file. */
+    std::streamoff DataOffset{ 0 };
+
+    /** The object entries.  They are never handed out, only copied. */
+    EntryArrayType Entries;
+
+    /** The decoded voxels, as unsigned char labels. */
+    VoxelContainerType::ConstPointer Voxels;
+
+    /** Approximate number of bytes held by the map. */
+    SizeValueType
+    GetSizeInBytes() const;
+  };
+
+  /** The cache shared by the whole process. */
+  static AnalyzeObjectMapCache &
+  GetInstance();
+
+  /** Copies the cached map of fileName into map and marks it as most recently used.  Returns
+   * false if the file is not cached, or if it was cached with a different length or
+   * modification time, in which case the stale map is evicted. */
+  bool
+  Find(const std::string & fileName, SizeValueType fileLength, long modifiedTime, CachedObjectMap & map);
+
+  /** Caches map, which must hold voxels, as the most recently used map of fileName and evicts
+   * maps until the budget is met.  A map larger than the whole budget is not cached. */
+  void
+  Insert(const std::string & fileName, const CachedObjectMap & map);
+
+  /** Evicts the map of fileName, if any. */
+  void
+  Remove(const std::string & fileName);
+
+  /** Evicts every map. */
+  void
+  Clear();
+
+  /** Byte budget of the cache.  Lowering it evicts maps immediately.  Default is 512 MiB. */
+  void
+  SetMaximumSizeInBytes(SizeValueType maximumSizeInBytes);
+  SizeValueType
+  GetMaximumSizeInBytes() const;
+
+  /** Number of bytes held by the cached maps. */
+  SizeValueType
+  GetSizeInBytes() const;
+
+  /** Number of cached maps. */
+  SizeValueType
+  GetNumberOfCachedMaps() const;
+
+  /** Returns deep copies of entries, so that changes to them do not alter the originals. */
+  static EntryArrayType
+  CopyEntries(const EntryArrayType & entries);
+
+private:
+  AnalyzeObjectMapCache() = default;
+
+  using ListType = std::list<std::pair<std::string, CachedObjectMap>>;
+
+  /** Evicts least recently used maps until the budget is met.  The mutex must be held. */
+  void
+  Evict();
+
+  /** Evicts the map at position.  The mutex must be held. */
+  void
+  Erase(ListType::iterator position);
+
+  mutable std::mutex                                  m_Mutex;
+  ListType                                            m_Maps; // Most recently used first.
+  std::unordered_map<std::string, ListType::iterator> m_Index;
+  SizeValueType                                       m_SizeInBytes{ 0 };
+  SizeValueType                                       m_MaximumSizeInBytes{ SizeValueType{ 512 } << 20 };
+};
+} // end namespace itk
+
+#endif // itkAnalyzeObjectMapCache_h
@@ -0,0 +1,154 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkAnalyzeObjectMapComparator_h
+#define itkAnalyzeObjectMapComparator_h
+
+#include "itkAnalyzeObjectEntryRecord.h"
+#include "AnalyzeObjectLabelMapExport.h"
+
+#include <array>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace itk
+{
+/** \class AnalyzeObjectMapComparator
+ *  \ingroup AnalyzeObjectLabelMap
+ *  \ingroup AnalyzeObjectMapIO
+ *  \brief Compares two object maps without decoding their voxels.
+ *
+ * The headers are compared field by field, and so are the entries of the same label.  The run
+ * streams are then walked side by side, a plane at a time, which gives the first plane and row
+ * where the labels differ, and the number of voxels of every label in each map and in both.  The
+ * cost is proportional to the number of runs, so comparing many files against their baselines is
+ * limited by the time needed to read them.
+ *
+ * \code
+ *   itk::AnalyzeObjectMapComparator comparator;
+ *   comparator.CompareFiles("baseline.obj", "output.obj");
+ *   if (!comparator.IsEqual())
+ *   {
+ *     comparator.Print(std::cerr);
+ *   }
+ * \endcode
+ */
+class AnalyzeObjectLabelMap_EXPORT AnalyzeObjectMapComparator
+{
+public:
+  /** Number of labels an object map can hold. */
+  static constexpr unsigned int NumberOfLabels = 256;
+
+  /** The voxels of a label in the first map, in the second map, and in both. */
+  struct LabelStatistics
+  {
+    SizeValueType FirstVoxels{ 0 };
+    SizeValueType SecondVoxels{ 0 };
+    SizeValueType CommonVoxels{ 0 };
+
+    /** Number of voxels of the label in the second map minus that in the first map. */
+    long long
+    GetVoxelDelta() const
+    {
+      return static_cast<long long>(this->SecondVoxels) - static_cast<long long>(this->FirstVoxels);
+    }
+
+    /** The Dice coefficient of the label, 1 when neither map has it. */
+    double
+    GetDice() const
+    {
+      const SizeValueType total = this->FirstVoxels + this->SecondVoxels;
+      return total > 0 ? 2.0 * this->CommonVoxels / total : 1.0;
+    }
+  };
+
+  using LabelStatisticsContainerType = std::array<LabelStatistics, NumberOfLabels>;
+
+  /**
+   * \brief Compare
+   *
+   * Compares two whole object map files held in memory.  When their sizes differ, only the headers
+   * and the entries are compared: the voxels are then reported as differing from the first row,
+   * and the label statistics are zero.  Throws if either file is not a valid object map.
+   */
+  void
+  Compare(const unsigned char * first,
+          SizeValueType         numberOfFirstBytes,
+          const unsigned char * second,
+          SizeValueType         numberOfSecondBytes);
+
+  /** Compares the object maps of two files. */
+  void
+  CompareFiles(const std::string & firstFileName, const std::string & secondFileName);
+
+  /** The differing fields of the headers and entries, as "Dimensions[2]" or "Entries[3].EndRed". */
+  const std::vector<std::string> &
+  GetHeaderDifferences() const
+  {
+    return this->m_HeaderDifferences;
+  }
+
+  bool
+  HeadersAreEqual() const
+  {
+    return this->m_HeaderDifferences.empty();
+  }
+
+  bool
+  VoxelsAreEqual() const
+  {
+    return !this->m_VoxelsDiffer;
+  }
+
+  bool
+  IsEqual() const
+  {
+    return this->HeadersAreEqual() && this->VoxelsAreEqual();
+  }
+
+  /** Returns true, and sets the plane (z + t * zDimension) and the row of the first voxel whose
+   * label differs, if the voxels differ. */
+  bool
+  GetFirstDifference(SizeValueType & plane, SizeValueType & row) const
+  {
+    plane = this->m_FirstDifferentPlane;
+    row = this->m_FirstDifferentRow;
+    return this->m_VoxelsDiffer;
+  }
+
+  /** The voxels of every label, indexed by label. */
+  const LabelStatisticsContainerType &
+  GetLabelStatistics() const
+  {
+    return this->m_LabelStatistics;
+  }
+
+  /** Prints the differences, and the statistics of every label that is in either map. */
+  void
+  Print(std::ostream & os) const;
+
+private:
+  std::vector<std::string>     m_HeaderDifferences;
+  bool                         m_VoxelsDiffer{ false };
+  SizeValueType                m_FirstDifferentPlane{ 0 };
+  SizeValueType                m_FirstDifferentRow{ 0 };
+  LabelStatisticsContainerType m_LabelStatistics;
+};
+} // end namespace itk
+
+#endif // itkAnalyzeObjectMapComparator_h
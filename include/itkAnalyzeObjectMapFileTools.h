@@ -0,0 +1,45 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkAnalyzeObjectMapFileTools_h
+#define itkAnalyzeObjectMapFileTools_h
+
+#include "itkIntTypes.h"
+#include "AnalyzeObjectLabelMapExport.h"
+
+#include <string>
+#include <vector>
+
+namespace itk
+{
+/** \class AnalyzeObjectMapFileTools
+ *  \ingroup AnalyzeObjectLabelMap
+ *  \ingroup AnalyzeObjectMapIO
+ *  \brief Reads object map files whole, for the classes that work on maps held in memory.
+ */
+class AnalyzeObjectLabelMap_EXPORT AnalyzeObjectMapFileTools
+{
+public:
+  using BufferType = std::vector<unsigned char>;
+
+  /** Reads the whole of fileName into bytes.  Throws if the file cannot be read. */
+  static void
+  ReadFile(const std::string & fileName, BufferType & bytes);
+};
+} // end namespace itk
+
+#endif // itkAnalyzeObjectMapFileTools_h
@@ -0,0 +1,190 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkAnalyzeObjectMapFrameProcessor_h
+#define itkAnalyzeObjectMapFrameProcessor_h
+
+#include "itkAnalyzeObjectMap.h"
+#include "itkAnalyzeObjectEntryRecord.h"
+#include "itkAnalyzeObjectPlaneIndex.h"
+#include "itkMultiThreaderBase.h"
+
+#include <exception>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace itk
+{
+/** \class AnalyzeObjectMapFrameProcessor
+ *  \ingroup AnalyzeObjectLabelMap
+ *  \ingroup AnalyzeObjectMapIO
+ *  \brief Reads the time frames of an object map one at a time, and processes them in parallel.
+ *
+ * The planes of a frame are contiguous in the run stream, so the plane index of the file, built
+ * once by Initialize() or loaded from its sidecar, also gives the offset of every frame.
+ * ReadFrame() seeks to a frame and decodes its planes alone, into an object map of a single frame
+ * with the entries of the file; planes that hold a single label are filled without being read.
+ * ReadFrame() opens its own stream, so frames can be read from several threads at once.
+ *
+ * MapReduce() reads every frame on NumberOfWorkUnits threads, applies a function to each one, such
+ * as computing statistics, PickOneEntry() or ObjectMapToRGBImage(), and folds the results in the
+ * order of the frames.  Only the frames being processed are held in memory, but the result of
+ * every frame is kept until all of them are folded, so map should return small results.
+ *
+ * \code
+ *   auto processor = itk::AnalyzeObjectMapFrameProcessor<>::New();
+ *   processor->SetFileName("dynamic.obj");
+ *   processor->Initialize();
+ *   const itk::SizeValueType labelled = processor->MapReduce(
+ *     [](ObjectMapType * frame, itk::SizeValueType) { return CountLabelledVoxels(frame); },
+ *     [](itk::SizeValueType & total, itk::SizeValueType count) { total += count; },
+ *     itk::SizeValueType{ 0 });
+ * \endcode
+ */
+template <typename TObjectMap = AnalyzeObjectMap<>>
+class ITK_TEMPLATE_EXPORT AnalyzeObjectMapFrameProcessor : public Object
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(AnalyzeObjectMapFrameProcessor);
+
+  /** Standard class type alias. */
+  using Self = AnalyzeObjectMapFrameProcessor;
+  using Superclass = Object;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  using ObjectMapType = TObjectMap;
+  using ObjectMapPointer = typename ObjectMapType::Pointer;
+  using PixelType = typename ObjectMapType::PixelType;
+
+  static_assert(ObjectMapType::ImageDimension >= 3, "The frames of an object map have three dimensions.");
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(AnalyzeObjectMapFrameProcessor, Object);
+
+  /** The object map file.  Initialize() must be called after it is set. */
+  itkSetStringMacro(FileName);
+  itkGetStringMacro(FileName);
+
+  /** Number of threads MapReduce() processes frames on.  Default is the global default number of threads. */
+  itkSetMacro(NumberOfWorkUnits, unsigned int);
+  itkGetConstMacro(NumberOfWorkUnits, unsigned int);
+
+  /** Reads the header and the entries of the file, and loads the plane index from the sidecar of
+   * the file when it is up to date, or builds it.  Throws if the file is not an object map or its
+   * planes cannot be indexed. */
+  void
+  Initialize();
+
+  /** Number of time frames of the file. */
+  SizeValueType
+  GetNumberOfFrames() const
+  {
+    return this->m_Header.Valid ? this->m_Header.Dimensions[3] : 0;
+  }
+
+  /** The header and entries of the file. */
+  const AnalyzeObjectMapHeaderRecord &
+  GetHeader() const
+  {
+    return this->m_Header;
+  }
+
+  /** Byte offset, from the start of the file, of the first run of frame. */
+  AnalyzeObjectPlaneIndex::OffsetType
+  GetFrameOffset(SizeValueType frame) const
+  {
+    return this->m_PlaneIndex.GetPlaneOffset(frame * this->m_Header.Dimensions[2]);
+  }
+
+  /** Decodes frame into a new object map, whose fourth dimension, if it has one, has a size of 1.
+   * Thread safe.  Throws if the frame does not exist or cannot be decoded. */
+  ObjectMapPointer
+  ReadFrame(SizeValueType frame) const;
+
+  /**
+   * \brief MapReduce
+   *
+   * Calls map(frameObjectMap, frame) for every frame, on NumberOfWorkUnits threads, then
+   * reduce(result, mapped) with the value returned for every frame, in the order of the frames,
+   * starting from initial.  The mapped values are kept until they are reduced.  If map() throws,
+   * or a frame cannot be decoded, the exception of the first such frame is rethrown.
+   */
+  template <typename TResult, typename TMapFunction, typename TReduceFunction>
+  TResult
+  MapReduce(TMapFunction && map, TReduceFunction && reduce, TResult initial) const
+  {
+    // Every value is held by value, even if map() returns a reference, and allocated on its own, so that
+    // it needs no default constructor and threads never share the word of a std::vector<bool>.
+    using MappedType = typename std::decay<decltype(map(std::declval<ObjectMapType *>(), SizeValueType{}))>::type;
+    const SizeValueType                      numberOfFrames = this->GetNumberOfFrames();
+    std::vector<std::unique_ptr<MappedType>> mapped(numberOfFrames);
+    std::vector<std::exception_ptr>          errors(numberOfFrames);
+    MultiThreaderBase::Pointer      threader = MultiThreaderBase::New();
+    threader->SetMaximumNumberOfThreads(this->m_NumberOfWorkUnits);
+    threader->SetNumberOfWorkUnits(this->m_NumberOfWorkUnits);
+    threader->ParallelizeArray(
+      0,
+      numberOfFrames,
+      [this, &map, &mapped, &errors](SizeValueType frame) {
+        try
+        {
+          ObjectMapPointer objectMap = this->ReadFrame(frame);
+          mapped[frame].reset(new MappedType(map(objectMap.GetPointer(), frame)));
+        }
+        catch (...)
+        {
+          errors[frame] = std::current_exception();
+        }
+      },
+      nullptr);
+    for (SizeValueType frame = 0; frame < numberOfFrames; frame++)
+    {
+      if (errors[frame])
+      {
+        std::rethrow_exception(errors[frame]);
+      }
+      reduce(initial, std::move(*mapped[frame]));
+    }
+    return initial;
+  }
+
+protected:
+  AnalyzeObjectMapFrameProcessor();
+  ~AnalyzeObjectMapFrameProcessor() override = default;
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  std::string                  m_FileName;
+  unsigned int                 m_NumberOfWorkUnits;
+  AnalyzeObjectMapHeaderRecord m_Header;
+  AnalyzeObjectPlaneIndex      m_PlaneIndex;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkAnalyzeObjectMapFrameProcessor.hxx"
+#endif
+
+#endif // itkAnalyzeObjectMapFrameProcessor_h
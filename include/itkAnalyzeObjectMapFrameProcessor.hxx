@@ -0,0 +1,144 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkAnalyzeObjectMapFrameProcessor_hxx
+#define itkAnalyzeObjectMapFrameProcessor_hxx
+
+#include "itkAnalyzeObjectMapFrameProcessor.h"
+#include "itkAnalyzeObjectLabelMapImageIO.h"
+#include "itksys/SystemTools.hxx"
+
+#include <algorithm>
+#include <fstream>
+
+namespace itk
+{
+
+template <typename TObjectMap>
+AnalyzeObjectMapFrameProcessor<TObjectMap>::AnalyzeObjectMapFrameProcessor()
+  : m_NumberOfWorkUnits(MultiThreaderBase::GetGlobalDefaultNumberOfThreads())
+{}
+
+template <typename TObjectMap>
+void
+AnalyzeObjectMapFrameProcessor<TObjectMap>::Initialize()
+{
+  this->m_PlaneIndex.Clear();
+  if (!AnalyzeObjectLabelMapImageIO::ProbeHeader(this->m_FileName, this->m_Header))
+  {
+    itkExceptionMacro(<< "Error: " << this->m_FileName.c_str() << " is not an Analyze object map, or is truncated.");
+  }
+  for (unsigned int d = ObjectMapType::ImageDimension; d < 4; d++)
+  {
+    if (this->m_Header.Dimensions[d] != 1)
+    {
+      this->m_Header.Valid = false;
+      itkExceptionMacro(<< "Error: " << this->m_FileName.c_str() << " has more than "
+                        << ObjectMapType::ImageDimension << " dimensions.");
+    }
+  }
+
+  // The index is shared with AnalyzeObjectLabelMapImageIO through the sidecar, when there is one.
+  const SizeValueType planeSize =
+    static_cast<SizeValueType>(this->m_Header.Dimensions[0]) * this->m_Header.Dimensions[1];
+  const SizeValueType numberOfPlanes =
+    static_cast<SizeValueType>(this->m_Header.Dimensions[2]) * this->m_Header.Dimensions[3];
+  const std::string sidecarFileName = this->m_FileName + AnalyzeObjectPlaneIndex::SidecarExtension;
+  if (!this->m_PlaneIndex.Load(sidecarFileName,
+                               itksys::SystemTools::FileLength(this->m_FileName),
+                               itksys::SystemTools::ModifiedTime(this->m_FileName),
+                               this->m_Header.DataOffset,
+                               planeSize,
+                               numberOfPlanes))
+  {
+    std::ifstream inputFileStream(this->m_FileName.c_str(), std::ios::binary | std::ios::in);
+    if (!this->m_PlaneIndex.Build(inputFileStream, this->m_Header.DataOffset, planeSize, numberOfPlanes))
+    {
+      this->m_Header.Valid = false;
+      itkExceptionMacro(<< "The planes of " << this->m_FileName.c_str() << " can not be indexed.");
+    }
+  }
+}
+
+template <typename TObjectMap>
+auto
+AnalyzeObjectMapFrameProcessor<TObjectMap>::ReadFrame(SizeValueType frame) const -> ObjectMapPointer
+{
+  if (frame >= this->GetNumberOfFrames())
+  {
+    itkExceptionMacro(<< "Frame " << frame << " of " << this->m_FileName.c_str() << " does not exist.");
+  }
+  typename ObjectMapType::RegionType region;
+  for (unsigned int d = 0; d < ObjectMapType::ImageDimension; d++)
+  {
+    region.SetSize(d, d < 3 ? this->m_Header.Dimensions[d] : 1);
+  }
+  ObjectMapPointer objectMap = ObjectMapType::New();
+  objectMap->SetRegions(region);
+  objectMap->Allocate();
+
+  // Planes that hold a single label are filled, the others are read and decoded one at a time.
+  const SizeValueType        planeSize =
+    static_cast<SizeValueType>(this->m_Header.Dimensions[0]) * this->m_Header.Dimensions[1];
+  const SizeValueType        zDimension = this->m_Header.Dimensions[2];
+  std::ifstream              inputFileStream(this->m_FileName.c_str(), std::ios::binary | std::ios::in);
+  std::vector<unsigned char> RunLengthArray;
+  PixelType *                out = objectMap->GetBufferPointer();
+  for (SizeValueType plane = frame * zDimension; plane < (frame + 1) * zDimension; plane++, out += planeSize)
+  {
+    unsigned char uniformLabel;
+    if (this->m_PlaneIndex.GetPlaneUniformLabel(plane, uniformLabel))
+    {
+      std::fill_n(out, planeSize, static_cast<PixelType>(uniformLabel));
+      continue;
+    }
+    RunLengthArray.resize(this->m_PlaneIndex.GetPlaneLength(plane));
+    inputFileStream.seekg(this->m_PlaneIndex.GetPlaneOffset(plane));
+    SizeValueType index = 0;
+    if (inputFileStream.read(reinterpret_cast<char *>(RunLengthArray.data()), RunLengthArray.size()).fail() ||
+        !AnalyzeObjectRunLengthCodec::DecodeRuns(RunLengthArray.data(), RunLengthArray.size(), out, planeSize, index) ||
+        index != planeSize)
+    {
+      itkExceptionMacro(<< "Error decoding plane " << plane << " of " << this->m_FileName.c_str());
+    }
+  }
+
+  AnalyzeObjectEntryArrayType * entries = objectMap->GetAnalyzeObjectEntryArrayPointer();
+  entries->resize(this->m_Header.Entries.size());
+  for (unsigned int i = 0; i < entries->size(); i++)
+  {
+    (*entries)[i] = AnalyzeObjectEntry::New();
+    (*entries)[i]->CopyFromRecord(this->m_Header.Entries[i]);
+  }
+  objectMap->SetNumberOfObjects(static_cast<int>(entries->size()));
+  objectMap->PlaceObjectMapEntriesIntoMetaData();
+  return objectMap;
+}
+
+template <typename TObjectMap>
+void
+AnalyzeObjectMapFrameProcessor<TObjectMap>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "FileName: " << this->m_FileName << std::endl;
+  os << indent << "NumberOfWorkUnits: " << this->m_NumberOfWorkUnits << std::endl;
+  os << indent << "NumberOfFrames: " << this->GetNumberOfFrames() << std::endl;
+}
+
+} // end namespace itk
+
+#endif
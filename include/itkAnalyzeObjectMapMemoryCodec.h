@@ -0,0 +1,110 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkAnalyzeObjectMapMemoryCodec_h
+#define itkAnalyzeObjectMapMemoryCodec_h
+
+#include "itkAnalyzeObjectEntryRecord.h"
+#include "itkAnalyzeObjectRunLengthCodec.h"
+#include "AnalyzeObjectLabelMapExport.h"
+
+#include <vector>
+
+namespace itk
+{
+/** \class AnalyzeObjectMapMemoryCodec
+ *  \ingroup AnalyzeObjectLabelMap
+ *  \ingroup AnalyzeObjectMapIO
+ *  \brief Decodes and encodes whole object maps held in memory.
+ *
+ * An object map received as a message, or kept in an object store, is decoded from the bytes that
+ * hold it and encoded into a buffer that grows to hold it, without a temporary file.  The header
+ * and the entries are converted by AnalyzeObjectMapHeaderRecord and the voxels by
+ * AnalyzeObjectRunLengthCodec, as when AnalyzeObjectLabelMapImageIO reads and writes files; its
+ * ReadImageInformationFromMemory(), ReadFromMemory() and WriteToMemory() do the same for images.
+ *
+ * \code
+ *   itk::AnalyzeObjectMapHeaderRecord header;
+ *   std::vector<unsigned char>        voxels;
+ *   if (!itk::AnalyzeObjectMapMemoryCodec::Decode(payload.data(), payload.size(), header, voxels))
+ *   {
+ *     // payload does not hold a valid object map
+ *   }
+ * \endcode
+ */
+class AnalyzeObjectLabelMap_EXPORT AnalyzeObjectMapMemoryCodec
+{
+public:
+  /** The encoded object map. */
+  using BufferType = AnalyzeObjectRunLengthCodec::BufferType;
+
+  /** Decodes the header and the entries of the object map held in the numberOfBytes bytes at data
+   * into header, whose DataOffset then gives where the runs start.  Returns false if the bytes do
+   * not start with a valid header and entry table. */
+  static bool
+  DecodeHeader(const void * data, SizeValueType numberOfBytes, AnalyzeObjectMapHeaderRecord & header);
+
+  /**
+   * \brief DecodeVoxels
+   *
+   * Expands the runs of the object map held in the numberOfBytes bytes at data, whose header was
+   * decoded into header, into voxels, which holds GetNumberOfVoxels(header) voxels.  Returns false
+   * if the runs do not hold exactly that many voxels.
+   */
+  template <typename TPixel>
+  static bool
+  DecodeVoxels(const void *                         data,
+               SizeValueType                        numberOfBytes,
+               const AnalyzeObjectMapHeaderRecord & header,
+               TPixel *                             voxels);
+
+  /** Decodes the header, the entries and the voxels of the object map held in the numberOfBytes
+   * bytes at data.  voxels is resized to hold every voxel.  Returns false if the bytes do not hold
+   * a valid object map. */
+  static bool
+  Decode(const void *                   data,
+         SizeValueType                  numberOfBytes,
+         AnalyzeObjectMapHeaderRecord & header,
+         std::vector<unsigned char> &   voxels);
+
+  /**
+   * \brief Encode
+   *
+   * Replaces the content of output by the object map of header, its entries and voxels, which
+   * holds GetNumberOfVoxels(header) voxels, in the layout of header.Version and the byte order of
+   * header.BigEndian.  output keeps its capacity, so a buffer reused for many maps is allocated
+   * once.  Returns false, leaving output empty, if a voxel lies outside [0,255].
+   */
+  template <typename TPixel>
+  static bool
+  Encode(const AnalyzeObjectMapHeaderRecord & header, const TPixel * voxels, BufferType & output);
+
+  /** Number of voxels of the four dimensions of header. */
+  static SizeValueType
+  GetNumberOfVoxels(const AnalyzeObjectMapHeaderRecord & header)
+  {
+    return static_cast<SizeValueType>(header.Dimensions[0]) * header.Dimensions[1] * header.Dimensions[2] *
+           header.Dimensions[3];
+  }
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkAnalyzeObjectMapMemoryCodec.hxx"
+#endif
+
+#endif // itkAnalyzeObjectMapMemoryCodec_h
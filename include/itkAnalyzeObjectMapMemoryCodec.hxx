@@ -0,0 +1,69 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkAnalyzeObjectMapMemoryCodec_hxx
+#define itkAnalyzeObjectMapMemoryCodec_hxx
+
+#include "itkAnalyzeObjectMapMemoryCodec.h"
+
+namespace itk
+{
+
+template <typename TPixel>
+bool
+AnalyzeObjectMapMemoryCodec::DecodeVoxels(const void *                         data,
+                                          SizeValueType                        numberOfBytes,
+                                          const AnalyzeObjectMapHeaderRecord & header,
+                                          TPixel *                             voxels)
+{
+  if (!header.Valid || header.DataOffset > numberOfBytes)
+  {
+    return false;
+  }
+  const SizeValueType numberOfVoxels = GetNumberOfVoxels(header);
+  SizeValueType       index = 0;
+  return AnalyzeObjectRunLengthCodec::DecodeRuns(static_cast<const unsigned char *>(data) + header.DataOffset,
+                                                 numberOfBytes - header.DataOffset,
+                                                 voxels,
+                                                 numberOfVoxels,
+                                                 index) &&
+         index == numberOfVoxels;
+}
+
+template <typename TPixel>
+bool
+AnalyzeObjectMapMemoryCodec::Encode(const AnalyzeObjectMapHeaderRecord & header,
+                                    const TPixel *                       voxels,
+                                    BufferType &                         output)
+{
+  // The header and the entries are encoded first, then the runs are appended after them.
+  header.Encode(output, header.BigEndian);
+  if (!AnalyzeObjectRunLengthCodec::EncodeVolume(
+        voxels,
+        GetNumberOfVoxels(header),
+        static_cast<SizeValueType>(header.Dimensions[0]) * header.Dimensions[1],
+        output))
+  {
+    output.clear();
+    return false;
+  }
+  return true;
+}
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,171 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkAnalyzeObjectMapMerger_h
+#define itkAnalyzeObjectMapMerger_h
+
+#include "itkAnalyzeObjectEntryRecord.h"
+#include "AnalyzeObjectLabelMapExport.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace itk
+{
+/** \class AnalyzeObjectMapMerger
+ *  \ingroup AnalyzeObjectLabelMap
+ *  \ingroup AnalyzeObjectMapIO
+ *  \brief Combines two object maps of the same size without decoding their voxels.
+ *
+ * The run streams of both maps are walked side by side, a plane at a time, and every stretch of
+ * voxels where neither map changes label becomes a single run of the merged map.  The cost is
+ * therefore proportional to the number of runs rather than to the number of voxels.
+ *
+ * The entries of the merged map are those of the first map, followed by the entries of the second
+ * map whose name is not already used, when MatchEntriesByName is on, or by all of them otherwise.
+ * A label of the second map is renumbered to the label of its entry in the merged map.  Where both
+ * maps have an object, the Union, Intersection and Priority operations take the label chosen by
+ * the conflict policy, or by the conflict function when one is set:
+ *
+ * - Union: the objects of both maps;
+ * - Intersection: the voxels where both maps have an object;
+ * - Difference: the objects of the first map, except where the second map has an object;
+ * - Priority: the objects of the second map painted over those of the first map.
+ *
+ * The merged map is written as VERSION7, big endian, with the size of the first map.
+ *
+ * \code
+ *   itk::AnalyzeObjectMapMerger merger;
+ *   merger.SetOperation(itk::AnalyzeObjectMapMerger::OperationEnum::Union);
+ *   merger.SetConflictPolicy(itk::AnalyzeObjectMapMerger::ConflictPolicyEnum::KeepSecond);
+ *   merger.MergeFiles("atlas.obj", "lesions.obj", "merged.obj");
+ * \endcode
+ */
+class AnalyzeObjectLabelMap_EXPORT AnalyzeObjectMapMerger
+{
+public:
+  using BufferType = std::vector<unsigned char>;
+
+  /** Returns the label of a voxel where the first map has label first and the second map label
+   * second, both already numbered as in the merged map. */
+  using ConflictFunctionType = std::function<unsigned char(unsigned char first, unsigned char second)>;
+
+  enum class OperationEnum : std::uint8_t
+  {
+    Union,
+    Intersection,
+    Difference,
+    Priority
+  };
+
+  /** How a voxel that holds an object in both maps is labelled, when the objects differ. */
+  enum class ConflictPolicyEnum : std::uint8_t
+  {
+    KeepFirst,
+    KeepSecond,
+    Background
+  };
+
+  void
+  SetOperation(OperationEnum operation)
+  {
+    this->m_Operation = operation;
+  }
+  OperationEnum
+  GetOperation() const
+  {
+    return this->m_Operation;
+  }
+
+  /** Default is KeepFirst. */
+  void
+  SetConflictPolicy(ConflictPolicyEnum conflictPolicy)
+  {
+    this->m_ConflictPolicy = conflictPolicy;
+  }
+  ConflictPolicyEnum
+  GetConflictPolicy() const
+  {
+    return this->m_ConflictPolicy;
+  }
+
+  /** Replaces the conflict policy when set.  It is called once for every pair of labels, before
+   * the runs are merged, and must return a label of the merged map. */
+  void
+  SetConflictFunction(const ConflictFunctionType & conflictFunction)
+  {
+    this->m_ConflictFunction = conflictFunction;
+  }
+
+  /** Whether an entry of the second map reuses the entry of the first map with the same name.
+   * Default is on. */
+  void
+  SetMatchEntriesByName(bool matchEntriesByName)
+  {
+    this->m_MatchEntriesByName = matchEntriesByName;
+  }
+  bool
+  GetMatchEntriesByName() const
+  {
+    return this->m_MatchEntriesByName;
+  }
+
+  /**
+   * \brief Merge
+   *
+   * Merges two whole object map files held in memory into output, which receives a whole object
+   * map file.  Throws if either map is invalid, if their sizes differ, if the merged map would
+   * have more than 256 entries, or if a label of the merged map has no entry.
+   */
+  void
+  Merge(const unsigned char * first,
+        SizeValueType         numberOfFirstBytes,
+        const unsigned char * second,
+        SizeValueType         numberOfSecondBytes,
+        BufferType &          output) const;
+
+  /** Merges the object maps of two files into a third one, which may be one of them.  The third
+   * file is replaced whole, through AnalyzeObjectMapAtomicWriter. */
+  void
+  MergeFiles(const std::string & firstFileName,
+             const std::string & secondFileName,
+             const std::string & outputFileName) const;
+
+private:
+  /** Label of the merged map for every pair of labels of the first and second maps, or
+   * NoLabel when the pair has no entry in the merged map. */
+  using LabelTableType = std::vector<std::uint16_t>;
+
+  static constexpr std::uint16_t NoLabel = 256;
+
+  /** Fills the entries of merged and the label table of the operation. */
+  void
+  MergeEntries(const AnalyzeObjectMapHeaderRecord & first,
+               const AnalyzeObjectMapHeaderRecord & second,
+               AnalyzeObjectMapHeaderRecord &       merged,
+               LabelTableType &                     labels) const;
+
+  OperationEnum        m_Operation{ OperationEnum::Union };
+  ConflictPolicyEnum   m_ConflictPolicy{ ConflictPolicyEnum::KeepFirst };
+  ConflictFunctionType m_ConflictFunction;
+  bool                 m_MatchEntriesByName{ true };
+};
+} // end namespace itk
+
+#endif // itkAnalyzeObjectMapMerger_h
@@ -0,0 +1,170 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkAnalyzeObjectMapOverlayImageFilter_h
+#define itkAnalyzeObjectMapOverlayImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkRGBPixel.h"
+#include "itkAnalyzeObjectEntryTable.h"
+
+#include <array>
+#include <vector>
+
+namespace itk
+{
+/** \class AnalyzeObjectMapOverlayImageFilter
+ *  \ingroup AnalyzeObjectLabelMap
+ *  \brief Paints the objects of an object map over an intensity image, as the Analyze entries describe.
+ *
+ * The first input is the intensity image, the second the label image, usually an
+ * AnalyzeObjectMap.  The intensities are windowed to [IntensityMinimum, IntensityMaximum] and shown
+ * in gray, NaN as black, and every voxel of a displayed object is blended with the colour of its entry:
+ *
+ * - with a Shades of one the colour is EndRed, EndGreen and EndBlue, as in ObjectMapToRGBImage();
+ *   with more shades it goes from the Start colour for dark voxels to the End colour for bright
+ *   ones, in Shades steps;
+ * - a BlendFactor above zero darkens the colour with the intensity underneath, so that the anatomy
+ *   stays visible inside the object (a BlendFactor of one scales it by the windowed intensity);
+ * - the colour is mixed with the gray by Opacity, and objects whose DisplayFlag is zero are not
+ *   painted.
+ *
+ * The colours of every label and gray level are computed once per update, so the threads only look
+ * them up, row by row and without branches.  Only the requested region of the output is computed,
+ * which lets a slice view update a single slice.  The entries are taken from SetEntryTable() or, when
+ * none is given, from the metadata dictionary of the label image.  Labels without an entry, and the
+ * background label 0 unless PaintBackground is on, are left gray.
+ *
+ * \code
+ *   auto overlay = itk::AnalyzeObjectMapOverlayImageFilter<ImageType, ObjectMapType>::New();
+ *   overlay->SetInput(intensityImage);
+ *   overlay->SetLabelImage(objectMap);
+ *   overlay->SetIntensityMinimum(0);
+ *   overlay->SetIntensityMaximum(4095);
+ *   overlay->GetOutput()->SetRequestedRegion(slice);
+ *   overlay->Update();
+ * \endcode
+ */
+template <typename TIntensityImage,
+          typename TLabelImage,
+          typename TOutputImage = Image<RGBPixel<unsigned char>, TIntensityImage::ImageDimension>>
+class ITK_TEMPLATE_EXPORT AnalyzeObjectMapOverlayImageFilter : public ImageToImageFilter<TIntensityImage, TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(AnalyzeObjectMapOverlayImageFilter);
+
+  /** Standard class type alias. */
+  using Self = AnalyzeObjectMapOverlayImageFilter;
+  using Superclass = ImageToImageFilter<TIntensityImage, TOutputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  using IntensityImageType = TIntensityImage;
+  using LabelImageType = TLabelImage;
+  using OutputImageType = TOutputImage;
+  using IntensityPixelType = typename IntensityImageType::PixelType;
+  using LabelPixelType = typename LabelImageType::PixelType;
+  using OutputPixelType = typename OutputImageType::PixelType;
+  using OutputImageRegionType = typename OutputImageType::RegionType;
+
+  /** Number of labels that can have an entry; larger labels are left gray. */
+  static constexpr unsigned int NumberOfLabels = 256;
+
+  /** Number of gray levels the windowed intensities are mapped to. */
+  static constexpr unsigned int NumberOfLevels = 256;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(AnalyzeObjectMapOverlayImageFilter, ImageToImageFilter);
+
+  /** The label image painted over the intensity image. */
+  void
+  SetLabelImage(const LabelImageType * labelImage)
+  {
+    this->SetNthInput(1, const_cast<LabelImageType *>(labelImage));
+  }
+  const LabelImageType *
+  GetLabelImage() const
+  {
+    return itkDynamicCastInDebugMode<const LabelImageType *>(this->ProcessObject::GetInput(1));
+  }
+
+  /** The entries describing the colours of the labels.  An empty table, the default, takes the
+   * entries from the metadata dictionary of the label image. */
+  void
+  SetEntryTable(const AnalyzeObjectEntryTable & entryTable)
+  {
+    this->m_EntryTable = entryTable;
+    this->Modified();
+  }
+  itkGetConstReferenceMacro(EntryTable, AnalyzeObjectEntryTable);
+
+  /** The intensities shown black and white.  When the minimum is not below the maximum, the
+   * default, the window is the range of the intensities of the requested region; slice views should
+   * set it so that every slice is shown alike. */
+  itkSetMacro(IntensityMinimum, double);
+  itkGetConstMacro(IntensityMinimum, double);
+  itkSetMacro(IntensityMaximum, double);
+  itkGetConstMacro(IntensityMaximum, double);
+
+  /** Whether the background label 0 is painted with its entry.  Default is off. */
+  itkSetMacro(PaintBackground, bool);
+  itkGetConstMacro(PaintBackground, bool);
+  itkBooleanMacro(PaintBackground);
+
+protected:
+  AnalyzeObjectMapOverlayImageFilter();
+  ~AnalyzeObjectMapOverlayImageFilter() override = default;
+
+  void
+  BeforeThreadedGenerateData() override;
+
+  void
+  DynamicThreadedGenerateData(const OutputImageRegionType & outputRegionForThread) override;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  /** Computes the colours of the labels from records, for every gray level. */
+  void
+  ComputeShadeRamps(const AnalyzeObjectEntryTable::RecordContainerType & records);
+
+  AnalyzeObjectEntryTable m_EntryTable;
+  double                  m_IntensityMinimum{ 0.0 };
+  double                  m_IntensityMaximum{ 0.0 };
+  bool                    m_PaintBackground{ false };
+
+  /** The window used by the current update. */
+  double m_WindowMinimum{ 0.0 };
+  double m_WindowScale{ 0.0 };
+
+  /** The red, green and blue of every label and gray level, premultiplied by the alpha of the label
+   * out of 256, and 256 minus that alpha.  Labels are clamped to NumberOfLabels, whose slot is
+   * never painted. */
+  std::vector<unsigned short>                    m_ShadeRamps;
+  std::array<unsigned short, NumberOfLabels + 1> m_InverseAlpha;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkAnalyzeObjectMapOverlayImageFilter.hxx"
+#endif
+
+#endif // itkAnalyzeObjectMapOverlayImageFilter_h
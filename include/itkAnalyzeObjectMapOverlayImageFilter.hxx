@@ -0,0 +1,199 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkAnalyzeObjectMapOverlayImageFilter_hxx
+#define itkAnalyzeObjectMapOverlayImageFilter_hxx
+
+#include "itkAnalyzeObjectMapOverlayImageFilter.h"
+#include "itkAnalyzeObjectEntry.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkMetaDataObject.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace itk
+{
+
+template <typename TIntensityImage, typename TLabelImage, typename TOutputImage>
+AnalyzeObjectMapOverlayImageFilter<TIntensityImage, TLabelImage, TOutputImage>::AnalyzeObjectMapOverlayImageFilter()
+{
+  this->SetNumberOfRequiredInputs(2);
+  this->m_InverseAlpha.fill(256);
+}
+
+template <typename TIntensityImage, typename TLabelImage, typename TOutputImage>
+void
+AnalyzeObjectMapOverlayImageFilter<TIntensityImage, TLabelImage, TOutputImage>::BeforeThreadedGenerateData()
+{
+  const IntensityImageType *    intensityImage = this->GetInput();
+  const OutputImageRegionType & region = this->GetOutput()->GetRequestedRegion();
+
+  double minimum = this->m_IntensityMinimum;
+  double maximum = this->m_IntensityMaximum;
+  if (!(minimum < maximum))
+  {
+    minimum = std::numeric_limits<double>::max();
+    maximum = std::numeric_limits<double>::lowest();
+    for (ImageRegionConstIterator<IntensityImageType> it(intensityImage, region); !it.IsAtEnd(); ++it)
+    {
+      const auto value = static_cast<double>(it.Get());
+      minimum = std::min(minimum, value);
+      maximum = std::max(maximum, value);
+    }
+  }
+  this->m_WindowMinimum = minimum;
+  this->m_WindowScale = minimum < maximum ? (NumberOfLevels - 1) / (maximum - minimum) : 0.0;
+
+  if (this->m_EntryTable.GetNumberOfEntries() > 0)
+  {
+    this->ComputeShadeRamps(this->m_EntryTable.GetRecords());
+    return;
+  }
+  const MetaDataDictionary &                   dictionary = this->GetLabelImage()->GetMetaDataDictionary();
+  AnalyzeObjectEntryTable                      table;
+  AnalyzeObjectEntryArrayType                  entries;
+  AnalyzeObjectEntryTable::RecordContainerType records;
+  if (ExposeMetaData<AnalyzeObjectEntryTable>(dictionary, ANALYZE_OBJECT_LABEL_MAP_ENTRY_TABLE, table))
+  {
+    records = table.GetRecords();
+  }
+  else if (ExposeMetaData<AnalyzeObjectEntryArrayType>(dictionary, ANALYZE_OBJECT_LABEL_MAP_ENTRY_ARRAY, entries))
+  {
+    records.resize(entries.size());
+    for (SizeValueType i = 0; i < entries.size(); i++)
+    {
+      entries[i]->CopyToRecord(records[i]);
+    }
+  }
+  this->ComputeShadeRamps(records);
+}
+
+template <typename TIntensityImage, typename TLabelImage, typename TOutputImage>
+void
+AnalyzeObjectMapOverlayImageFilter<TIntensityImage, TLabelImage, TOutputImage>::ComputeShadeRamps(
+  const AnalyzeObjectEntryTable::RecordContainerType & records)
+{
+  const auto clamp = [](double value, double low, double high) { return std::min(std::max(value, low), high); };
+
+  // The slot of labels without an entry, and of labels too large to have one, stays transparent.
+  this->m_ShadeRamps.assign((NumberOfLabels + 1) * NumberOfLevels * 3, 0);
+  this->m_InverseAlpha.fill(256);
+  const SizeValueType numberOfEntries = std::min<SizeValueType>(records.size(), NumberOfLabels);
+  for (SizeValueType label = this->m_PaintBackground ? 0 : 1; label < numberOfEntries; label++)
+  {
+    const AnalyzeObjectEntryRecord & record = records[label];
+    const auto alpha =
+      record.DisplayFlag != 0 ? static_cast<unsigned int>(std::lround(clamp(record.Opacity, 0.0, 1.0) * 256)) : 0u;
+    this->m_InverseAlpha[label] = static_cast<unsigned short>(256 - alpha);
+    if (alpha == 0)
+    {
+      continue;
+    }
+    const double     start[3] = { clamp(record.StartRed, 0, 255),
+                                  clamp(record.StartGreen, 0, 255),
+                                  clamp(record.StartBlue, 0, 255) };
+    const double     end[3] = { clamp(record.EndRed, 0, 255),
+                                clamp(record.EndGreen, 0, 255),
+                                clamp(record.EndBlue, 0, 255) };
+    const double     blendFactor = clamp(record.BlendFactor, 0.0, 1.0);
+    const int        shades = std::min(std::max(record.Shades, 1), static_cast<int>(NumberOfLevels));
+    unsigned short * ramp = &this->m_ShadeRamps[label * NumberOfLevels * 3];
+    for (unsigned int level = 0; level < NumberOfLevels; level++, ramp += 3)
+    {
+      // The shade of the level, from 0 for the Start colour to 1 for the End colour.
+      const double shade =
+        shades > 1 ? static_cast<double>(std::min<int>(level * shades / NumberOfLevels, shades - 1)) / (shades - 1)
+                   : 1.0;
+      const double brightness = 1.0 - blendFactor + blendFactor * level / (NumberOfLevels - 1);
+      for (unsigned int c = 0; c < 3; c++)
+      {
+        const double colour = (start[c] + (end[c] - start[c]) * shade) * brightness;
+        ramp[c] = static_cast<unsigned short>(std::lround(colour * alpha));
+      }
+    }
+  }
+}
+
+template <typename TIntensityImage, typename TLabelImage, typename TOutputImage>
+void
+AnalyzeObjectMapOverlayImageFilter<TIntensityImage, TLabelImage, TOutputImage>::DynamicThreadedGenerateData(
+  const OutputImageRegionType & outputRegionForThread)
+{
+  const IntensityImageType * intensityImage = this->GetInput();
+  const LabelImageType *     labelImage = this->GetLabelImage();
+  OutputImageType *          outputImage = this->GetOutput();
+
+  const SizeValueType    rowLength = outputRegionForThread.GetSize(0);
+  const SizeValueType    numberOfRows = rowLength > 0 ? outputRegionForThread.GetNumberOfPixels() / rowLength : 0;
+  const double           windowMinimum = this->m_WindowMinimum;
+  const double           windowScale = this->m_WindowScale;
+  const unsigned short * shadeRamps = this->m_ShadeRamps.data();
+  const unsigned short * inverseAlpha = this->m_InverseAlpha.data();
+
+  typename OutputImageType::IndexType index = outputRegionForThread.GetIndex();
+  for (SizeValueType row = 0; row < numberOfRows; row++)
+  {
+    const IntensityPixelType * intensities =
+      intensityImage->GetBufferPointer() + intensityImage->ComputeOffset(index);
+    const LabelPixelType * labels = labelImage->GetBufferPointer() + labelImage->ComputeOffset(index);
+    OutputPixelType *      output = outputImage->GetBufferPointer() + outputImage->ComputeOffset(index);
+    for (SizeValueType x = 0; x < rowLength; x++)
+    {
+      // A NaN, which the clamp would let through to the cast, is shown as the bottom of the window.
+      const double windowed = (static_cast<double>(intensities[x]) - windowMinimum) * windowScale;
+      const auto   level = static_cast<unsigned int>(
+        std::isnan(windowed) ? 0.0 : std::min(std::max(windowed, 0.0), NumberOfLevels - 1.0) + 0.5);
+      const auto   label = static_cast<unsigned int>(
+        std::min<SizeValueType>(static_cast<SizeValueType>(labels[x]), static_cast<SizeValueType>(NumberOfLabels)));
+      const unsigned short * ramp = shadeRamps + (label * NumberOfLevels + level) * 3;
+      const unsigned int     gray = level * inverseAlpha[label];
+      output[x][0] = static_cast<unsigned char>((gray + ramp[0]) >> 8);
+      output[x][1] = static_cast<unsigned char>((gray + ramp[1]) >> 8);
+      output[x][2] = static_cast<unsigned char>((gray + ramp[2]) >> 8);
+    }
+
+    // Steps the index to the start of the next row.
+    for (unsigned int d = 1; d < OutputImageType::ImageDimension; d++)
+    {
+      const IndexValueType end =
+        outputRegionForThread.GetIndex(d) + static_cast<IndexValueType>(outputRegionForThread.GetSize(d));
+      if (++index[d] < end)
+      {
+        break;
+      }
+      index[d] = outputRegionForThread.GetIndex(d);
+    }
+  }
+}
+
+template <typename TIntensityImage, typename TLabelImage, typename TOutputImage>
+void
+AnalyzeObjectMapOverlayImageFilter<TIntensityImage, TLabelImage, TOutputImage>::PrintSelf(std::ostream & os,
+                                                                                          Indent         indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfEntries: " << this->m_EntryTable.GetNumberOfEntries() << std::endl;
+  os << indent << "IntensityMinimum: " << this->m_IntensityMinimum << std::endl;
+  os << indent << "IntensityMaximum: " << this->m_IntensityMaximum << std::endl;
+  os << indent << "PaintBackground: " << (this->m_PaintBackground ? "On" : "Off") << std::endl;
+}
+
+} // end namespace itk
+
+#endif
@@ -0,0 +1,154 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkAnalyzeObjectMapPyramid_h
+#define itkAnalyzeObjectMapPyramid_h
+
+#include "itkAnalyzeObjectEntryRecord.h"
+#include "itkImage.h"
+#include "AnalyzeObjectLabelMapExport.h"
+
+#include <string>
+#include <vector>
+
+namespace itk
+{
+/** \class AnalyzeObjectMapPyramid
+ *  \ingroup AnalyzeObjectLabelMap
+ *  \ingroup AnalyzeObjectMapIO
+ *  \brief Downsampled previews of an object map, computed while its runs are decoded.
+ *
+ * Level i of the pyramid has a factor of 2^(i+1): every voxel of it summarizes a block of
+ * factor x factor x factor voxels of the map, either by the most frequent label of the block
+ * (Mode, ties going to the smaller label) or by its largest label (Maximum).  Blocks at the edges
+ * of the map are cut to the voxels it has; time frames are not downsampled.
+ *
+ * The runs are read a block at a time and expanded, one plane after the other, into a ring of as
+ * many planes as the largest factor.  Every level is computed from that ring as soon as its last
+ * plane has been decoded, so the memory needed does not depend on the number of planes of the map.
+ * The levels are unsigned char images with the spacing of the factor, centred on their blocks.
+ *
+ * With WriteLevelFiles on, GenerateFromFile() also writes every level next to the map, as an
+ * object map with the same entries named as GetLevelFileName() gives (foo_2x.obj, foo_4x.obj,
+ * ...), which viewers can open instead of reading and resampling the whole map.
+ */
+class AnalyzeObjectLabelMap_EXPORT AnalyzeObjectMapPyramid
+{
+public:
+  using ImageType = Image<unsigned char, 4>;
+
+  /** Largest number of levels, whose last level has a factor of 128. */
+  static constexpr unsigned int MaximumNumberOfLevels = 7;
+
+  /** How the labels of a block are reduced to the voxel of a level. */
+  enum class ReductionEnum
+  {
+    Mode,
+    Maximum
+  };
+
+  /** How the labels of a block are reduced.  Default is Mode. */
+  void
+  SetReduction(ReductionEnum reduction)
+  {
+    this->m_Reduction = reduction;
+  }
+  ReductionEnum
+  GetReduction() const
+  {
+    return this->m_Reduction;
+  }
+
+  /** Number of levels generated, from 1 to MaximumNumberOfLevels.  Default is 3, the levels
+   * downsampled by 2, 4 and 8. */
+  void
+  SetNumberOfLevels(unsigned int numberOfLevels);
+  unsigned int
+  GetNumberOfLevels() const
+  {
+    return this->m_NumberOfLevels;
+  }
+
+  /** Whether GenerateFromFile() writes the levels next to the map.  Default is off. */
+  void
+  SetWriteLevelFiles(bool writeLevelFiles)
+  {
+    this->m_WriteLevelFiles = writeLevelFiles;
+  }
+  bool
+  GetWriteLevelFiles() const
+  {
+    return this->m_WriteLevelFiles;
+  }
+
+  /** The smallest number of levels whose last level has no more than maximumSize voxels along
+   * x, y and z, for example 64 for a preview of at most 64^3 voxels. */
+  static unsigned int
+  GetNumberOfLevelsForSize(const int dimensions[4], SizeValueType maximumSize);
+
+  /** The name of the file a level of factor is written to: foo_2x.obj for foo.obj. */
+  static std::string
+  GetLevelFileName(const std::string & fileName, unsigned int factor);
+
+  /**
+   * \brief Generate
+   *
+   * Computes the levels of a whole object map file held in memory.  Throws if the bytes do not
+   * hold a valid object map.
+   */
+  void
+  Generate(const unsigned char * input, SizeValueType numberOfInputBytes);
+
+  /** Computes the levels of the object map of a file, and writes them if WriteLevelFiles is on. */
+  void
+  GenerateFromFile(const std::string & fileName);
+
+  /** The level i, downsampled by 2^(i+1), of the last map. */
+  ImageType *
+  GetLevel(unsigned int level) const
+  {
+    return this->m_Levels[level].GetPointer();
+  }
+
+  /** Number of levels of the last map. */
+  unsigned int
+  GetNumberOfGeneratedLevels() const
+  {
+    return static_cast<unsigned int>(this->m_Levels.size());
+  }
+
+  /** The header and entries of the last map. */
+  const AnalyzeObjectMapHeaderRecord &
+  GetHeader() const
+  {
+    return this->m_Header;
+  }
+
+private:
+  /** Allocates the levels for the dimensions of m_Header. */
+  void
+  AllocateLevels();
+
+  ReductionEnum                   m_Reduction{ ReductionEnum::Mode };
+  unsigned int                    m_NumberOfLevels{ 3 };
+  bool                            m_WriteLevelFiles{ false };
+  AnalyzeObjectMapHeaderRecord    m_Header;
+  std::vector<ImageType::Pointer> m_Levels;
+};
+} // end namespace itk
+
+#endif // itkAnalyzeObjectMapPyramid_h
@@ -0,0 +1,117 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkAnalyzeObjectMapRepacker_h
+#define itkAnalyzeObjectMapRepacker_h
+
+#include "itkAnalyzeObjectEntryRecord.h"
+#include "AnalyzeObjectLabelMapExport.h"
+
+#include <string>
+#include <vector>
+
+namespace itk
+{
+/** \class AnalyzeObjectMapRepacker
+ *  \ingroup AnalyzeObjectLabelMap
+ *  \ingroup AnalyzeObjectMapIO
+ *  \brief Rewrites an object map in the smallest encoding, without decoding its voxels.
+ *
+ * Other tools may write adjacent runs of the same label, runs shorter than 255 voxels followed by
+ * a run of the same label, or runs that cross the boundary between two planes, and files written
+ * from images without entries hold 256 blank entries.  The repacker reads the runs of a map, joins
+ * those of the same label and splits them only at 255 voxels and at plane boundaries, which is the
+ * encoding AnalyzeObjectLabelMapImageIO writes.  The runs are read twice, a block at a time: once to
+ * find the labels used, and once to re-encode them, so a file is never held in memory as a whole.
+ *
+ * With TrimEntries on, the default, the entries after the largest label used are removed.  With
+ * RenumberLabels on as well, the entries of unused labels are removed too, and the labels used are
+ * renumbered in order; the background label 0 is always kept.  The map is written as VERSION7, big
+ * endian, as the writer does.
+ */
+class AnalyzeObjectLabelMap_EXPORT AnalyzeObjectMapRepacker
+{
+public:
+  using BufferType = std::vector<unsigned char>;
+
+  /** Whether the entries of labels that are not used are removed.  Default is on. */
+  void
+  SetTrimEntries(bool trimEntries)
+  {
+    this->m_TrimEntries = trimEntries;
+  }
+  bool
+  GetTrimEntries() const
+  {
+    return this->m_TrimEntries;
+  }
+
+  /** Whether the labels used are renumbered so that no entry is unused.  Default is off, which
+   * only removes the unused entries after the largest label used. */
+  void
+  SetRenumberLabels(bool renumberLabels)
+  {
+    this->m_RenumberLabels = renumberLabels;
+  }
+  bool
+  GetRenumberLabels() const
+  {
+    return this->m_RenumberLabels;
+  }
+
+  /**
+   * \brief Repack
+   *
+   * Repacks a whole object map file held in memory into output, which receives a whole object
+   * map file.  Throws if the bytes do not hold a valid object map.
+   */
+  void
+  Repack(const unsigned char * input, SizeValueType numberOfInputBytes, BufferType & output);
+
+  /** Repacks the object map of a file into another file, or into the same file.  The output is
+   * written by AnalyzeObjectMapAtomicWriter to a temporary file next to it, which then replaces it. */
+  void
+  RepackFile(const std::string & inputFileName, const std::string & outputFileName);
+
+  /** Size in bytes of the runs of the last map read, and of the runs written for it. */
+  SizeValueType
+  GetNumberOfInputRunBytes() const
+  {
+    return this->m_NumberOfInputRunBytes;
+  }
+  SizeValueType
+  GetNumberOfOutputRunBytes() const
+  {
+    return this->m_NumberOfOutputRunBytes;
+  }
+
+private:
+  /** Fills the entries of output and the label of every label of the input from the labels used. */
+  void
+  TrimEntries(const AnalyzeObjectMapHeaderRecord & input,
+              const bool                           used[256],
+              AnalyzeObjectMapHeaderRecord &       output,
+              unsigned char                        labels[256]) const;
+
+  bool          m_TrimEntries{ true };
+  bool          m_RenumberLabels{ false };
+  SizeValueType m_NumberOfInputRunBytes{ 0 };
+  SizeValueType m_NumberOfOutputRunBytes{ 0 };
+};
+} // end namespace itk
+
+#endif // itkAnalyzeObjectMapRepacker_h
@@ -0,0 +1,106 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkAnalyzeObjectMapSplicer_h
+#define itkAnalyzeObjectMapSplicer_h
+
+#include "itkAnalyzeObjectEntryRecord.h"
+#include "AnalyzeObjectLabelMapExport.h"
+
+#include <string>
+
+namespace itk
+{
+/** \class AnalyzeObjectMapSplicer
+ *  \ingroup AnalyzeObjectLabelMap
+ *  \ingroup AnalyzeObjectMapIO
+ *  \brief Replaces or appends planes and frames of an object map file without rewriting the rest.
+ *
+ * Every plane of an object map starts on a run boundary, so the planes of a file can be replaced
+ * by splicing new runs between the runs of the planes before and after them.  The plane index of
+ * the file, loaded from its sidecar or built, gives where they start and end.  Only the new planes
+ * are encoded; the runs of the other planes are copied as they are, a block at a time.  Appending
+ * frames also updates the number of frames in the header, which turns a file of an older version
+ * into a VERSION7 one.  The header keeps its byte order.
+ *
+ * The spliced map is written by AnalyzeObjectMapAtomicWriter to a temporary file next to the map,
+ * which then replaces it, so that a crash leaves either the old or the new map.  The sidecar plane
+ * index and the cached map of the file are removed, as when it is written by
+ * AnalyzeObjectLabelMapImageIO.
+ *
+ * \code
+ *   itk::AnalyzeObjectMapSplicer splicer;
+ *   splicer.ReplacePlanes("segmentation.obj", z, slice, 1);  // slice holds a plane of labels
+ * \endcode
+ */
+class AnalyzeObjectLabelMap_EXPORT AnalyzeObjectMapSplicer
+{
+public:
+  /**
+   * \brief ReplacePlanes
+   *
+   * Replaces numberOfPlanes planes (z + t * zDimension) of fileName, from firstPlane, with the
+   * labels of voxels, which holds numberOfPlanes planes.  Throws if the planes are not all in the
+   * file, or the file is not an object map whose planes can be indexed.
+   */
+  void
+  ReplacePlanes(const std::string &   fileName,
+                SizeValueType         firstPlane,
+                const unsigned char * voxels,
+                SizeValueType         numberOfPlanes);
+
+  /** Replaces numberOfFrames frames of fileName, from firstFrame, with the labels of voxels.
+   * Frames after the last frame of the file are appended; firstFrame can be at most the number of
+   * frames of the file. */
+  void
+  ReplaceFrames(const std::string &   fileName,
+                SizeValueType         firstFrame,
+                const unsigned char * voxels,
+                SizeValueType         numberOfFrames);
+
+  /** Appends numberOfFrames frames, whose labels voxels holds, to fileName. */
+  void
+  AppendFrames(const std::string & fileName, const unsigned char * voxels, SizeValueType numberOfFrames);
+
+  /** Number of bytes of runs encoded, and of bytes copied from the file, by the last splice. */
+  SizeValueType
+  GetNumberOfEncodedBytes() const
+  {
+    return this->m_NumberOfEncodedBytes;
+  }
+  SizeValueType
+  GetNumberOfCopiedBytes() const
+  {
+    return this->m_NumberOfCopiedBytes;
+  }
+
+private:
+  /** Replaces numberOfPlanes planes of fileName from firstPlane, which is at most the number of
+   * planes of the file, and sets the number of frames of the result to numberOfFrames. */
+  void
+  Splice(const std::string &   fileName,
+         SizeValueType         firstPlane,
+         const unsigned char * voxels,
+         SizeValueType         numberOfPlanes,
+         SizeValueType         numberOfFrames);
+
+  SizeValueType m_NumberOfEncodedBytes{ 0 };
+  SizeValueType m_NumberOfCopiedBytes{ 0 };
+};
+} // end namespace itk
+
+#endif // itkAnalyzeObjectMapSplicer_h
@@ -0,0 +1,151 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkAnalyzeObjectPlaneIndex_h
+#define itkAnalyzeObjectPlaneIndex_h
+
+#include "itkIntTypes.h"
+#include "AnalyzeObjectLabelMapExport.h"
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace itk
+{
+/** \class AnalyzeObjectPlaneIndex
+ *  \ingroup AnalyzeObjectLabelMap
+ *  \ingroup AnalyzeObjectMapIO
+ *  \brief The byte offset of every plane in the run length encoded data of an object map.
+ *
+ * The voxel data of an object map is run length encoded a plane at a time, so every plane starts
+ * on a run boundary.  Scanning the runs once and recording where each plane starts lets a reader
+ * seek directly to the planes it needs.  Planes are numbered z + t * zDimension.
+ *
+ * The index also records which labels occur in every plane, so that planes without a given label
+ * can be skipped, and planes holding a single label can be filled without reading them.  It can
+ * be saved to, and loaded from, a small sidecar file next to the object map (foo.obj.idx).  The
+ * sidecar stores the length and modification time of the object map it was built from and a
+ * checksum of its own content; Load() rejects a sidecar when any of these do not match.
+ */
+class AnalyzeObjectLabelMap_EXPORT AnalyzeObjectPlaneIndex
+{
+public:
+  using OffsetType = std::streamoff;
+
+  /** Extension appended to the name of an object map to form the name of its sidecar index. */
+  static constexpr const char * SidecarExtension = ".idx";
+
+  /**
+   * \brief Build
+   *
+   * Scans the run stream that starts at dataOffset in inputStream.  Returns false, leaving the
+   * index empty, if the stream is truncated, holds a zero length run, or holds a run that
+   * crosses the boundary between two planes.
+   */
+  bool
+  Build(std::istream & inputStream, OffsetType dataOffset, SizeValueType planeSize, SizeValueType numberOfPlanes);
+
+  /**
+   * \brief Save
+   *
+   * Writes the index to fileName, through a temporary file that is renamed over it.  fileLength and
+   * modifiedTime describe the object map the index was built from.  Returns false if the index is
+   * empty or the file cannot be written.
+   */
+  bool
+  Save(const std::string & fileName, SizeValueType fileLength, long modifiedTime) const;
+
+  /**
+   * \brief Load
+   *
+   * Reads an index saved by Save().  Returns false, leaving the index empty, if the file cannot be
+   * read, is corrupt, or was saved for an object map with a different length, modification time,
+   * data offset or geometry than the one given.
+   */
+  bool
+  Load(const std::string & fileName,
+       SizeValueType       fileLength,
+       long                modifiedTime,
+       OffsetType          dataOffset,
+       SizeValueType       planeSize,
+       SizeValueType       numberOfPlanes);
+
+  /** Empties the index. */
+  void
+  Clear()
+  {
+    this->m_PlaneOffsets.clear();
+    this->m_PlaneLabels.clear();
+  }
+
+  /** True if the index holds no planes. */
+  bool
+  IsEmpty() const
+  {
+    return this->m_PlaneOffsets.size() < 2;
+  }
+
+  /** Number of planes in the index. */
+  SizeValueType
+  GetNumberOfPlanes() const
+  {
+    return this->IsEmpty() ? 0 : this->m_PlaneOffsets.size() - 1;
+  }
+
+  /** Byte offset, from the start of the file, of the first run of plane. */
+  OffsetType
+  GetPlaneOffset(SizeValueType plane) const
+  {
+    return this->m_PlaneOffsets[plane];
+  }
+
+  /** Number of bytes of runs that encode plane. */
+  OffsetType
+  GetPlaneLength(SizeValueType plane) const
+  {
+    return this->m_PlaneOffsets[plane + 1] - this->m_PlaneOffsets[plane];
+  }
+
+  /** True if label occurs in plane. */
+  bool
+  PlaneContainsLabel(SizeValueType plane, unsigned char label) const
+  {
+    return (this->m_PlaneLabels[plane * WordsPerPlane + label / 64] >> (label % 64)) & 1;
+  }
+
+  /** Returns true, and sets label, if plane holds a single label. */
+  bool
+  GetPlaneUniformLabel(SizeValueType plane, unsigned char & label) const;
+
+private:
+  /** Number of 64 bit words in the label set of a plane. */
+  static constexpr unsigned int WordsPerPlane = 4;
+
+  /** Start of every plane, followed by the end of the last plane. */
+  std::vector<OffsetType> m_PlaneOffsets;
+
+  /** A 256 bit set of the labels present in every plane. */
+  std::vector<std::uint64_t> m_PlaneLabels;
+
+  /** Number of voxels in a plane. */
+  SizeValueType m_PlaneSize{ 0 };
+};
+} // end namespace itk
+
+#endif // itkAnalyzeObjectPlaneIndex_h
@@ -0,0 +1,192 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkAnalyzeObjectRunLengthCodec_h
+#define itkAnalyzeObjectRunLengthCodec_h
+
+#include "itkIntTypes.h"
+
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace itk
+{
+/**
+ * Buffer size for reading in the run length encoded object data, in (voxel_count, voxel_value) pairs
+ */
+constexpr int NumberOfRunLengthElementsPerRead = 32768;
+
+/** \class AnalyzeObjectRunLengthCodec
+ *  \ingroup AnalyzeObjectLabelMap
+ *  \ingroup AnalyzeObjectMapIO
+ *  \brief Encoding kernels for the run length encoded voxel data of an Analyze object map.
+ *
+ * The voxel data of an object map is a sequence of (voxel_count, voxel_value) unsigned char
+ * pairs.  Runs never span more than 255 voxels and never cross the boundary between two planes.
+ * The kernels in this class are templated over the pixel type of the image buffer so that
+ * label images of any integer type can be encoded without first casting them to unsigned char,
+ * and so that object maps can be expanded directly into wider pixel types.
+ */
+class AnalyzeObjectRunLengthCodec
+{
+public:
+  /** The encoded run stream. */
+  using BufferType = std::vector<unsigned char>;
+
+  /** Table mapping compacted labels (the table index) to the original label values.  Unsigned values
+   * above the largest long long cannot be held by the table. */
+  using LabelCompactionTableType = std::vector<long long>;
+
+  /** Largest number of voxels a single run may describe. */
+  static constexpr unsigned int MaximumRunLength = 255;
+
+  /** Largest number of distinct labels an object map can hold. */
+  static constexpr unsigned int MaximumNumberOfLabels = 256;
+
+  /**
+   * \brief EncodeVolume
+   *
+   * Appends the run stream of numberOfVoxels voxels to output, restarting runs every planeSize voxels.
+   * Values are narrowed to unsigned char while encoding.  If a value outside [0,255] is found the
+   * function stops and returns false; the content of output is then unspecified.
+   */
+  template <typename TPixel>
+  static bool
+  EncodeVolume(const TPixel * input, SizeValueType numberOfVoxels, SizeValueType planeSize, BufferType & output);
+
+  /**
+   * \brief EncodeVolume
+   *
+   * Same as above, but every value is replaced by its index in table.  Returns false if a value is
+   * not present in the table.
+   */
+  template <typename TPixel>
+  static bool
+  EncodeVolume(const TPixel *                   input,
+               SizeValueType                    numberOfVoxels,
+               SizeValueType                    planeSize,
+               const LabelCompactionTableType & table,
+               BufferType &                     output);
+
+  /**
+   * \brief CountRunBytes
+   *
+   * Returns the number of bytes EncodeVolume() appends for numberOfVoxels voxels, with runs
+   * restarting every planeSize voxels, without encoding them.  The runs only depend on where the
+   * values change, so this is also the size of the runs encoded through a label compaction table.
+   * inRange is set to false if a value lies outside [0,255], and left alone otherwise.
+   */
+  template <typename TPixel>
+  static SizeValueType
+  CountRunBytes(const TPixel * input, SizeValueType numberOfVoxels, SizeValueType planeSize, bool & inRange);
+
+  /**
+   * \brief BuildLabelCompactionTable
+   *
+   * Collects the distinct values of the input into table.  The values are sorted, except that 0 (the
+   * background) is always moved to the front when it is present.  Returns false if more than
+   * MaximumNumberOfLabels distinct values are used, or if an unsigned value does not fit into a long long.
+   */
+  template <typename TPixel>
+  static bool
+  BuildLabelCompactionTable(const TPixel * input, SizeValueType numberOfVoxels, LabelCompactionTableType & table);
+
+  /**
+   * \brief DecodeRuns
+   *
+   * Expands the runs held in numberOfRunBytes bytes into output, starting at output[index] and
+   * advancing index.  A trailing odd byte is ignored.  Returns false if a run has a zero length
+   * or if the runs would write beyond numberOfVoxels; no voxel past the end is ever written.
+   */
+  template <typename TPixel>
+  static bool
+  DecodeRuns(const unsigned char * runs,
+             SizeValueType         numberOfRunBytes,
+             TPixel *              output,
+             SizeValueType         numberOfVoxels,
+             SizeValueType &       index);
+
+  /**
+   * \brief DecodePlaneRegion
+   *
+   * Expands the columns [regionStart[0], regionStart[0] + regionSize[0]) of the rows
+   * [regionStart[1], regionStart[1] + regionSize[1]) of a single plane into output, which holds
+   * regionSize[0] * regionSize[1] voxels.  The plane has rows of rowLength voxels and planeSize
+   * voxels in total.  Runs before and after the requested voxels are consumed arithmetically
+   * without being written, and decoding stops after the last requested row.  Returns false if a
+   * run has a zero length, crosses the end of the plane, or the runs end too early.
+   */
+  template <typename TPixel>
+  static bool
+  DecodePlaneRegion(const unsigned char * runs,
+                    SizeValueType         numberOfRunBytes,
+                    SizeValueType         rowLength,
+                    SizeValueType         planeSize,
+                    const SizeValueType   regionStart[2],
+                    const SizeValueType   regionSize[2],
+                    TPixel *              output);
+
+  /**
+   * \brief ZipRuns
+   *
+   * Walks the run streams of two object maps of numberOfPlanes planes of planeSize voxels side by
+   * side, without expanding them.  visitor(plane, voxel, length, firstValue, secondValue) is called
+   * for every stretch of length voxels, starting at voxel of plane, over which neither stream
+   * changes value, in the order of the voxels.  Returns false if either stream ends early, holds a
+   * zero length run, or holds a run that crosses the boundary between two planes.
+   */
+  template <typename TVisitor>
+  static bool
+  ZipRuns(const unsigned char * first,
+          SizeValueType         numberOfFirstBytes,
+          const unsigned char * second,
+          SizeValueType         numberOfSecondBytes,
+          SizeValueType         planeSize,
+          SizeValueType         numberOfPlanes,
+          TVisitor &&           visitor);
+
+private:
+  template <typename TPixel, typename TLabelMapper>
+  static bool
+  EncodePlanes(const TPixel *  input,
+               SizeValueType   numberOfVoxels,
+               SizeValueType   planeSize,
+               TLabelMapper && mapper,
+               BufferType &    output);
+
+  /** Converts value to a long long.  Returns false, for an unsigned value above the largest long long,
+   * instead of wrapping it around to a negative value. */
+  template <typename TPixel>
+  static bool
+  WidenLabel(const TPixel value, long long & wideValue);
+
+  template <typename TPixel>
+  static bool
+  WidenLabel(const TPixel value, long long & wideValue, std::true_type isUnsigned);
+
+  template <typename TPixel>
+  static bool
+  WidenLabel(const TPixel value, long long & wideValue, std::false_type isUnsigned);
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkAnalyzeObjectRunLengthCodec.hxx"
+#endif
+
+#endif // itkAnalyzeObjectRunLengthCodec_h
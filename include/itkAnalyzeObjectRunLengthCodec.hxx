@@ -0,0 +1,340 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkAnalyzeObjectRunLengthCodec_hxx
+#define itkAnalyzeObjectRunLengthCodec_hxx
+
+#include "itkAnalyzeObjectRunLengthCodec.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace itk
+{
+
+template <typename TPixel, typename TLabelMapper>
+bool
+AnalyzeObjectRunLengthCodec::EncodePlanes(const TPixel *  input,
+                                          SizeValueType   numberOfVoxels,
+                                          SizeValueType   planeSize,
+                                          TLabelMapper && mapper,
+                                          BufferType &    output)
+{
+  if (planeSize == 0)
+  {
+    planeSize = numberOfVoxels;
+  }
+  for (SizeValueType planeStart = 0; planeStart < numberOfVoxels; planeStart += planeSize)
+  {
+    const TPixel *       current = input + planeStart;
+    const TPixel * const planeEnd = current + std::min(planeSize, numberOfVoxels - planeStart);
+    while (current != planeEnd)
+    {
+      // The label is only looked up once per run, not once per voxel.
+      const TPixel  value = *current;
+      unsigned char label = 0;
+      if (!mapper(value, label))
+      {
+        return false;
+      }
+      const TPixel * runEnd = std::find_if(current + 1, planeEnd, [value](const TPixel v) { return v != value; });
+      SizeValueType  runLength = runEnd - current;
+      for (; runLength > MaximumRunLength; runLength -= MaximumRunLength)
+      {
+        output.push_back(static_cast<unsigned char>(MaximumRunLength));
+        output.push_back(label);
+      }
+      output.push_back(static_cast<unsigned char>(runLength));
+      output.push_back(label);
+      current = runEnd;
+    }
+  }
+  return true;
+}
+
+template <typename TPixel>
+bool
+AnalyzeObjectRunLengthCodec::EncodeVolume(const TPixel * input,
+                                          SizeValueType  numberOfVoxels,
+                                          SizeValueType  planeSize,
+                                          BufferType &   output)
+{
+  // Range validation is folded into the encoding pass.
+  return EncodePlanes(input, numberOfVoxels, planeSize, [](const TPixel value, unsigned char & label) {
+    long long wideValue = 0;
+    if (!WidenLabel(value, wideValue) || wideValue < 0 || wideValue > 255)
+    {
+      return false;
+    }
+    label = static_cast<unsigned char>(wideValue);
+    return true;
+  }, output);
+}
+
+template <typename TPixel>
+bool
+AnalyzeObjectRunLengthCodec::EncodeVolume(const TPixel *                   input,
+                                          SizeValueType                    numberOfVoxels,
+                                          SizeValueType                    planeSize,
+                                          const LabelCompactionTableType & table,
+                                          BufferType &                     output)
+{
+  // Sorted (value, compacted label) pairs so that each run costs one binary search.
+  std::vector<std::pair<long long, unsigned char>> lookup;
+  lookup.reserve(table.size());
+  for (unsigned int i = 0; i < table.size() && i < MaximumNumberOfLabels; ++i)
+  {
+    lookup.emplace_back(table[i], static_cast<unsigned char>(i));
+  }
+  std::sort(lookup.begin(), lookup.end());
+
+  return EncodePlanes(input, numberOfVoxels, planeSize, [&lookup](const TPixel value, unsigned char & label) {
+    long long wideValue = 0;
+    if (!WidenLabel(value, wideValue))
+    {
+      return false;
+    }
+    const auto it = std::lower_bound(
+      lookup.begin(), lookup.end(), wideValue, [](const std::pair<long long, unsigned char> & entry, long long v) {
+        return entry.first < v;
+      });
+    if (it == lookup.end() || it->first != wideValue)
+    {
+      return false;
+    }
+    label = it->second;
+    return true;
+  }, output);
+}
+
+template <typename TPixel>
+SizeValueType
+AnalyzeObjectRunLengthCodec::CountRunBytes(const TPixel * input,
+                                           SizeValueType  numberOfVoxels,
+                                           SizeValueType  planeSize,
+                                           bool &         inRange)
+{
+  if (planeSize == 0)
+  {
+    planeSize = numberOfVoxels;
+  }
+  // Runs are found as EncodePlanes() finds them; a run of n voxels takes ceil(n / 255) pairs.
+  SizeValueType numberOfRuns = 0;
+  for (SizeValueType planeStart = 0; planeStart < numberOfVoxels; planeStart += planeSize)
+  {
+    const TPixel *       current = input + planeStart;
+    const TPixel * const planeEnd = current + std::min(planeSize, numberOfVoxels - planeStart);
+    while (current != planeEnd)
+    {
+      const TPixel value = *current;
+      long long    wideValue = 0;
+      inRange = inRange && WidenLabel(value, wideValue) && wideValue >= 0 && wideValue <= 255;
+      const TPixel * runEnd = std::find_if(current + 1, planeEnd, [value](const TPixel v) { return v != value; });
+      numberOfRuns += (static_cast<SizeValueType>(runEnd - current) + MaximumRunLength - 1) / MaximumRunLength;
+      current = runEnd;
+    }
+  }
+  return 2 * numberOfRuns;
+}
+
+template <typename TPixel>
+bool
+AnalyzeObjectRunLengthCodec::BuildLabelCompactionTable(const TPixel *             input,
+                                                       SizeValueType              numberOfVoxels,
+                                                       LabelCompactionTableType & table)
+{
+  table.clear();
+  const TPixel * const end = input + numberOfVoxels;
+  for (const TPixel * current = input; current != end;)
+  {
+    const TPixel value = *current;
+    long long    wideValue = 0;
+    if (!WidenLabel(value, wideValue))
+    {
+      return false;
+    }
+    const auto it = std::lower_bound(table.begin(), table.end(), wideValue);
+    if (it == table.end() || *it != wideValue)
+    {
+      if (table.size() == MaximumNumberOfLabels)
+      {
+        return false;
+      }
+      table.insert(it, wideValue);
+    }
+    // Only the first voxel of every stretch of equal values needs a lookup.
+    current = std::find_if(current + 1, end, [value](const TPixel v) { return v != value; });
+  }
+
+  const auto background = std::lower_bound(table.begin(), table.end(), 0LL);
+  if (background != table.end() && *background == 0)
+  {
+    std::rotate(table.begin(), background, background + 1);
+  }
+  return true;
+}
+
+template <typename TPixel>
+bool
+AnalyzeObjectRunLengthCodec::WidenLabel(const TPixel value, long long & wideValue)
+{
+  return WidenLabel(value, wideValue, std::is_unsigned<TPixel>{});
+}
+
+template <typename TPixel>
+bool
+AnalyzeObjectRunLengthCodec::WidenLabel(const TPixel value, long long & wideValue, std::true_type)
+{
+  if (static_cast<unsigned long long>(value) > static_cast<unsigned long long>(std::numeric_limits<long long>::max()))
+  {
+    return false;
+  }
+  wideValue = static_cast<long long>(value);
+  return true;
+}
+
+template <typename TPixel>
+bool
+AnalyzeObjectRunLengthCodec::WidenLabel(const TPixel value, long long & wideValue, std::false_type)
+{
+  wideValue = static_cast<long long>(value);
+  return true;
+}
+
+template <typename TPixel>
+bool
+AnalyzeObjectRunLengthCodec::DecodeRuns(const unsigned char * runs,
+                                        SizeValueType         numberOfRunBytes,
+                                        TPixel *              output,
+                                        SizeValueType         numberOfVoxels,
+                                        SizeValueType &       index)
+{
+  const unsigned char * const end = runs + (numberOfRunBytes & ~SizeValueType{ 1 });
+  for (const unsigned char * run = runs; run != end; run += 2)
+  {
+    const SizeValueType voxel_count = run[0];
+    if (voxel_count == 0 || voxel_count > numberOfVoxels - index)
+    {
+      return false;
+    }
+    std::fill_n(output + index, voxel_count, static_cast<TPixel>(run[1]));
+    index += voxel_count;
+  }
+  return true;
+}
+
+template <typename TPixel>
+bool
+AnalyzeObjectRunLengthCodec::DecodePlaneRegion(const unsigned char * runs,
+                                               SizeValueType         numberOfRunBytes,
+                                               SizeValueType         rowLength,
+                                               SizeValueType         planeSize,
+                                               const SizeValueType   regionStart[2],
+                                               const SizeValueType   regionSize[2],
+                                               TPixel *              output)
+{
+  const SizeValueType firstVoxel = regionStart[1] * rowLength;
+  const SizeValueType endVoxel = (regionStart[1] + regionSize[1]) * rowLength;
+  const SizeValueType columnEnd = regionStart[0] + regionSize[0];
+
+  const unsigned char * const end = runs + (numberOfRunBytes & ~SizeValueType{ 1 });
+  SizeValueType               position = 0;
+  for (const unsigned char * run = runs; run != end && position < endVoxel; run += 2)
+  {
+    const SizeValueType voxel_count = run[0];
+    if (voxel_count == 0 || voxel_count > planeSize - position)
+    {
+      return false;
+    }
+    const SizeValueType runEnd = position + voxel_count;
+    if (runEnd > firstVoxel)
+    {
+      // Clip the run against every requested row it touches.
+      const TPixel        value = static_cast<TPixel>(run[1]);
+      const SizeValueType begin = std::max(position, firstVoxel);
+      const SizeValueType stop = std::min(runEnd, endVoxel);
+      for (SizeValueType row = begin / rowLength; row * rowLength < stop; ++row)
+      {
+        const SizeValueType rowStart = row * rowLength;
+        const SizeValueType from = std::max(begin, rowStart + regionStart[0]);
+        const SizeValueType to = std::min(stop, rowStart + columnEnd);
+        if (from < to)
+        {
+          TPixel * rowOutput = output + (row - regionStart[1]) * regionSize[0];
+          std::fill_n(rowOutput + (from - rowStart - regionStart[0]), to - from, value);
+        }
+      }
+    }
+    position = runEnd;
+  }
+  return position >= endVoxel;
+}
+
+template <typename TVisitor>
+bool
+AnalyzeObjectRunLengthCodec::ZipRuns(const unsigned char * first,
+                                     SizeValueType         numberOfFirstBytes,
+                                     const unsigned char * second,
+                                     SizeValueType         numberOfSecondBytes,
+                                     SizeValueType         planeSize,
+                                     SizeValueType         numberOfPlanes,
+                                     TVisitor &&           visitor)
+{
+  const unsigned char * const firstEnd = first + (numberOfFirstBytes & ~SizeValueType{ 1 });
+  const unsigned char * const secondEnd = second + (numberOfSecondBytes & ~SizeValueType{ 1 });
+  SizeValueType               firstRemaining = 0;
+  SizeValueType               secondRemaining = 0;
+  for (SizeValueType plane = 0; plane < numberOfPlanes; plane++)
+  {
+    for (SizeValueType voxel = 0; voxel < planeSize;)
+    {
+      // Both streams restart their runs on every plane, so a run left over is a run that crosses it.
+      if (firstRemaining == 0)
+      {
+        if (first == firstEnd || first[0] == 0)
+        {
+          return false;
+        }
+        firstRemaining = first[0];
+        first += 2;
+      }
+      if (secondRemaining == 0)
+      {
+        if (second == secondEnd || second[0] == 0)
+        {
+          return false;
+        }
+        secondRemaining = second[0];
+        second += 2;
+      }
+      const SizeValueType length = std::min(firstRemaining, secondRemaining);
+      if (std::max(firstRemaining, secondRemaining) > planeSize - voxel)
+      {
+        return false;
+      }
+      visitor(plane, voxel, length, first[-1], second[-1]);
+      firstRemaining -= length;
+      secondRemaining -= length;
+      voxel += length;
+    }
+  }
+  return true;
+}
+
+} // end namespace itk
+
+#endif // itkAnalyzeObjectRunLengthCodec_hxx
@@ -0,0 +1,153 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkAnalyzeObjectSiblingGeometry_h
+#define itkAnalyzeObjectSiblingGeometry_h
+
+#include "itkIntTypes.h"
+#include "AnalyzeObjectLabelMapExport.h"
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace itk
+{
+/** \class AnalyzeObjectSiblingGeometry
+ *  \ingroup AnalyzeObjectLabelMap
+ *  \ingroup AnalyzeObjectMapIO
+ *  \brief A process wide lookup of the geometry of the images next to object maps.
+ *
+ * Object maps hold no spacing, origin or direction.  They usually sit next to the image they
+ * label, foo.obj next to foo.nii, foo.nii.gz or foo.hdr, searched in that order.  Only the header
+ * of that image is read, through the ImageIO the factory picks for it.
+ *
+ * The files of a directory are listed once and kept until the modification time of the directory
+ * changes, and the geometry of an image is kept until its own modification time changes, so a
+ * lookup costs two stats once both are known.  Modification times only have a resolution of a
+ * second, so a listing or a header read during the second its file was last modified is not kept.
+ * Beyond MaximumNumberOfEntries listings, or geometries, the least recently used are forgotten.
+ * All methods are thread safe.
+ */
+class AnalyzeObjectLabelMap_EXPORT AnalyzeObjectSiblingGeometry
+{
+public:
+  /** The geometry of an image, as read from its header. */
+  struct Geometry
+  {
+    /** The image the geometry was read from. */
+    std::string FileName;
+
+    /** Modification time of the image, and time at which its header was read. */
+    long ModifiedTime{ 0 };
+    long ReadTime{ 0 };
+
+    /** Size, spacing, origin and direction cosines of the axes of the image. */
+    std::vector<SizeValueType>       Size;
+    std::vector<double>              Spacing;
+    std::vector<double>              Origin;
+    std::vector<std::vector<double>> Direction;
+
+    SizeValueType
+    GetNumberOfDimensions() const
+    {
+      return this->Spacing.size();
+    }
+  };
+
+  /** The lookup shared by the whole process. */
+  static AnalyzeObjectSiblingGeometry &
+  GetInstance();
+
+  /** Copies into geometry the geometry of the image next to objectMapFileName.  Returns false if
+   * there is no such image or if its header cannot be read. */
+  bool
+  Find(const std::string & objectMapFileName, Geometry & geometry);
+
+  /** Forgets every directory listing and geometry. */
+  void
+  Clear();
+
+  /** Largest number of directory listings kept, and of geometries kept.  Lowering it forgets the
+   * least recently used ones immediately.  Default is 4096. */
+  void
+  SetMaximumNumberOfEntries(SizeValueType maximumNumberOfEntries);
+  SizeValueType
+  GetMaximumNumberOfEntries() const;
+
+  /** The extensions of the images searched for, in order of preference. */
+  static const std::vector<std::string> &
+  GetSiblingExtensions();
+
+private:
+  AnalyzeObjectSiblingGeometry() = default;
+
+  /** The images of a directory that may hold the geometry of object maps. */
+  struct DirectoryListing
+  {
+    long ModifiedTime{ 0 };
+    long ReadTime{ 0 };
+
+    /** The preferred image for each file name without extension. */
+    std::unordered_map<std::string, std::string> Siblings;
+  };
+
+  /** Values keyed by file name, most recently used first. */
+  template <typename TValue>
+  class LeastRecentlyUsedMap
+  {
+  public:
+    /** The value of key, marked as most recently used, or nullptr. */
+    const TValue *
+    Find(const std::string & key);
+
+    /** Stores value as the most recently used value of key, and evicts the least recently used
+     * values beyond maximumNumberOfValues. */
+    void
+    Insert(const std::string & key, TValue value, SizeValueType maximumNumberOfValues);
+
+    void
+    Evict(SizeValueType maximumNumberOfValues);
+
+    void
+    Clear();
+
+  private:
+    using ListType = std::list<std::pair<std::string, TValue>>;
+
+    ListType                                                     m_Values;
+    std::unordered_map<std::string, typename ListType::iterator> m_Index;
+  };
+
+  /** Lists the images of directory. */
+  static DirectoryListing
+  ListDirectory(const std::string & directory, long modifiedTime);
+
+  /** Reads the geometry from the header of fileName.  Returns false if it cannot be read. */
+  static bool
+  ReadGeometry(const std::string & fileName, long modifiedTime, Geometry & geometry);
+
+  mutable std::mutex                     m_Mutex;
+  LeastRecentlyUsedMap<DirectoryListing> m_Directories;
+  LeastRecentlyUsedMap<Geometry>         m_Geometries; // Keyed by image file name.
+  SizeValueType                          m_MaximumNumberOfEntries{ 4096 };
+};
+} // end namespace itk
+
+#endif // itkAnalyzeObjectSiblingGeometry_h
@@ -27,6 +27,92 @@ AnalyzeObjectEntry::AnalyzeObjectEntry()
   std::memset(this->m_Name, 0, sizeof(this->m_Name));
 }
 
+void
+AnalyzeObjectEntry::CopyFromRecord(const AnalyzeObjectEntryRecord & record)
+{
+  std::memcpy(this->m_Name, record.Name, sizeof(this->m_Name));
+  this->m_DisplayFlag = record.DisplayFlag;
+  this->m_CopyFlag = record.CopyFlag;
+  this->m_MirrorFlag = record.MirrorFlag;
+  this->m_StatusFlag = record.StatusFlag;
+  this->m_NeighborsUsedFlag = record.NeighborsUsedFlag;
+  this->m_Shades = record.Shades;
+  this->m_StartRed = record.StartRed;
+  this->m_StartGreen = record.StartGreen;
+  this->m_StartBlue = record.StartBlue;
+  this->m_EndRed = record.EndRed;
+  this->m_EndGreen = record.EndGreen;
+  this->m_EndBlue = record.EndBlue;
+  this->m_XRotation = record.XRotation;
+  this->m_YRotation = record.YRotation;
+  this->m_ZRotation = record.ZRotation;
+  this->m_XTranslation = record.XTranslation;
+  this->m_YTranslation = record.YTranslation;
+  this->m_ZTranslation = record.ZTranslation;
+  this->m_XCenter = record.XCenter;
+  this->m_YCenter = record.YCenter;
+  this->m_ZCenter = record.ZCenter;
+  this->m_XRotationIncrement = record.XRotationIncrement;
+  this->m_YRotationIncrement = record.YRotationIncrement;
+  this->m_ZRotationIncrement = record.ZRotationIncrement;
+  this->m_XTranslationIncrement = record.XTranslationIncrement;
+  this->m_YTranslationIncrement = record.YTranslationIncrement;
+  this->m_ZTranslationIncrement = record.ZTranslationIncrement;
+  this->m_MinimumXValue = record.MinimumXValue;
+  this->m_MinimumYValue = record.MinimumYValue;
+  this->m_MinimumZValue = record.MinimumZValue;
+  this->m_MaximumXValue = record.MaximumXValue;
+  this->m_MaximumYValue = record.MaximumYValue;
+  this->m_MaximumZValue = record.MaximumZValue;
+  this->m_Opacity = record.Opacity;
+  this->m_OpacityThickness = record.OpacityThickness;
+  this->m_BlendFactor = record.BlendFactor;
+  this->Modified();
+}
+
+void
+AnalyzeObjectEntry::CopyToRecord(AnalyzeObjectEntryRecord & record) const
+{
+  std::memcpy(record.Name, this->m_Name, sizeof(record.Name));
+  record.Name[32] = '\0';
+  record.DisplayFlag = this->m_DisplayFlag;
+  record.CopyFlag = this->m_CopyFlag;
+  record.MirrorFlag = this->m_MirrorFlag;
+  record.StatusFlag = this->m_StatusFlag;
+  record.NeighborsUsedFlag = this->m_NeighborsUsedFlag;
+  record.Shades = this->m_Shades;
+  record.StartRed = this->m_StartRed;
+  record.StartGreen = this->m_StartGreen;
+  record.StartBlue = this->m_StartBlue;
+  record.EndRed = this->m_EndRed;
+  record.EndGreen = this->m_EndGreen;
+  record.EndBlue = this->m_EndBlue;
+  record.XRotation = this->m_XRotation;
+  record.YRotation = this->m_YRotation;
+  record.ZRotation = this->m_ZRotation;
+  record.XTranslation = this->m_XTranslation;
+  record.YTranslation = this->m_YTranslation;
+  record.ZTranslation = this->m_ZTranslation;
+  record.XCenter = this->m_XCenter;
+  record.YCenter = this->m_YCenter;
+  record.ZCenter = this->m_ZCenter;
+  record.XRotationIncrement = this->m_XRotationIncrement;
+  record.YRotationIncrement = this->m_YRotationIncrement;
+  record.ZRotationIncrement = this->m_ZRotationIncrement;
+  record.XTranslationIncrement = this->m_XTranslationIncrement;
+  record.YTranslationIncrement = this->m_YTranslationIncrement;
+  record.ZTranslationIncrement = this->m_ZTranslationIncrement;
+  record.MinimumXValue = this->m_MinimumXValue;
+  record.MinimumYValue = this->m_MinimumYValue;
+  record.MinimumZValue = this->m_MinimumZValue;
+  record.MaximumXValue = this->m_MaximumXValue;
+  record.MaximumYValue = this->m_MaximumYValue;
+  record.MaximumZValue = this->m_MaximumZValue;
+  record.Opacity = this->m_Opacity;
+  record.OpacityThickness = this->m_OpacityThickness;
+  record.BlendFactor = this->m_BlendFactor;
+}
+
 // AnalyzeObjectEntry & AnalyzeObjectEntry
 // ::operator=( const AnalyzeObjectEntry & rhs )
 
@@ -0,0 +1,292 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkAnalyzeObjectEntryRecord.h"
+#include "itkAnalyzeObjectEntry.h"
+#include "itkByteSwapper.h"
+
+#include <cstring>
+
+namespace itk
+{
+namespace
+{
+// Decodes the next field of type T and advances bytes past it.
+template <typename T>
+T
+DecodeField(const unsigned char *& bytes, bool bigEndian)
+{
+  T value;
+  std::memcpy(&value, bytes, sizeof(T));
+  bytes += sizeof(T);
+  if (bigEndian)
+  {
+    ByteSwapper<T>::SwapFromSystemToBigEndian(&value);
+  }
+  else
+  {
+    ByteSwapper<T>::SwapFromSystemToLittleEndian(&value);
+  }
+  return value;
+}
+
+bool
+IsKnownVersion(int version)
+{
+  return version == VERSION1 || version == VERSION2 || version == VERSION3 || version == VERSION4 ||
+         version == VERSION5 || version == VERSION6 || version == VERSION7;
+}
+
+// Swaps numberOfValues values of type T, starting at bytes, between native and file byte order.
+template <typename T>
+void
+SwapValues(unsigned char * bytes, SizeValueType numberOfValues, bool bigEndian)
+{
+  if (bigEndian)
+  {
+    ByteSwapper<T>::SwapRangeFromSystemToBigEndian(reinterpret_cast<T *>(bytes), numberOfValues);
+  }
+  else
+  {
+    ByteSwapper<T>::SwapRangeFromSystemToLittleEndian(reinterpret_cast<T *>(bytes), numberOfValues);
+  }
+}
+
+// Converts the multi-byte fields of numberOfEntries consecutive entries between native and file
+// byte order, in place.  The fields are laid out in four contiguous ranges, so a whole table is
+// converted with four range swaps per entry instead of one call per field.
+void
+SwapEntries(unsigned char * bytes, SizeValueType numberOfEntries, bool bigEndian)
+{
+  if (bigEndian == ByteSwapper<int>::SystemIsBigEndian())
+  {
+    return;
+  }
+  for (SizeValueType i = 0; i < numberOfEntries; i++)
+  {
+    unsigned char * entry = bytes + i * AnalyzeObjectEntryRecord::SizeInFile;
+    SwapValues<int>(entry + 32, 1, bigEndian);        // DisplayFlag
+    SwapValues<int>(entry + 40, 22, bigEndian);       // Shades to ZTranslationIncrement
+    SwapValues<short int>(entry + 128, 6, bigEndian); // MinimumXValue to MaximumZValue
+    SwapValues<int>(entry + 140, 3, bigEndian);       // Opacity, OpacityThickness and BlendFactor
+  }
+}
+
+// Calls visit with the name and the value of every field of an entry but the name, in the order they
+// are stored in the file.
+template <typename TRecord, typename TVisitor>
+void
+VisitFields(TRecord & record, TVisitor && visit)
+{
+  visit("DisplayFlag", record.DisplayFlag);
+  visit("CopyFlag", record.CopyFlag);
+  visit("MirrorFlag", record.MirrorFlag);
+  visit("StatusFlag", record.StatusFlag);
+  visit("NeighborsUsedFlag", record.NeighborsUsedFlag);
+  visit("Shades", record.Shades);
+  visit("StartRed", record.StartRed);
+  visit("StartGreen", record.StartGreen);
+  visit("StartBlue", record.StartBlue);
+  visit("EndRed", record.EndRed);
+  visit("EndGreen", record.EndGreen);
+  visit("EndBlue", record.EndBlue);
+  visit("XRotation", record.XRotation);
+  visit("YRotation", record.YRotation);
+  visit("ZRotation", record.ZRotation);
+  visit("XTranslation", record.XTranslation);
+  visit("YTranslation", record.YTranslation);
+  visit("ZTranslation", record.ZTranslation);
+  visit("XCenter", record.XCenter);
+  visit("YCenter", record.YCenter);
+  visit("ZCenter", record.ZCenter);
+  visit("XRotationIncrement", record.XRotationIncrement);
+  visit("YRotationIncrement", record.YRotationIncrement);
+  visit("ZRotationIncrement", record.ZRotationIncrement);
+  visit("XTranslationIncrement", record.XTranslationIncrement);
+  visit("YTranslationIncrement", record.YTranslationIncrement);
+  visit("ZTranslationIncrement", record.ZTranslationIncrement);
+  visit("MinimumXValue", record.MinimumXValue);
+  visit("MinimumYValue", record.MinimumYValue);
+  visit("MinimumZValue", record.MinimumZValue);
+  visit("MaximumXValue", record.MaximumXValue);
+  visit("MaximumYValue", record.MaximumYValue);
+  visit("MaximumZValue", record.MaximumZValue);
+  visit("Opacity", record.Opacity);
+  visit("OpacityThickness", record.OpacityThickness);
+  // As in AnalyzeObjectEntry::ReadFromFilePointer, the blend factor is stored for every version.
+  visit("BlendFactor", record.BlendFactor);
+}
+
+// Copies the SizeInFile bytes of an entry, in native byte order, into record.
+void
+LoadEntry(const unsigned char * bytes, AnalyzeObjectEntryRecord & record)
+{
+  std::memcpy(record.Name, bytes, 32);
+  record.Name[32] = '\0';
+  bytes += 32;
+  VisitFields(record, [&bytes](const char *, auto & value) {
+    std::memcpy(&value, bytes, sizeof(value));
+    bytes += sizeof(value);
+  });
+}
+
+// Copies record into the SizeInFile bytes of an entry, in native byte order.
+void
+StoreEntry(const AnalyzeObjectEntryRecord & record, unsigned char * bytes)
+{
+  std::memcpy(bytes, record.Name, 32);
+  bytes += 32;
+  VisitFields(record, [&bytes](const char *, const auto & value) {
+    std::memcpy(bytes, &value, sizeof(value));
+    bytes += sizeof(value);
+  });
+}
+} // namespace
+
+void
+AnalyzeObjectEntryRecord::Decode(const unsigned char * bytes, bool bigEndian)
+{
+  unsigned char entry[SizeInFile];
+  std::memcpy(entry, bytes, SizeInFile);
+  SwapEntries(entry, 1, bigEndian);
+  LoadEntry(entry, *this);
+}
+
+void
+AnalyzeObjectEntryRecord::Encode(unsigned char * bytes, bool bigEndian) const
+{
+  StoreEntry(*this, bytes);
+  SwapEntries(bytes, 1, bigEndian);
+}
+
+void
+AnalyzeObjectEntryRecord::GetDifferingFields(const AnalyzeObjectEntryRecord & other,
+                                             std::vector<std::string> &       fieldNames) const
+{
+  // The fields are compared as stored, so that two NaN opacities are equal.
+  unsigned char entry[SizeInFile];
+  unsigned char otherEntry[SizeInFile];
+  StoreEntry(*this, entry);
+  StoreEntry(other, otherEntry);
+  if (std::strncmp(this->Name, other.Name, 32) != 0)
+  {
+    fieldNames.emplace_back("Name");
+  }
+  SizeValueType offset = 32;
+  VisitFields(*this, [&](const char * name, const auto & value) {
+    if (std::memcmp(entry + offset, otherEntry + offset, sizeof(value)) != 0)
+    {
+      fieldNames.emplace_back(name);
+    }
+    offset += sizeof(value);
+  });
+}
+
+bool
+AnalyzeObjectMapHeaderRecord::Decode(const unsigned char * bytes, SizeValueType numberOfBytes, bool readEntries)
+{
+  this->Valid = false;
+  this->Entries.clear();
+  if (numberOfBytes < 20)
+  {
+    return false;
+  }
+
+  // The version tells the byte order of the file.
+  const unsigned char * field = bytes;
+  this->BigEndian = true;
+  this->Version = DecodeField<int>(field, true);
+  if (!IsKnownVersion(this->Version))
+  {
+    field = bytes;
+    this->BigEndian = false;
+    this->Version = DecodeField<int>(field, false);
+    if (!IsKnownVersion(this->Version))
+    {
+      return false;
+    }
+  }
+  this->Dimensions[0] = DecodeField<int>(field, this->BigEndian);
+  this->Dimensions[1] = DecodeField<int>(field, this->BigEndian);
+  this->Dimensions[2] = DecodeField<int>(field, this->BigEndian);
+  this->NumberOfObjects = DecodeField<int>(field, this->BigEndian);
+  this->Dimensions[3] = 1;
+  if (this->Version == VERSION7)
+  {
+    if (numberOfBytes < 24)
+    {
+      return false;
+    }
+    this->Dimensions[3] = DecodeField<int>(field, this->BigEndian);
+  }
+  for (int d : this->Dimensions)
+  {
+    if (d < 1)
+    {
+      return false;
+    }
+  }
+  if (this->NumberOfObjects < 1 || this->NumberOfObjects > 256)
+  {
+    return false;
+  }
+  const auto headerSize = static_cast<SizeValueType>(field - bytes);
+  this->DataOffset = headerSize + this->NumberOfObjects * AnalyzeObjectEntryRecord::SizeInFile;
+
+  if (readEntries)
+  {
+    if (numberOfBytes < this->DataOffset)
+    {
+      return false;
+    }
+    // The whole table is converted to native byte order in one pass over a scratch copy.
+    std::vector<unsigned char> table(field, bytes + this->DataOffset);
+    SwapEntries(table.data(), this->NumberOfObjects, this->BigEndian);
+    this->Entries.resize(this->NumberOfObjects);
+    for (SizeValueType i = 0; i < this->Entries.size(); i++)
+    {
+      LoadEntry(table.data() + i * AnalyzeObjectEntryRecord::SizeInFile, this->Entries[i]);
+    }
+  }
+  this->Valid = true;
+  return true;
+}
+
+void
+AnalyzeObjectMapHeaderRecord::Encode(std::vector<unsigned char> & bytes, bool bigEndian) const
+{
+  const SizeValueType headerSize = this->Version == VERSION7 ? 24 : 20;
+  bytes.resize(headerSize + this->Entries.size() * AnalyzeObjectEntryRecord::SizeInFile);
+
+  const int numberOfObjects = static_cast<int>(this->Entries.size());
+  const int header[6] = { this->Version,       this->Dimensions[0], this->Dimensions[1],
+                          this->Dimensions[2], numberOfObjects,     this->Dimensions[3] };
+  std::memcpy(bytes.data(), header, headerSize);
+  unsigned char * table = bytes.data() + headerSize;
+  for (SizeValueType i = 0; i < this->Entries.size(); i++)
+  {
+    StoreEntry(this->Entries[i], table + i * AnalyzeObjectEntryRecord::SizeInFile);
+  }
+
+  if (bigEndian != ByteSwapper<int>::SystemIsBigEndian())
+  {
+    SwapValues<int>(bytes.data(), headerSize / sizeof(int), bigEndian);
+    SwapEntries(table, this->Entries.size(), bigEndian);
+  }
+}
+
+} // end namespace itk
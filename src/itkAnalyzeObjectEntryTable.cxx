@@ -0,0 +1,111 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkAnalyzeObjectEntryTable.h"
+
+namespace itk
+{
+
+AnalyzeObjectEntryTable::AnalyzeObjectEntryTable(SizeValueType numberOfEntries)
+  : m_Records(numberOfEntries, GetDefaultRecord())
+{}
+
+void
+AnalyzeObjectEntryTable::SetNumberOfEntries(SizeValueType numberOfEntries)
+{
+  this->m_Records.resize(numberOfEntries, GetDefaultRecord());
+}
+
+auto
+AnalyzeObjectEntryTable::AddEntry(const std::string & name) -> EntryView
+{
+  this->m_Records.push_back(GetDefaultRecord());
+  EntryView entry(&this->m_Records.back());
+  entry.SetName(name);
+  return entry;
+}
+
+auto
+AnalyzeObjectEntryTable::GetDefaultRecord() -> const RecordType &
+{
+  // Taken from a new entry, so that both always agree.
+  static const RecordType defaultRecord = [] {
+    RecordType record;
+    AnalyzeObjectEntry::New()->CopyToRecord(record);
+    return record;
+  }();
+  return defaultRecord;
+}
+
+void
+AnalyzeObjectEntryTable::CopyFromEntryArray(const EntryArrayType & entries)
+{
+  this->m_Records.resize(entries.size());
+  for (SizeValueType i = 0; i < entries.size(); i++)
+  {
+    entries[i]->CopyToRecord(this->m_Records[i]);
+  }
+}
+
+void
+AnalyzeObjectEntryTable::CopyRecordsToEntryArray(const RecordContainerType & records, EntryArrayType & entries)
+{
+  entries.resize(records.size());
+  for (SizeValueType i = 0; i < entries.size(); i++)
+  {
+    if (entries[i].IsNull() || entries[i]->GetReferenceCount() > 1)
+    {
+      entries[i] = AnalyzeObjectEntry::New();
+    }
+    entries[i]->CopyFromRecord(records[i]);
+  }
+}
+
+bool
+AnalyzeObjectEntryTable::operator==(const AnalyzeObjectEntryTable & other) const
+{
+  if (this->m_Records.size() != other.m_Records.size())
+  {
+    return false;
+  }
+  // The records are compared through their encoding, which skips the padding between fields.
+  unsigned char bytes[AnalyzeObjectEntryRecord::SizeInFile];
+  unsigned char otherBytes[AnalyzeObjectEntryRecord::SizeInFile];
+  for (SizeValueType i = 0; i < this->m_Records.size(); i++)
+  {
+    this->m_Records[i].Encode(bytes, true);
+    other.m_Records[i].Encode(otherBytes, true);
+    if (std::memcmp(bytes, otherBytes, sizeof(bytes)) != 0)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::ostream &
+operator<<(std::ostream & os, const AnalyzeObjectEntryTable & table)
+{
+  os << table.GetNumberOfEntries() << " entries:";
+  for (SizeValueType i = 0; i < table.GetNumberOfEntries(); i++)
+  {
+    os << (i == 0 ? " " : ", ") << table[i].GetName();
+  }
+  return os;
+}
+
+} // end namespace itk
@@ -23,29 +23,76 @@
 #include "itkSpatialOrientationAdapter.h"
 #include "itksys/SystemTools.hxx"
 #include "itkMath.h"
+#include "itkMultiThreaderBase.h"
 
 #include "itkAnalyzeObjectLabelMapImageIO.h"
+#include "itkAnalyzeObjectMapAtomicWriter.h"
+#include "itkAnalyzeObjectMapMemoryCodec.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <functional>
+#include <numeric>
+#include <string>
 #include <vector>
 
 namespace itk
 {
-// Streaming not yet supported, so use the default base class to return the LargestPossibleRegion
-#if _USE_STREAMABLE_REGION_FOR_AOLM
+namespace
+{
+// Copies a region of a volume into output, converting the voxels to the output pixel type.  The
+// volume and the region are both given in four dimensions.
+template <typename TInput, typename TOutput>
+void
+CopyRegionOfVolume(const TInput *      volume,
+                   const SizeValueType fileSize[4],
+                   const SizeValueType regionStart[4],
+                   const SizeValueType regionSize[4],
+                   TOutput *           output)
+{
+  for (SizeValueType t = regionStart[3]; t < regionStart[3] + regionSize[3]; t++)
+  {
+    for (SizeValueType z = regionStart[2]; z < regionStart[2] + regionSize[2]; z++)
+    {
+      for (SizeValueType y = regionStart[1]; y < regionStart[1] + regionSize[1]; y++)
+      {
+        const TInput * row = volume + ((t * fileSize[2] + z) * fileSize[1] + y) * fileSize[0];
+        output = std::copy(row + regionStart[0], row + regionStart[0] + regionSize[0], output);
+      }
+    }
+  }
+}
+
+// Sets the bits [begin, end) of bits.
+void
+SetBits(std::uint64_t * bits, SizeValueType begin, SizeValueType end)
+{
+  for (; begin < end && begin % 64 != 0; begin++)
+  {
+    bits[begin / 64] |= std::uint64_t{ 1 } << (begin % 64);
+  }
+  for (; begin + 64 <= end; begin += 64)
+  {
+    bits[begin / 64] = ~std::uint64_t{ 0 };
+  }
+  for (; begin < end; begin++)
+  {
+    bits[begin / 64] |= std::uint64_t{ 1 } << (begin % 64);
+  }
+}
+} // namespace
+
 ImageIORegion
 AnalyzeObjectLabelMapImageIO ::GenerateStreamableReadRegionFromRequestedRegion(
   const ImageIORegion & requestedRegion) const
 {
-  std::cout << "AnalyzeObjectLabelMapImageIO::GenerateStreamableReadRegionFromRequestedRegion() " << std::endl;
-  std::cout << "RequestedRegion = " << requestedRegion << std::endl;
-
+  itkDebugMacro(<< "RequestedRegion = " << requestedRegion);
   return requestedRegion;
 }
 
-#endif
-
 AnalyzeObjectLabelMapImageIO::AnalyzeObjectLabelMapImageIO()
 {
   // Nothing to do during initialization.
@@ -57,6 +104,38 @@ void
 AnalyzeObjectLabelMapImageIO::PrintSelf(std::ostream & os, Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
+  os << indent << "OutputComponentType: " << ImageIOBase::GetComponentTypeAsString(this->m_OutputComponentType)
+     << std::endl;
+  os << indent << "UseLabelCompaction: " << this->m_UseLabelCompaction << std::endl;
+  os << indent << "LabelCompactionTable size: " << this->m_LabelCompactionTable.size() << std::endl;
+  os << indent << "UsePlaneIndexFile: " << this->m_UsePlaneIndexFile << std::endl;
+  os << indent << "UseCache: " << this->m_UseCache << std::endl;
+  os << indent << "UseSiblingGeometry: " << this->m_UseSiblingGeometry << std::endl;
+  os << indent << "UseEntryTable: " << this->m_UseEntryTable << std::endl;
+  os << indent << "UseAtomicWrite: " << this->m_UseAtomicWrite << std::endl;
+  os << indent << "UseSynchronousWrite: " << this->m_UseSynchronousWrite << std::endl;
+  os << indent << "ScratchBufferSizeInBytes: " << this->GetScratchBufferSizeInBytes() << std::endl;
+}
+
+void
+AnalyzeObjectLabelMapImageIO::ReleaseScratchBuffers()
+{
+  AnalyzeObjectRunLengthCodec::BufferType().swap(this->m_RunLengthBuffer);
+  std::vector<unsigned char>().swap(this->m_HeaderBuffer);
+  this->m_HeaderRecord = AnalyzeObjectMapHeaderRecord();
+  AnalyzeObjectEntryArrayType().swap(this->m_Entries);
+  this->m_EntryTable = AnalyzeObjectEntryTable();
+  AnalyzeObjectEntryTable::RecordContainerType().swap(this->m_EntryRecordsToWrite);
+}
+
+SizeValueType
+AnalyzeObjectLabelMapImageIO::GetScratchBufferSizeInBytes() const
+{
+  const SizeValueType numberOfRecords = this->m_HeaderRecord.Entries.capacity() +
+                                        this->m_EntryTable.GetRecords().capacity() +
+                                        this->m_EntryRecordsToWrite.capacity();
+  return this->m_RunLengthBuffer.capacity() + this->m_HeaderBuffer.capacity() +
+         numberOfRecords * sizeof(AnalyzeObjectEntryRecord) + this->m_Entries.size() * sizeof(AnalyzeObjectEntry);
 }
 
 bool
@@ -82,169 +161,438 @@ AnalyzeObjectLabelMapImageIO::CanWriteFile(const char * FileNameToWrite)
 void
 AnalyzeObjectLabelMapImageIO::Read(void * buffer)
 {
-  this->m_InputFileStream.open(m_FileName.c_str(), std::ios::binary | std::ios::in);
-  this->m_InputFileStream.seekg(m_LocationOfFile);
-  if (!this->m_InputFileStream.is_open())
+  this->ReadToBuffer(buffer, this->GetComponentType());
+}
+
+void
+AnalyzeObjectLabelMapImageIO::ReadToBuffer(void * buffer, IOComponentEnum componentType)
+{
+  switch (componentType)
   {
-    itkDebugMacro(<< "Error: Could not open " << m_FileName.c_str());
-    exit(-1);
+    case IOComponentEnum::UCHAR:
+      this->DecodeRunLengthRegion(static_cast<unsigned char *>(buffer));
+      break;
+    case IOComponentEnum::CHAR:
+      this->DecodeRunLengthRegion(static_cast<char *>(buffer));
+      break;
+    case IOComponentEnum::USHORT:
+      this->DecodeRunLengthRegion(static_cast<unsigned short *>(buffer));
+      break;
+    case IOComponentEnum::SHORT:
+      this->DecodeRunLengthRegion(static_cast<short *>(buffer));
+      break;
+    case IOComponentEnum::UINT:
+      this->DecodeRunLengthRegion(static_cast<unsigned int *>(buffer));
+      break;
+    case IOComponentEnum::INT:
+      this->DecodeRunLengthRegion(static_cast<int *>(buffer));
+      break;
+    case IOComponentEnum::FLOAT:
+      this->DecodeRunLengthRegion(static_cast<float *>(buffer));
+      break;
+    case IOComponentEnum::DOUBLE:
+      this->DecodeRunLengthRegion(static_cast<double *>(buffer));
+      break;
+    default:
+      itkExceptionMacro(<< "Object maps cannot be decoded into "
+                        << ImageIOBase::GetComponentTypeAsString(componentType) << " pixels.");
   }
-  // TODO: Image spacing needs fixing.  Will need to look to see if a
-  //      .nii, .nii.gz, or a .hdr file
-  //      exists for the same .obj file.
-  //      If so, then read in the spacing for those images.
+}
 
-  // When this function decods the run length encoded raw data into an unsigned char volume
-  // store the values into this structure.
-  struct RunLengthStruct
+void
+AnalyzeObjectLabelMapImageIO::ReadFromMemory(const void * data, SizeValueType numberOfBytes, void * buffer)
+{
+  // The region is decoded as from a file, but the runs are taken from the bytes in memory.
+  this->m_MemoryBytes = static_cast<const unsigned char *>(data);
+  this->m_NumberOfMemoryBytes = numberOfBytes;
+  try
   {
-    unsigned char voxel_count;
-    unsigned char voxel_value;
-  };
-  using RunLengthElement = struct RunLengthStruct;
-  RunLengthElement RunLengthArray[NumberOfRunLengthElementsPerRead];
+    this->ReadToBuffer(buffer, this->GetComponentType());
+  }
+  catch (...)
+  {
+    this->m_MemoryBytes = nullptr;
+    throw;
+  }
+  this->m_MemoryBytes = nullptr;
+}
+
+template <typename TPixel>
+void
+AnalyzeObjectLabelMapImageIO::DecodeRunLengthData(TPixel * buffer)
+{
+  const SizeValueType VolumeSize = this->GetImageSizeInPixels();
+  SizeValueType       index = 0;
+  if (this->m_MemoryBytes != nullptr)
+  {
+    const auto dataOffset = static_cast<SizeValueType>(m_LocationOfFile);
+    if (dataOffset > this->m_NumberOfMemoryBytes ||
+        !AnalyzeObjectRunLengthCodec::DecodeRuns(this->m_MemoryBytes + dataOffset,
+                                                 this->m_NumberOfMemoryBytes - dataOffset,
+                                                 buffer,
+                                                 VolumeSize,
+                                                 index) ||
+        index != VolumeSize)
+    {
+      itkExceptionMacro(<< "Error decoding the run-length encoding of the object map in memory: " << index << " of "
+                        << VolumeSize << " voxels decoded.");
+    }
+    return;
+  }
+
+  this->m_InputFileStream.open(m_FileName.c_str(), std::ios::binary | std::ios::in);
+  if (!this->m_InputFileStream.is_open())
+  {
+    itkExceptionMacro(<< "Error: Could not open " << m_FileName.c_str());
+  }
+  this->m_InputFileStream.seekg(m_LocationOfFile);
 
   // The file consists of unsigned character pairs which represents the encoding of the data
   // The character pairs have the form of length, tag value.  Note also that the data in
   // Analyze object files are run length encoded a plane at a time.
+  AnalyzeObjectRunLengthCodec::BufferType & RunLengthArray = this->m_RunLengthBuffer;
+  RunLengthArray.resize(2 * NumberOfRunLengthElementsPerRead);
+  while (this->m_InputFileStream)
+  {
+    this->m_InputFileStream.read(reinterpret_cast<char *>(RunLengthArray.data()), RunLengthArray.size());
+    const auto bytesRead = static_cast<SizeValueType>(this->m_InputFileStream.gcount());
+    if (!AnalyzeObjectRunLengthCodec::DecodeRuns(RunLengthArray.data(), bytesRead, buffer, VolumeSize, index))
+    {
+      this->m_InputFileStream.close();
+      this->m_InputFileStream.clear();
+      itkExceptionMacro(<< "Error decoding run-length encoding of " << m_FileName.c_str()
+                        << ": invalid run length or file overrun.");
+    }
+  }
+  this->m_InputFileStream.close();
+  this->m_InputFileStream.clear();
+
+  if (index != VolumeSize)
+  {
+    itkExceptionMacro(<< "Error decoding run-length encoding of " << m_FileName.c_str() << ": file underrun, "
+                      << index << " of " << VolumeSize << " voxels read.");
+  }
+}
+
+template <typename TPixel>
+void
+AnalyzeObjectLabelMapImageIO::DecodeRunLengthRegion(TPixel * buffer)
+{
+  // The file and the requested region, both padded to four dimensions.  Dimensions of the
+  // region beyond those of the file, or the other way around, have a size of one.
+  SizeValueType fileSize[4] = { 1, 1, 1, 1 };
+  SizeValueType regionStart[4] = { 0, 0, 0, 0 };
+  SizeValueType regionSize[4] = { 1, 1, 1, 1 };
+  for (unsigned int d = 0; d < this->GetNumberOfDimensions() && d < 4; d++)
+  {
+    fileSize[d] = this->GetDimensions(d);
+  }
+  const ImageIORegion & region = this->GetIORegion();
+  bool                  wholeImage = true;
+  for (unsigned int d = 0; d < region.GetImageDimension() && d < 4; d++)
+  {
+    regionStart[d] = region.GetIndex(d);
+    regionSize[d] = region.GetSize(d);
+  }
+  for (unsigned int d = 0; d < 4; d++)
+  {
+    if (regionSize[d] == 0)
+    {
+      return;
+    }
+    if (regionStart[d] + regionSize[d] > fileSize[d])
+    {
+      itkExceptionMacro(<< "The requested region lies outside of " << m_FileName.c_str());
+    }
+    wholeImage = wholeImage && regionStart[d] == 0 && regionSize[d] == fileSize[d];
+  }
+  if (this->m_UseCache && !this->m_CachedObjectMap.Entries.empty() &&
+      (wholeImage || this->m_CachedObjectMap.Voxels.IsNotNull()))
+  {
+    this->UpdateCachedVoxels();
+    CopyRegionOfVolume(this->m_CachedObjectMap.Voxels->GetBufferPointer(), fileSize, regionStart, regionSize, buffer);
+    return;
+  }
+  if (wholeImage)
+  {
+    this->DecodeRunLengthData(buffer);
+    return;
+  }
 
-  int    index = 0;
-  int    voxel_count_sum = 0;
-  auto * tobuf = (unsigned char *)buffer;
-
-  // The following commented out code is a starting attempt at streaming.
-
-  //    ImageIORegion regionToRead = this->GetIORegion();
-  // ImageIORegion::SizeType size = regionToRead.GetSize();
-  // ImageIORegion::IndexType start = regionToRead.GetIndex();
-  // const int DimensionSize = regionToRead.GetImageDimension();
-  // int dimensions[4] = {1};
-  // int startPoint[4] = {1};
-  // for(int i = 0; i<4; i ++)
-  // {
-  //  dimensions[i] = regionToRead.GetSize(i);
-  //  startPoint[i] = regionToRead.GetIndex(i);
-  // }
-  //  int xDim = 1;
-  //  int yDim = 1;
-  //  int zDim = 1;
-  //  switch (regionToRead.GetImageDimension())
-  //  {
-  //    case 3:
-  //      zDim = regionToRead.GetSize(2);
-  //    case 2:
-  //      yDim = regionToRead.GetSize(1);
-  //    case 1:
-  //      xDim = regionToRead.GetSize(0);
-  //      break;
-  //    default:
-  //      break;
-  //  }
-
-  /*const int numberOfBytesToRead = 2 * startPoint[0] * startPoint[1] * startPoint[2];
-      int *cornersOfRegion;
-      cornersOfRegion = new int(numberOfBytesToRead);
-      for(int i = 1; i <zDim+1; i++)
+  const SizeValueType PlaneSize = fileSize[0] * fileSize[1];
+  const SizeValueType RegionPlaneSize = regionSize[0] * regionSize[1];
+  if (this->m_MemoryBytes != nullptr || !this->UpdatePlaneIndex())
+  {
+    // Runs that cross planes can not be indexed, and runs in memory are not, so expand everything
+    // and copy the region.
+    itkDebugMacro(<< "The planes of " << m_FileName.c_str() << " can not be indexed, reading the whole file.");
+    std::vector<TPixel> wholeBuffer(this->GetImageSizeInPixels());
+    this->DecodeRunLengthData(wholeBuffer.data());
+    CopyRegionOfVolume(wholeBuffer.data(), fileSize, regionStart, regionSize, buffer);
+    return;
+  }
+
+  this->m_InputFileStream.open(m_FileName.c_str(), std::ios::binary | std::ios::in);
+  if (!this->m_InputFileStream.is_open())
+  {
+    itkExceptionMacro(<< "Error: Could not open " << m_FileName.c_str());
+  }
+  AnalyzeObjectRunLengthCodec::BufferType & RunLengthArray = this->m_RunLengthBuffer;
+  TPixel *                                  out = buffer;
+  for (SizeValueType t = regionStart[3]; t < regionStart[3] + regionSize[3]; t++)
+  {
+    for (SizeValueType z = regionStart[2]; z < regionStart[2] + regionSize[2]; z++)
+    {
+      // Planes outside of the region are never read, nor are planes that hold a single label.
+      const SizeValueType plane = z + t * fileSize[2];
+      unsigned char       uniformLabel;
+      if (this->m_PlaneIndex.GetPlaneUniformLabel(plane, uniformLabel))
       {
-        for(int j = 1; j<(2 * startPoint[0] * startPoint[1] * startPoint[2]); j++)
-        {
-          if((j-1)%2 != 2 && j!=1)
-          {
-            cornersOfRegion[j] = (startPoint[0] * startPoint[1] * startPoint[2] + xDim * (j/2) + startPoint[1] +
-     (j-1)/2) * i;
-          }
-          else if(j%2 != 2)
-          {
-            cornersOfRegion[j] = (startPoint[0] * startPoint[1] * startPoint[2] + xDim * (j/2)) * i;
-          }
-          else
-          {
-            cornersOfRegion[0] = startPoint[0] * startPoint[1] * startPoint[2];
-          }
-        }
+        out = std::fill_n(out, RegionPlaneSize, static_cast<TPixel>(uniformLabel));
+        continue;
+      }
+      RunLengthArray.resize(this->m_PlaneIndex.GetPlaneLength(plane));
+      this->m_InputFileStream.seekg(this->m_PlaneIndex.GetPlaneOffset(plane));
+      if (this->m_InputFileStream.read(reinterpret_cast<char *>(RunLengthArray.data()), RunLengthArray.size()).fail() ||
+          !AnalyzeObjectRunLengthCodec::DecodePlaneRegion(RunLengthArray.data(),
+                                                          RunLengthArray.size(),
+                                                          fileSize[0],
+                                                          PlaneSize,
+                                                          regionStart,
+                                                          regionSize,
+                                                          out))
+      {
+        this->m_InputFileStream.close();
+        this->m_InputFileStream.clear();
+        this->m_PlaneIndex.Clear();
+        itkExceptionMacro(<< "Error decoding plane " << plane << " of " << m_FileName.c_str());
       }
-      std::cout<<"Can not deal with the image size right now"<<std::endl;*/
+      out += RegionPlaneSize;
+    }
+  }
+  this->m_InputFileStream.close();
+  this->m_InputFileStream.clear();
+}
 
-  int      VolumeSize = 1;
-  unsigned dim = this->GetNumberOfDimensions();
-  switch (dim)
+std::vector<SizeValueType>
+AnalyzeObjectLabelMapImageIO::GetPlanesContainingLabel(unsigned char label)
+{
+  if (!this->UpdatePlaneIndex())
   {
-    case 4:
-      VolumeSize *= this->GetDimensions(3);
-    case 3:
-      VolumeSize *= this->GetDimensions(2);
-    case 2:
-      VolumeSize *= this->GetDimensions(1);
-    case 1:
-      VolumeSize *= this->GetDimensions(0);
-      break;
-    default:
-      itkExceptionMacro(<< "Dimensions " << dim << " > maximum dimension 4");
+    itkExceptionMacro(<< "The planes of " << m_FileName.c_str() << " can not be indexed.");
+  }
+  std::vector<SizeValueType> planes;
+  for (SizeValueType plane = 0; plane < this->m_PlaneIndex.GetNumberOfPlanes(); plane++)
+  {
+    if (this->m_PlaneIndex.PlaneContainsLabel(plane, label))
+    {
+      planes.push_back(plane);
+    }
+  }
+  return planes;
+}
+
+std::vector<AnalyzeObjectLabelMapImageIO::ProjectionImageType::Pointer>
+AnalyzeObjectLabelMapImageIO::GetLabelProjections(const std::vector<unsigned char> & labels,
+                                                  ThreadIdType                       numberOfThreads)
+{
+  if (!this->UpdatePlaneIndex())
+  {
+    itkExceptionMacro(<< "The planes of " << m_FileName.c_str() << " can not be indexed.");
   }
+  const SizeValueType xDimension = this->GetDimensions(0);
+  const SizeValueType yDimension = this->GetNumberOfDimensions() > 1 ? this->GetDimensions(1) : 1;
+  const SizeValueType PlaneSize = xDimension * yDimension;
+  const SizeValueType NumberOfPlanes = this->m_PlaneIndex.GetNumberOfPlanes();
+  const SizeValueType WordsPerMask = (PlaneSize + 63) / 64;
 
-  // You can uncomment the following commented out code to have a file written with the exact values that are read in.
+  // Every distinct label gets a mask of a bit per column; a label requested twice shares it.
+  int                        maskOfLabel[256];
+  std::vector<unsigned char> maskLabels;
+  std::fill_n(maskOfLabel, 256, -1);
+  for (const unsigned char label : labels)
+  {
+    if (maskOfLabel[label] < 0)
+    {
+      maskOfLabel[label] = static_cast<int>(maskLabels.size());
+      maskLabels.push_back(label);
+    }
+  }
 
-  //      std::ofstream myfile;
-  //      myfile.open("VoxelInformationReader.txt", myfile.app);
-  while (!this->m_InputFileStream
-            .read(reinterpret_cast<char *>(RunLengthArray), sizeof(RunLengthElement) * NumberOfRunLengthElementsPerRead)
-            .eof())
+  // The planes are split in contiguous chunks, each projected into its own masks by one thread.
+  if (numberOfThreads == 0)
   {
-    for (const auto & i : RunLengthArray)
+    numberOfThreads = MultiThreaderBase::GetGlobalDefaultNumberOfThreads();
+  }
+  const SizeValueType numberOfChunks =
+    std::max<SizeValueType>(1, std::min<SizeValueType>(numberOfThreads, maskLabels.empty() ? 1 : NumberOfPlanes));
+  std::vector<std::vector<std::uint64_t>> chunkMasks(numberOfChunks);
+  std::vector<SizeValueType>              failedPlanes(numberOfChunks, NumberOfPlanes);
+  const auto                              projectChunk = [&](SizeValueType chunk) {
+    std::vector<std::uint64_t> & masks = chunkMasks[chunk];
+    masks.assign(maskLabels.size() * WordsPerMask, 0);
+    std::ifstream              inputFileStream(m_FileName.c_str(), std::ios::binary | std::ios::in);
+    std::vector<unsigned char> RunLengthArray;
+    for (SizeValueType plane = chunk * NumberOfPlanes / numberOfChunks;
+         plane < (chunk + 1) * NumberOfPlanes / numberOfChunks;
+         plane++)
     {
-      //           myfile<< "Assigning: " << (int)RunLengthArray[i].voxel_count
-      //             << " voxels of label " << (int)RunLengthArray[i].voxel_value
-      //             << std::endl;
-      if (i.voxel_count == 0)
+      unsigned char uniformLabel;
+      if (this->m_PlaneIndex.GetPlaneUniformLabel(plane, uniformLabel))
       {
-        itkDebugMacro(<< "Inside AnaylzeObjectLabelMap Invalid Length " << static_cast<int>(i.voxel_count)
-                      << std::endl);
-        exit(-1);
+        if (maskOfLabel[uniformLabel] >= 0)
+        {
+          SetBits(masks.data() + maskOfLabel[uniformLabel] * WordsPerMask, 0, PlaneSize);
+        }
+        continue;
       }
-      for (int j = 0; j < i.voxel_count; j++)
+      if (std::none_of(maskLabels.begin(), maskLabels.end(), [this, plane](unsigned char label) {
+            return this->m_PlaneIndex.PlaneContainsLabel(plane, label);
+          }))
       {
-        tobuf[index] = i.voxel_value;
-        index++;
+        continue;
       }
-      voxel_count_sum += i.voxel_count;
-      //          myfile <<"index = "<<index
-      //            << " voxel_count_sum= " << voxel_count_sum
-      //            << " Volume size = "<<VolumeSize<<std::endl;
-      if (index > VolumeSize)
+      RunLengthArray.resize(this->m_PlaneIndex.GetPlaneLength(plane));
+      inputFileStream.seekg(this->m_PlaneIndex.GetPlaneOffset(plane));
+      if (inputFileStream.read(reinterpret_cast<char *>(RunLengthArray.data()), RunLengthArray.size()).fail())
       {
-        itkDebugMacro(<< "BREAK!\n");
-        exit(-1);
+        failedPlanes[chunk] = plane;
+        return;
       }
+      SizeValueType voxel = 0;
+      for (SizeValueType i = 0; i + 1 < RunLengthArray.size(); i += 2)
+      {
+        const SizeValueType end = voxel + RunLengthArray[i];
+        if (end > PlaneSize)
+        {
+          failedPlanes[chunk] = plane;
+          return;
+        }
+        const int mask = maskOfLabel[RunLengthArray[i + 1]];
+        if (mask >= 0)
+        {
+          SetBits(masks.data() + mask * WordsPerMask, voxel, end);
+        }
+        voxel = end;
+      }
+    }
+  };
+  if (numberOfChunks == 1)
+  {
+    projectChunk(0);
+  }
+  else
+  {
+    MultiThreaderBase::Pointer threader = MultiThreaderBase::New();
+    threader->SetMaximumNumberOfThreads(numberOfThreads);
+    threader->SetNumberOfWorkUnits(numberOfThreads);
+    threader->ParallelizeArray(0, numberOfChunks, projectChunk, nullptr);
+  }
+  for (SizeValueType chunk = 0; chunk < numberOfChunks; chunk++)
+  {
+    if (failedPlanes[chunk] < NumberOfPlanes)
+    {
+      this->m_PlaneIndex.Clear();
+      itkExceptionMacro(<< "Error projecting plane " << failedPlanes[chunk] << " of " << m_FileName.c_str());
     }
   }
+  std::vector<std::uint64_t> & masks = chunkMasks[0];
+  for (SizeValueType chunk = 1; chunk < numberOfChunks; chunk++)
+  {
+    std::transform(
+      masks.begin(), masks.end(), chunkMasks[chunk].begin(), masks.begin(), std::bit_or<std::uint64_t>());
+  }
 
-  //      myfile.close();
+  // The projections take the in plane part of the geometry of the map.  When the x and y axes of
+  // the map point mostly along z, the in plane part of the direction is singular and is not used.
+  const unsigned int numberOfPlaneDimensions = std::min(this->GetNumberOfDimensions(), 2u);
+  double             inPlane[2][2] = { { 1.0, 0.0 }, { 0.0, 1.0 } };
+  for (unsigned int d = 0; d < numberOfPlaneDimensions; d++)
+  {
+    for (unsigned int i = 0; i < numberOfPlaneDimensions; i++)
+    {
+      inPlane[i][d] = this->GetDirection(d)[i];
+    }
+  }
+  const bool singular = std::abs(inPlane[0][0] * inPlane[1][1] - inPlane[0][1] * inPlane[1][0]) < 1e-6;
 
-  if (index != VolumeSize)
+  ProjectionImageType::SizeType      size = { { xDimension, yDimension } };
+  ProjectionImageType::SpacingType   spacing;
+  ProjectionImageType::PointType     origin;
+  ProjectionImageType::DirectionType direction;
+  for (unsigned int d = 0; d < 2; d++)
   {
-    itkDebugMacro(<< "Warning: Error decoding run-length encoding." << std::endl);
-    if (index < VolumeSize)
+    spacing[d] = d < numberOfPlaneDimensions ? this->GetSpacing(d) : 1.0;
+    origin[d] = d < numberOfPlaneDimensions ? this->GetOrigin(d) : 0.0;
+    for (unsigned int i = 0; i < 2; i++)
     {
-      itkDebugMacro(<< "Warning: file underrun." << std::endl);
+      direction[i][d] = singular ? (i == d ? 1.0 : 0.0) : inPlane[i][d];
     }
-    else
+  }
+  std::vector<ProjectionImageType::Pointer> projections;
+  for (const unsigned char label : labels)
+  {
+    ProjectionImageType::Pointer projection = ProjectionImageType::New();
+    projection->SetRegions(size);
+    projection->SetSpacing(spacing);
+    projection->SetOrigin(origin);
+    projection->SetDirection(direction);
+    projection->Allocate();
+    unsigned char * out = projection->GetBufferPointer();
+    const std::uint64_t * bits = masks.data() + maskOfLabel[label] * WordsPerMask;
+    for (SizeValueType column = 0; column < PlaneSize; column++)
     {
-      itkDebugMacro(<< "Warning: file overrun." << std::endl);
+      out[column] = (bits[column / 64] >> (column % 64)) & 1;
     }
-    exit(-1);
+    projections.push_back(projection);
   }
+  return projections;
+}
 
-  this->m_InputFileStream.close();
-
-  // The following commented code will run through all of the values and write them to a file.
+bool
+AnalyzeObjectLabelMapImageIO::UpdatePlaneIndex()
+{
+  // The index stays valid as long as the same file is read and it has not changed on disk.
+  const SizeValueType fileLength = itksys::SystemTools::FileLength(m_FileName);
+  const long          modifiedTime = itksys::SystemTools::ModifiedTime(m_FileName);
+  if (!this->m_PlaneIndex.IsEmpty() && this->m_PlaneIndexFileName == m_FileName &&
+      this->m_PlaneIndexFileLength == fileLength && this->m_PlaneIndexModifiedTime == modifiedTime &&
+      this->m_PlaneIndex.GetPlaneOffset(0) == m_LocationOfFile)
+  {
+    return true;
+  }
 
-  //    std::ofstream check;
-  //    check.open("CheckBuffer.txt");
-  //    for(int i=0; i<VolumeSize;i++)
-  //    {
-  //      check<<(int)tobuf[i]<<std::endl;
-  //    }
-  //    check.close();
+  SizeValueType PlaneSize = this->GetDimensions(0);
+  if (this->GetNumberOfDimensions() > 1)
+  {
+    PlaneSize *= this->GetDimensions(1);
+  }
+  const SizeValueType NumberOfPlanes = this->GetImageSizeInPixels() / PlaneSize;
+  const std::string   sidecarFileName = m_FileName + AnalyzeObjectPlaneIndex::SidecarExtension;
+  if (this->m_UsePlaneIndexFile &&
+      this->m_PlaneIndex.Load(sidecarFileName, fileLength, modifiedTime, m_LocationOfFile, PlaneSize, NumberOfPlanes))
+  {
+    itkDebugMacro(<< "Loaded the plane index of " << m_FileName.c_str() << " from " << sidecarFileName.c_str());
+  }
+  else
+  {
+    std::ifstream inputFileStream;
+    inputFileStream.open(m_FileName.c_str(), std::ios::binary | std::ios::in);
+    if (!inputFileStream.is_open() ||
+        !this->m_PlaneIndex.Build(inputFileStream, m_LocationOfFile, PlaneSize, NumberOfPlanes))
+    {
+      this->m_PlaneIndexFileName.clear();
+      return false;
+    }
+    if (this->m_UsePlaneIndexFile && !this->m_PlaneIndex.Save(sidecarFileName, fileLength, modifiedTime))
+    {
+      itkDebugMacro(<< "Could not save the plane index of " << m_FileName.c_str() << " to " << sidecarFileName.c_str());
+    }
+  }
+  this->m_PlaneIndexFileName = m_FileName;
+  this->m_PlaneIndexFileLength = fileLength;
+  this->m_PlaneIndexModifiedTime = modifiedTime;
+  return true;
 }
 
 bool
@@ -271,64 +619,233 @@ AnalyzeObjectLabelMapImageIO::CanReadFile(const char * FileNameToRead)
     return false;
   }
 
+  // Wavefront meshes and other formats share the extension, so the first bytes must also hold a
+  // valid object map header.  It is kept for the ReadImageInformation() that usually follows.
+  if (!Self::SniffHeader(filename, this->m_SniffedHeader))
+  {
+    itkDebugMacro(<< filename.c_str() << " does not start with an Analyze object map header.");
+    this->m_SniffedFileName.clear();
+    return false;
+  }
+  this->m_SniffedFileName = filename;
   return true;
 }
 
-void
-AnalyzeObjectLabelMapImageIO::ReadImageInformation()
+bool
+AnalyzeObjectLabelMapImageIO::SniffHeader(const std::string & fileName, AnalyzeObjectMapHeaderRecord & record)
 {
-  m_ComponentType = IOComponentEnum::CHAR;
-  m_PixelType = IOPixelEnum::SCALAR;
-  // Opening the file
-  std::ifstream inputFileStream;
-  inputFileStream.open(m_FileName.c_str(), std::ios::binary | std::ios::in);
+  unsigned char bytes[AnalyzeObjectMapHeaderRecord::MaximumHeaderSizeInFile];
+  std::ifstream inputFileStream(fileName.c_str(), std::ios::binary | std::ios::in);
+  inputFileStream.read(reinterpret_cast<char *>(bytes), sizeof(bytes));
+  return record.Decode(bytes, static_cast<SizeValueType>(inputFileStream.gcount()), false);
+}
+
+bool
+AnalyzeObjectLabelMapImageIO::ProbeHeader(const std::string &            fileName,
+                                          AnalyzeObjectMapHeaderRecord & record,
+                                          bool                           readEntries)
+{
+  record.Valid = false;
+  record.Entries.clear();
+  std::ifstream inputFileStream(fileName.c_str(), std::ios::binary | std::ios::in);
   if (!inputFileStream.is_open())
   {
-    itkDebugMacro(<< "Error: Could not open: " << m_FileName.c_str() << std::endl);
-    exit(-1);
+    return false;
   }
 
-  // Reading the header, which contains the version number, the size, and the
-  // number of objects
-  bool NeedByteSwap = false;
+  // A single read covers the largest possible header and entry table, so that a probe costs one
+  // system call.  The buffer is kept by each thread for the next probe.
+  thread_local std::vector<unsigned char> headerBytes;
+  const SizeValueType entryTableSize =
+    readEntries ? AnalyzeObjectRunLengthCodec::MaximumNumberOfLabels * AnalyzeObjectEntryRecord::SizeInFile : 0;
+  headerBytes.resize(AnalyzeObjectMapHeaderRecord::MaximumHeaderSizeInFile + entryTableSize);
+  inputFileStream.read(reinterpret_cast<char *>(headerBytes.data()), headerBytes.size());
+  return record.Decode(headerBytes.data(), static_cast<SizeValueType>(inputFileStream.gcount()), readEntries);
+}
 
-  int header[6] = { 1 };
-  if (inputFileStream.read(reinterpret_cast<char *>(header), sizeof(int) * 5).fail())
+void
+AnalyzeObjectLabelMapImageIO::ProbeHeaders(const std::vector<std::string> &            fileNames,
+                                           std::vector<AnalyzeObjectMapHeaderRecord> & records,
+                                           bool                                        readEntries,
+                                           ThreadIdType                                numberOfThreads)
+{
+  records.resize(fileNames.size());
+  if (fileNames.empty())
   {
-    itkDebugMacro(<< "Error: Could not read header of " << m_FileName.c_str() << std::endl);
-    exit(-1);
+    return;
   }
-  // Do byte swapping if necessary.
-  if (header[0] == -1913442047 || header[0] == 1323699456) // Byte swapping needed (Number is byte swapped number of
-                                                           // VERSION7)
+  MultiThreaderBase::Pointer threader = MultiThreaderBase::New();
+  if (numberOfThreads > 0)
   {
-    NeedByteSwap = true;
-    // NOTE: All analyze object maps should be big endian on disk in order to be valid
-    //      The following function calls will swap the bytes when on little endian machines.
-    itk::ByteSwapper<int>::SwapFromSystemToBigEndian(&(header[0]));
-    itk::ByteSwapper<int>::SwapFromSystemToBigEndian(&(header[1]));
-    itk::ByteSwapper<int>::SwapFromSystemToBigEndian(&(header[2]));
-    itk::ByteSwapper<int>::SwapFromSystemToBigEndian(&(header[3]));
-    itk::ByteSwapper<int>::SwapFromSystemToBigEndian(&(header[4]));
+    threader->SetMaximumNumberOfThreads(numberOfThreads);
+    threader->SetNumberOfWorkUnits(numberOfThreads);
   }
+  threader->ParallelizeArray(
+    0,
+    fileNames.size(),
+    [&fileNames, &records, readEntries](SizeValueType i) { ProbeHeader(fileNames[i], records[i], readEntries); },
+    nullptr);
+}
 
-  bool NeedBlendFactor = false;
-  if (header[0] == VERSION7)
+void
+AnalyzeObjectLabelMapImageIO::SetComponentTypeToRead()
+{
+  switch (this->m_OutputComponentType)
   {
-    if ((inputFileStream.read(reinterpret_cast<char *>(&(header[5])), sizeof(int) * 1)).fail())
+    case IOComponentEnum::UCHAR:
+    case IOComponentEnum::CHAR:
+    case IOComponentEnum::USHORT:
+    case IOComponentEnum::SHORT:
+    case IOComponentEnum::UINT:
+    case IOComponentEnum::INT:
+    case IOComponentEnum::FLOAT:
+    case IOComponentEnum::DOUBLE:
+      m_ComponentType = this->m_OutputComponentType;
+      break;
+    default:
+      itkExceptionMacro(<< "Object maps cannot be decoded into "
+                        << ImageIOBase::GetComponentTypeAsString(this->m_OutputComponentType) << " pixels.");
+  }
+  m_PixelType = IOPixelEnum::SCALAR;
+}
+
+void
+AnalyzeObjectLabelMapImageIO::InvalidateDerivedData(const std::string & fileName)
+{
+  const std::string sidecarFileName = fileName + AnalyzeObjectPlaneIndex::SidecarExtension;
+  if (itksys::SystemTools::FileExists(sidecarFileName, true))
+  {
+    itksys::SystemTools::RemoveFile(sidecarFileName);
+  }
+  AnalyzeObjectMapCache::GetInstance().Remove(fileName);
+}
+
+void
+AnalyzeObjectLabelMapImageIO::ReadImageInformation()
+{
+  this->SetComponentTypeToRead();
+  this->m_CachedObjectMap = AnalyzeObjectMapCache::CachedObjectMap();
+  if (this->m_UseCache)
+  {
+    // The length and modification time are taken before the file is parsed, so that a change
+    // made while it is parsed leaves the cached map stale rather than wrong.
+    this->m_CachedObjectMap.FileLength = itksys::SystemTools::FileLength(m_FileName);
+    this->m_CachedObjectMap.ModifiedTime = itksys::SystemTools::ModifiedTime(m_FileName);
+    if (AnalyzeObjectMapCache::GetInstance().Find(m_FileName,
+                                                  this->m_CachedObjectMap.FileLength,
+                                                  this->m_CachedObjectMap.ModifiedTime,
+                                                  this->m_CachedObjectMap))
     {
-      itkDebugMacro(<< "Error: Could not read header of " << m_FileName.c_str() << std::endl);
-      exit(-1);
+      itkDebugMacro(<< "Found " << m_FileName.c_str() << " in the object map cache.");
+      this->m_SniffedFileName.clear();
+      this->SetImageInformationFromHeader(this->m_CachedObjectMap.Header.data());
+      m_LocationOfFile = this->m_CachedObjectMap.DataOffset;
+      if (this->m_UseEntryTable)
+      {
+        this->m_EntryTable.CopyFromEntryArray(this->m_CachedObjectMap.Entries);
+        this->SetLargestRegionAndEntries(this->m_EntryTable);
+      }
+      else
+      {
+        this->SetLargestRegionAndEntries(AnalyzeObjectMapCache::CopyEntries(this->m_CachedObjectMap.Entries));
+      }
+      return;
     }
+  }
+
+  // The header sniffed by CanReadFile() is used once, by the read that immediately follows it.
+  // The header record, the byte buffer and the entries are kept by the IO for the next file.
+  AnalyzeObjectMapHeaderRecord & headerRecord = this->m_HeaderRecord;
+  if (this->m_SniffedFileName == m_FileName)
+  {
+    headerRecord = this->m_SniffedHeader;
+  }
+  else if (!Self::SniffHeader(m_FileName, headerRecord))
+  {
+    itkExceptionMacro(<< "Error: " << m_FileName.c_str() << " is not an Analyze object map, or could not be read.");
+  }
+  this->m_SniffedFileName.clear();
+
+  // Opening the file
+  this->m_InputFileStream.open(m_FileName.c_str(), std::ios::binary | std::ios::in);
+  if (!this->m_InputFileStream.is_open())
+  {
+    this->m_InputFileStream.clear();
+    itkExceptionMacro(<< "Error: Could not open: " << m_FileName.c_str());
+  }
+  // All analyze object maps should be big endian on disk in order to be valid, but little endian
+  // files are read as well.  The header and the entry table are read with a single read and
+  // converted to native byte order in one pass.
+  std::vector<unsigned char> & headerBytes = this->m_HeaderBuffer;
+  headerBytes.resize(headerRecord.DataOffset);
+  const bool headerRead =
+    !this->m_InputFileStream.read(reinterpret_cast<char *>(headerBytes.data()), headerBytes.size()).fail();
+  this->m_InputFileStream.close();
+  this->m_InputFileStream.clear();
+  if (!headerRead || !headerRecord.Decode(headerBytes.data(), headerBytes.size(), true))
+  {
+    itkExceptionMacro(<< "Error: Could not read the object entries of " << m_FileName.c_str());
+  }
+  this->SetImageInformationFromHeaderRecord(this->m_UseCache);
+}
+
+void
+AnalyzeObjectLabelMapImageIO::ReadImageInformationFromMemory(const void * data, SizeValueType numberOfBytes)
+{
+  this->SetComponentTypeToRead();
+  this->m_CachedObjectMap = AnalyzeObjectMapCache::CachedObjectMap();
+  this->m_SniffedFileName.clear();
+  if (!AnalyzeObjectMapMemoryCodec::DecodeHeader(data, numberOfBytes, this->m_HeaderRecord))
+  {
+    itkExceptionMacro(<< "Error: The " << numberOfBytes
+                      << " bytes in memory do not start with an Analyze object map header and entry table.");
+  }
+  this->SetImageInformationFromHeaderRecord(false);
+}
+
+void
+AnalyzeObjectLabelMapImageIO::SetImageInformationFromHeaderRecord(bool cacheEntries)
+{
+  const AnalyzeObjectMapHeaderRecord & headerRecord = this->m_HeaderRecord;
+  const int header[6] = { headerRecord.Version,         headerRecord.Dimensions[0],
+                         headerRecord.Dimensions[1],   headerRecord.Dimensions[2],
+                         headerRecord.NumberOfObjects, headerRecord.Dimensions[3] };
+
+  this->SetImageInformationFromHeader(header);
+  m_LocationOfFile = static_cast<AnalyzeObjectPlaneIndex::OffsetType>(headerRecord.DataOffset);
+  if (cacheEntries)
+  {
+    // The voxels are added once Read() has decoded them.
+    std::copy(header, header + 6, this->m_CachedObjectMap.Header.begin());
+    this->m_CachedObjectMap.DataOffset = m_LocationOfFile;
+  }
 
-    if (NeedByteSwap)
+  if (this->m_UseEntryTable)
+  {
+    // The records are copied as they are, without creating any object.
+    this->m_EntryTable.GetRecords() = headerRecord.Entries;
+    if (cacheEntries)
     {
-      itk::ByteSwapper<int>::SwapFromSystemToBigEndian(&(header[5]));
+      this->m_EntryTable.CopyToEntryArray(this->m_CachedObjectMap.Entries);
     }
-    NeedBlendFactor = true;
+    this->SetLargestRegionAndEntries(this->m_EntryTable);
+    return;
   }
-  // Now the file pointer is pointing to the image region
 
+  // The entries of the previous file are dropped from the dictionary first.  Those that nobody
+  // else holds any more are then filled in again rather than allocated.
+  this->GetMetaDataDictionary().Erase(ANALYZE_OBJECT_LABEL_MAP_ENTRY_ARRAY);
+  AnalyzeObjectEntryTable::CopyRecordsToEntryArray(headerRecord.Entries, this->m_Entries);
+  if (cacheEntries)
+  {
+    this->m_CachedObjectMap.Entries = AnalyzeObjectMapCache::CopyEntries(this->m_Entries);
+  }
+  this->SetLargestRegionAndEntries(this->m_Entries);
+}
+
+void
+AnalyzeObjectLabelMapImageIO::SetImageInformationFromHeader(const int header[6])
+{
   if (header[5] > 1)
   {
     this->SetNumberOfDimensions(4);
@@ -427,34 +944,112 @@ AnalyzeObjectLabelMapImageIO::ReadImageInformation()
     this->SetDirection(2, dirz);
   }
 
-  // Error checking the number of objects in the object file
-  if ((header[4] < 1) || (header[4] > 256))
+  if (this->m_UseSiblingGeometry)
   {
-    itkDebugMacro(<< "Error: Invalid number of object files.\n");
-    inputFileStream.close();
-    exit(-1);
+    this->SetImageInformationFromSibling();
   }
+}
 
-  /*std::ofstream myfile;
-  myfile.open("ReadFromFilePointer35.txt", myfile.app);*/
-  itk::AnalyzeObjectEntryArrayType my_reference;
-  (my_reference).resize(header[4]);
-  for (int i = 0; i < header[4]; i++)
+void
+AnalyzeObjectLabelMapImageIO::SetImageInformationFromSibling()
+{
+  AnalyzeObjectSiblingGeometry::Geometry geometry;
+  if (!AnalyzeObjectSiblingGeometry::GetInstance().Find(m_FileName, geometry))
   {
-    // Allocating a object to be created
-    (my_reference)[i] = AnalyzeObjectEntry::New();
-    (my_reference)[i]->ReadFromFilePointer(inputFileStream, NeedByteSwap, NeedBlendFactor);
-    // (*my_reference)[i]->Print(myfile);
+    itkDebugMacro(<< "No image with the geometry of " << m_FileName.c_str() << " was found.");
+    return;
   }
-  // myfile.close();
-  m_LocationOfFile = inputFileStream.tellg();
-  inputFileStream.close();
+
+  // The object map and its sibling may not have the same number of dimensions, but every axis
+  // either of them has must have the same size, taken as one where it is missing.
+  const unsigned int numberOfDimensions = this->GetNumberOfDimensions();
+  for (SizeValueType d = 0; d < std::max<SizeValueType>(numberOfDimensions, geometry.GetNumberOfDimensions()); d++)
+  {
+    const SizeValueType size = d < numberOfDimensions ? this->GetDimensions(d) : 1;
+    const SizeValueType siblingSize = d < geometry.GetNumberOfDimensions() ? geometry.Size[d] : 1;
+    if (size != siblingSize)
+    {
+      itkDebugMacro(<< "The size of " << geometry.FileName.c_str() << " differs from that of " << m_FileName.c_str());
+      return;
+    }
+  }
+  itkDebugMacro(<< "Taking the geometry of " << m_FileName.c_str() << " from " << geometry.FileName.c_str());
+
+  // The shared axes take the geometry of the sibling, the others keep their defaults.
+  const unsigned int numberOfSharedDimensions =
+    std::min(numberOfDimensions, static_cast<unsigned int>(geometry.GetNumberOfDimensions()));
+  for (unsigned int d = 0; d < numberOfSharedDimensions; d++)
+  {
+    this->SetSpacing(d, geometry.Spacing[d]);
+    this->SetOrigin(d, geometry.Origin[d]);
+    std::vector<double> direction(numberOfDimensions, 0.0);
+    for (unsigned int i = 0; i < numberOfSharedDimensions; i++)
+    {
+      direction[i] = geometry.Direction[d][i];
+    }
+    this->SetDirection(d, direction);
+  }
+}
+
+void
+AnalyzeObjectLabelMapImageIO::SetLargestRegionAndEntries(const AnalyzeObjectEntryArrayType & my_reference)
+{
+  this->SetLargestRegion();
   // Now fill out the MetaData
   MetaDataDictionary & thisDic = this->GetMetaDataDictionary();
-  EncapsulateMetaData<std::string>(thisDic, ITK_OnDiskStorageTypeName, std::string(typeid(unsigned char).name()));
+  thisDic.Erase(ANALYZE_OBJECT_LABEL_MAP_ENTRY_TABLE);
   EncapsulateMetaData<itk::AnalyzeObjectEntryArrayType>(thisDic, ANALYZE_OBJECT_LABEL_MAP_ENTRY_ARRAY, my_reference);
 }
 
+void
+AnalyzeObjectLabelMapImageIO::SetLargestRegionAndEntries(const AnalyzeObjectEntryTable & table)
+{
+  this->SetLargestRegion();
+  MetaDataDictionary & thisDic = this->GetMetaDataDictionary();
+  thisDic.Erase(ANALYZE_OBJECT_LABEL_MAP_ENTRY_ARRAY);
+  EncapsulateMetaData<AnalyzeObjectEntryTable>(thisDic, ANALYZE_OBJECT_LABEL_MAP_ENTRY_TABLE, table);
+}
+
+void
+AnalyzeObjectLabelMapImageIO::SetLargestRegion()
+{
+  // Until another region is requested the whole image is read.
+  ImageIORegion largestRegion(this->GetNumberOfDimensions());
+  for (unsigned int d = 0; d < this->GetNumberOfDimensions(); d++)
+  {
+    largestRegion.SetSize(d, this->GetDimensions(d));
+  }
+  this->SetIORegion(largestRegion);
+  EncapsulateMetaData<std::string>(
+    this->GetMetaDataDictionary(), ITK_OnDiskStorageTypeName, std::string(typeid(unsigned char).name()));
+}
+
+AnalyzeObjectMapCache::VoxelContainerType::ConstPointer
+AnalyzeObjectLabelMapImageIO::ReadSharedVoxels()
+{
+  if (!this->m_UseCache || this->m_CachedObjectMap.Entries.empty())
+  {
+    itkExceptionMacro(<< "The voxels of " << m_FileName.c_str()
+                      << " can only be shared once ReadImageInformation() was called with UseCache on.");
+  }
+  this->UpdateCachedVoxels();
+  return this->m_CachedObjectMap.Voxels;
+}
+
+void
+AnalyzeObjectLabelMapImageIO::UpdateCachedVoxels()
+{
+  if (this->m_CachedObjectMap.Voxels.IsNotNull())
+  {
+    return;
+  }
+  AnalyzeObjectMapCache::VoxelContainerType::Pointer voxels = AnalyzeObjectMapCache::VoxelContainerType::New();
+  voxels->Reserve(this->GetImageSizeInPixels());
+  this->DecodeRunLengthData(voxels->GetBufferPointer());
+  this->m_CachedObjectMap.Voxels = voxels.GetPointer();
+  AnalyzeObjectMapCache::GetInstance().Insert(m_FileName, this->m_CachedObjectMap);
+}
+
 /**
  *
  */
@@ -462,246 +1057,402 @@ void
 AnalyzeObjectLabelMapImageIO ::WriteImageInformation()
 {
   itkDebugMacro(<< "I am in the writeimageinformaton" << std::endl);
-  std::string tempfilename = this->GetFileName();
-  // Opening the file
-  std::ofstream outputFileStream;
-  outputFileStream.open(tempfilename.c_str(), std::ios::binary | std::ios::out | std::ios::trunc);
-  if (!outputFileStream.is_open())
+  // An atomic write replaces the file whole in Write(); the file is not touched before.
+  if (this->m_UseAtomicWrite)
+  {
+    return;
+  }
+  this->GetEntryRecordsToWrite(this->m_HeaderRecord.Entries);
+  this->WriteHeaderAndEntryTable();
+}
+
+bool
+AnalyzeObjectLabelMapImageIO::GetEntryRecordsFromMetaData(AnalyzeObjectEntryTable::RecordContainerType & records)
+{
+  // A table is copied record by record; an entry array is converted without changing its entries.
+  const MetaDataDictionary & thisDic = this->GetMetaDataDictionary();
+  const auto * table = dynamic_cast<const MetaDataObject<AnalyzeObjectEntryTable> *>(
+    thisDic.HasKey(ANALYZE_OBJECT_LABEL_MAP_ENTRY_TABLE) ? thisDic.Get(ANALYZE_OBJECT_LABEL_MAP_ENTRY_TABLE) : nullptr);
+  if (table != nullptr)
   {
-    itkDebugMacro(<< "Error: Could not open " << tempfilename.c_str() << std::endl);
-    exit(-1);
+    records = table->GetMetaDataObjectValue().GetRecords();
+    return true;
+  }
+  const auto * entries = dynamic_cast<const MetaDataObject<AnalyzeObjectEntryArrayType> *>(
+    thisDic.HasKey(ANALYZE_OBJECT_LABEL_MAP_ENTRY_ARRAY) ? thisDic.Get(ANALYZE_OBJECT_LABEL_MAP_ENTRY_ARRAY) : nullptr);
+  if (entries != nullptr)
+  {
+    const AnalyzeObjectEntryArrayType & my_reference = entries->GetMetaDataObjectValue();
+    records.resize(my_reference.size());
+    for (unsigned int i = 0; i < my_reference.size(); i++)
+    {
+      my_reference[i]->CopyToRecord(records[i]);
+    }
+    return true;
   }
-  itk::AnalyzeObjectEntryArrayType my_reference;
+  records.clear();
+  return false;
+}
 
-  int header[6] = { 1, 1, 1, 1, 1, 1 };
-  header[0] = VERSION7;
+void
+AnalyzeObjectLabelMapImageIO::GetEntryRecordsToWrite(AnalyzeObjectEntryTable::RecordContainerType & records)
+{
+  if (!this->GetEntryRecordsFromMetaData(records))
+  {
+    // Images without entries, which is the case of most label images, get 256 blank entries.
+    records.assign(256, AnalyzeObjectEntryTable::GetDefaultRecord());
+    for (auto & record : records)
+    {
+      AnalyzeObjectEntryTable::EntryView(&record).SetName("Blank Object");
+    }
+  }
+}
+
+void
+AnalyzeObjectLabelMapImageIO::UpdateHeaderRecordToWrite()
+{
+  AnalyzeObjectMapHeaderRecord & headerRecord = this->m_HeaderRecord;
+  headerRecord.Version = VERSION7;
+  std::fill(headerRecord.Dimensions, headerRecord.Dimensions + 4, 1);
 
   switch (this->GetNumberOfDimensions())
   {
     case 4:
     {
-      header[5] = this->GetDimensions(3);
+      headerRecord.Dimensions[3] = this->GetDimensions(3);
     }
     case 3:
     {
-      header[3] = this->GetDimensions(2);
+      headerRecord.Dimensions[2] = this->GetDimensions(2);
     }
     case 2:
     {
-      header[2] = this->GetDimensions(1);
+      headerRecord.Dimensions[1] = this->GetDimensions(1);
     }
     case 1:
     {
-      header[1] = this->GetDimensions(0);
+      headerRecord.Dimensions[0] = this->GetDimensions(0);
     }
     break;
     default:
-      itkDebugMacro(<< "There is an error in writing the header for the Dimensions");
-      exit(-1);
+      itkExceptionMacro(<< "Error: An object map has 1 to 4 dimensions, not " << this->GetNumberOfDimensions());
   }
 
-  bool MetaDataCheck = itk::ExposeMetaData<itk::AnalyzeObjectEntryArrayType>(
-    this->GetMetaDataDictionary(), ANALYZE_OBJECT_LABEL_MAP_ENTRY_ARRAY, my_reference);
-  if (MetaDataCheck)
+  // Error checking the number of objects in the object file
+  if (headerRecord.Entries.size() > 256)
   {
-    header[4] = my_reference.size();
+    itkExceptionMacro(<< "Error: An object map holds at most 256 objects, not " << headerRecord.Entries.size());
   }
-  else
+
+  // Since the NumberOfObjects does not reflect the background, the background will be included.
+  // The entries were copied into plain records, so that encoding them never changes the entries.
+}
+
+void
+AnalyzeObjectLabelMapImageIO::WriteHeaderAndEntryTable(const unsigned char * runLengthBytes,
+                                                       SizeValueType         numberOfRunLengthBytes)
+{
+  std::string tempfilename = this->GetFileName();
+  InvalidateDerivedData(tempfilename);
+  this->m_PlaneIndex.Clear();
+  this->m_PlaneIndexFileName.clear();
+
+  // All object maps are written in BigEndian format as required by the AnalyzeObjectMap
+  // documentation.  The header and the entries are written with a single write, followed by the
+  // run length encoded data when there is some.
+  std::vector<unsigned char> & headerBytes = this->m_HeaderBuffer;
+  this->UpdateHeaderRecordToWrite();
+  this->m_HeaderRecord.Encode(headerBytes, true);
+  if (this->m_UseAtomicWrite)
   {
-    header[4] = 256;
+    AnalyzeObjectMapAtomicWriter writer;
+    writer.Open(tempfilename, headerBytes.size() + numberOfRunLengthBytes);
+    writer.Write(headerBytes.data(), headerBytes.size());
+    writer.Write(runLengthBytes, numberOfRunLengthBytes);
+    writer.Commit(this->m_UseSynchronousWrite);
+    InvalidateDerivedData(tempfilename);
+    return;
   }
 
-  // All object maps are written in BigEndian format as required by the AnalyzeObjectMap documentation.
-  bool NeedByteSwap = itk::ByteSwapper<int>::SystemIsLittleEndian();
-  if (NeedByteSwap)
+  // Opening the file
+  std::ofstream & outputFileStream = this->m_OutputFileStream;
+  outputFileStream.clear();
+  outputFileStream.open(tempfilename.c_str(), std::ios::binary | std::ios::out | std::ios::trunc);
+  if (!outputFileStream.is_open())
   {
-    itk::ByteSwapper<int>::SwapFromSystemToBigEndian(&(header[0]));
-    itk::ByteSwapper<int>::SwapFromSystemToBigEndian(&(header[1]));
-    itk::ByteSwapper<int>::SwapFromSystemToBigEndian(&(header[2]));
-    itk::ByteSwapper<int>::SwapFromSystemToBigEndian(&(header[3]));
-    itk::ByteSwapper<int>::SwapFromSystemToBigEndian(&(header[4]));
-    itk::ByteSwapper<int>::SwapFromSystemToBigEndian(&(header[5]));
+    itkExceptionMacro(<< "Error: Could not open " << tempfilename.c_str());
   }
-
-  // Writing the header, which contains the version number, the size, and the
-  // number of objects
-  if (outputFileStream.write(reinterpret_cast<char *>(header), sizeof(int) * 6).fail())
+  if (outputFileStream.write(reinterpret_cast<const char *>(headerBytes.data()), headerBytes.size()).fail() ||
+      (numberOfRunLengthBytes > 0 &&
+       outputFileStream.write(reinterpret_cast<const char *>(runLengthBytes), numberOfRunLengthBytes).fail()))
   {
-    itkDebugMacro(<< "Error: Could not write header of " << tempfilename.c_str() << std::endl);
-    exit(-1);
+    outputFileStream.close();
+    outputFileStream.clear();
+    itkExceptionMacro(<< "Error: Could not write " << tempfilename.c_str());
   }
 
-  // Error checking the number of objects in the object file
-  if (my_reference.size() > 256)
+  outputFileStream.close();
+  if (outputFileStream.fail())
   {
-    itkDebugMacro(<< "Error: Invalid number of object files.\n");
-    outputFileStream.close();
+    outputFileStream.clear();
+    itkExceptionMacro(<< "Error: Could not write " << tempfilename.c_str());
   }
+}
 
-  if (MetaDataCheck)
+template <typename TPixel>
+void
+AnalyzeObjectLabelMapImageIO::EncodeRunLengthBuffer(const TPixel *                            buffer,
+                                                    AnalyzeObjectRunLengthCodec::BufferType & runLengthBuffer)
+{
+  // Runs restart at the beginning of every plane of data.
+  const SizeValueType VolumeSize = this->GetImageSizeInPixels();
+  SizeValueType       PlaneSize = this->GetDimensions(0);
+  if (this->GetNumberOfDimensions() > 1)
   {
-    // Since the NumberOfObjects does not reflect the background, the background will be included
-    for (auto & i : my_reference)
-    {
-      // Using a temporary so that the object file is always written in BIG_ENDIAN mode but does
-      // not affect the current object itself
-      AnalyzeObjectEntry * ObjectWrite = i;
-      if (NeedByteSwap == true)
-      {
-        ObjectWrite->SwapObjectEndedness();
-      }
-      ObjectWrite->Write(outputFileStream);
-    }
+    PlaneSize *= this->GetDimensions(1);
   }
-  else
+
+  this->m_LabelCompactionTable.clear();
+  runLengthBuffer.clear();
+  if (AnalyzeObjectRunLengthCodec::EncodeVolume(buffer, VolumeSize, PlaneSize, runLengthBuffer))
   {
-    for (unsigned int i = 0; i < 256; i++)
-    {
-      // Using a temporary so that the object file is always written in BIG_ENDIAN mode but does
-      // not affect the current object itself
-      AnalyzeObjectEntry::Pointer ObjectWrite = AnalyzeObjectEntry::New();
-      ObjectWrite->SetName("Blank Object");
-      if (NeedByteSwap == true)
-      {
-        ObjectWrite->SwapObjectEndedness();
-      }
-      ObjectWrite->Write(outputFileStream);
-    }
+    return;
   }
 
-  outputFileStream.close();
+  // Some value does not fit into an unsigned char.  Only in that case is a second pass over the
+  // image made to collect the labels that are actually used.
+  if (!this->m_UseLabelCompaction)
+  {
+    itkExceptionMacro(<< "Label values must lie in [0,255] to be written to " << this->GetFileName()
+                      << "; turn UseLabelCompaction on to remap them.");
+  }
+  if (!AnalyzeObjectRunLengthCodec::BuildLabelCompactionTable(buffer, VolumeSize, this->m_LabelCompactionTable))
+  {
+    this->m_LabelCompactionTable.clear();
+    itkExceptionMacro(<< "An object map can hold at most " << AnalyzeObjectRunLengthCodec::MaximumNumberOfLabels
+                      << " labels, each of which must fit into a long long, but the image written to "
+                      << this->GetFileName() << " does not.");
+  }
+  runLengthBuffer.clear();
+  AnalyzeObjectRunLengthCodec::EncodeVolume(
+    buffer, VolumeSize, PlaneSize, this->m_LabelCompactionTable, runLengthBuffer);
 }
 
-/**
- *
- */
-void
-AnalyzeObjectLabelMapImageIO
-
-  ::Write(const void * buffer)
+template <typename TPixel>
+SizeValueType
+AnalyzeObjectLabelMapImageIO::CountRunLengthBytes(const TPixel *  buffer,
+                                                  ThreadIdType    numberOfThreads,
+                                                  SizeValueType & numberOfEntries)
 {
-  if (this->GetComponentType() != IOComponentEnum::UCHAR)
+  const SizeValueType VolumeSize = this->GetImageSizeInPixels();
+  SizeValueType       PlaneSize = this->GetDimensions(0);
+  if (this->GetNumberOfDimensions() > 1)
   {
-    std::cerr << "Error: The pixel type needs to be an unsigned char." << std::endl;
-    exit(-1);
+    PlaneSize *= this->GetDimensions(1);
   }
-  this->WriteImageInformation();
-  std::string tempfilename = this->GetFileName();
-  // Opening the file
-  std::ofstream outputFileStream;
-  outputFileStream.open(tempfilename.c_str(), std::ios::binary | std::ios::out | std::ios::app);
-  if (!outputFileStream.is_open())
+  const SizeValueType NumberOfPlanes = PlaneSize > 0 ? VolumeSize / PlaneSize : 0;
+
+  // Runs never cross a plane, so the planes are split in contiguous chunks, each counted by one
+  // thread.
+  if (numberOfThreads == 0)
   {
-    itkDebugMacro(<< "Error: Could not open " << tempfilename.c_str() << std::endl);
-    exit(-1);
+    numberOfThreads = MultiThreaderBase::GetGlobalDefaultNumberOfThreads();
   }
-  itk::AnalyzeObjectEntryArrayType my_reference;
-  itk::ExposeMetaData<itk::AnalyzeObjectEntryArrayType>(
-    this->GetMetaDataDictionary(), ANALYZE_OBJECT_LABEL_MAP_ENTRY_ARRAY, my_reference);
-
-  // Encoding the run length encoded raw data into an unsigned char volume
-  int VolumeSize;
-  if (this->GetNumberOfDimensions() > 3)
+  const SizeValueType numberOfChunks =
+    std::max<SizeValueType>(1, std::min<SizeValueType>(numberOfThreads, NumberOfPlanes));
+  std::vector<SizeValueType> chunkBytes(numberOfChunks, 0);
+  std::vector<char>          chunkInRange(numberOfChunks, 1);
+  const auto                 countChunk = [&](SizeValueType chunk) {
+    const SizeValueType first = chunk * NumberOfPlanes / numberOfChunks * PlaneSize;
+    const SizeValueType last = (chunk + 1) * NumberOfPlanes / numberOfChunks * PlaneSize;
+    bool                inRange = true;
+    chunkBytes[chunk] = AnalyzeObjectRunLengthCodec::CountRunBytes(buffer + first, last - first, PlaneSize, inRange);
+    chunkInRange[chunk] = inRange;
+  };
+  if (numberOfChunks == 1)
   {
-    VolumeSize = this->GetDimensions(0) * this->GetDimensions(1) * this->GetDimensions(2) * this->GetDimensions(3);
+    countChunk(0);
   }
-  else if (this->GetNumberOfDimensions() == 3)
+  else
   {
-    VolumeSize = this->GetDimensions(0) * this->GetDimensions(1) * this->GetDimensions(2);
+    MultiThreaderBase::Pointer threader = MultiThreaderBase::New();
+    threader->SetMaximumNumberOfThreads(numberOfThreads);
+    threader->SetNumberOfWorkUnits(numberOfThreads);
+    threader->ParallelizeArray(0, numberOfChunks, countChunk, nullptr);
   }
-  else if (this->GetNumberOfDimensions() == 2)
+  const SizeValueType numberOfRunLengthBytes =
+    std::accumulate(chunkBytes.begin(), chunkBytes.end(), SizeValueType{ 0 });
+
+  // As in EncodeRunLengthBuffer(), the labels are only collected when some value does not fit into
+  // an unsigned char; Write() then writes an entry per label.
+  if (std::all_of(chunkInRange.begin(), chunkInRange.end(), [](char inRange) { return inRange != 0; }))
   {
-    VolumeSize = this->GetDimensions(0) * this->GetDimensions(1);
+    this->GetEntryRecordsToWrite(this->m_EntryRecordsToWrite);
+    numberOfEntries = this->m_EntryRecordsToWrite.size();
+    return numberOfRunLengthBytes;
   }
-  else
+  if (!this->m_UseLabelCompaction)
   {
-    VolumeSize = this->GetDimensions(0);
+    itkExceptionMacro(<< "Label values must lie in [0,255] to be written to " << this->GetFileName()
+                      << "; turn UseLabelCompaction on to remap them.");
   }
-  int PlaneSize;
-  if (this->GetNumberOfDimensions() > 1)
+  LabelCompactionTableType table;
+  if (!AnalyzeObjectRunLengthCodec::BuildLabelCompactionTable(buffer, VolumeSize, table))
   {
-    PlaneSize = this->GetDimensions(0) * this->GetDimensions(1);
+    itkExceptionMacro(<< "An object map can hold at most " << AnalyzeObjectRunLengthCodec::MaximumNumberOfLabels
+                      << " labels, each of which must fit into a long long, but the image written to "
+                      << this->GetFileName() << " does not.");
   }
-  else
+  numberOfEntries = table.size();
+  return numberOfRunLengthBytes;
+}
+
+SizeValueType
+AnalyzeObjectLabelMapImageIO::ComputeEncodedSizeInBytes(const void * buffer, ThreadIdType numberOfThreads)
+{
+  SizeValueType numberOfEntries = 0;
+  SizeValueType numberOfRunLengthBytes = 0;
+  switch (this->GetComponentType())
+  {
+    case IOComponentEnum::UCHAR:
+      numberOfRunLengthBytes =
+        this->CountRunLengthBytes(static_cast<const unsigned char *>(buffer), numberOfThreads, numberOfEntries);
+      break;
+    case IOComponentEnum::CHAR:
+      numberOfRunLengthBytes =
+        this->CountRunLengthBytes(static_cast<const char *>(buffer), numberOfThreads, numberOfEntries);
+      break;
+    case IOComponentEnum::USHORT:
+      numberOfRunLengthBytes =
+        this->CountRunLengthBytes(static_cast<const unsigned short *>(buffer), numberOfThreads, numberOfEntries);
+      break;
+    case IOComponentEnum::SHORT:
+      numberOfRunLengthBytes =
+        this->CountRunLengthBytes(static_cast<const short *>(buffer), numberOfThreads, numberOfEntries);
+      break;
+    case IOComponentEnum::UINT:
+      numberOfRunLengthBytes =
+        this->CountRunLengthBytes(static_cast<const unsigned int *>(buffer), numberOfThreads, numberOfEntries);
+      break;
+    case IOComponentEnum::INT:
+      numberOfRunLengthBytes =
+        this->CountRunLengthBytes(static_cast<const int *>(buffer), numberOfThreads, numberOfEntries);
+      break;
+    case IOComponentEnum::ULONG:
+      numberOfRunLengthBytes =
+        this->CountRunLengthBytes(static_cast<const unsigned long *>(buffer), numberOfThreads, numberOfEntries);
+      break;
+    case IOComponentEnum::LONG:
+      numberOfRunLengthBytes =
+        this->CountRunLengthBytes(static_cast<const long *>(buffer), numberOfThreads, numberOfEntries);
+      break;
+    case IOComponentEnum::ULONGLONG:
+      numberOfRunLengthBytes =
+        this->CountRunLengthBytes(static_cast<const unsigned long long *>(buffer), numberOfThreads, numberOfEntries);
+      break;
+    case IOComponentEnum::LONGLONG:
+      numberOfRunLengthBytes =
+        this->CountRunLengthBytes(static_cast<const long long *>(buffer), numberOfThreads, numberOfEntries);
+      break;
+    default:
+      itkExceptionMacro(<< "The pixel type needs to be an integer type, not "
+                        << ImageIOBase::GetComponentTypeAsString(this->GetComponentType()));
+  }
+  // Write() always writes a VERSION7 header.
+  return AnalyzeObjectMapHeaderRecord::MaximumHeaderSizeInFile +
+         numberOfEntries * AnalyzeObjectEntryRecord::SizeInFile + numberOfRunLengthBytes;
+}
+
+void
+AnalyzeObjectLabelMapImageIO::EncodeImageBuffer(const void * buffer)
+{
+  // The run length buffer is kept for the next call, so that writing many files of about the same
+  // size allocates it once.
+  AnalyzeObjectRunLengthCodec::BufferType & runLengthBuffer = this->m_RunLengthBuffer;
+  switch (this->GetComponentType())
   {
-    PlaneSize = this->GetDimensions(0);
+    case IOComponentEnum::UCHAR:
+      this->EncodeRunLengthBuffer(static_cast<const unsigned char *>(buffer), runLengthBuffer);
+      break;
+    case IOComponentEnum::CHAR:
+      this->EncodeRunLengthBuffer(static_cast<const char *>(buffer), runLengthBuffer);
+      break;
+    case IOComponentEnum::USHORT:
+      this->EncodeRunLengthBuffer(static_cast<const unsigned short *>(buffer), runLengthBuffer);
+      break;
+    case IOComponentEnum::SHORT:
+      this->EncodeRunLengthBuffer(static_cast<const short *>(buffer), runLengthBuffer);
+      break;
+    case IOComponentEnum::UINT:
+      this->EncodeRunLengthBuffer(static_cast<const unsigned int *>(buffer), runLengthBuffer);
+      break;
+    case IOComponentEnum::INT:
+      this->EncodeRunLengthBuffer(static_cast<const int *>(buffer), runLengthBuffer);
+      break;
+    case IOComponentEnum::ULONG:
+      this->EncodeRunLengthBuffer(static_cast<const unsigned long *>(buffer), runLengthBuffer);
+      break;
+    case IOComponentEnum::LONG:
+      this->EncodeRunLengthBuffer(static_cast<const long *>(buffer), runLengthBuffer);
+      break;
+    case IOComponentEnum::ULONGLONG:
+      this->EncodeRunLengthBuffer(static_cast<const unsigned long long *>(buffer), runLengthBuffer);
+      break;
+    case IOComponentEnum::LONGLONG:
+      this->EncodeRunLengthBuffer(static_cast<const long long *>(buffer), runLengthBuffer);
+      break;
+    default:
+      itkExceptionMacro(<< "The pixel type needs to be an integer type, not "
+                        << ImageIOBase::GetComponentTypeAsString(this->GetComponentType()));
   }
-  int           bufferindex = 0;
-  int           planeindex = 0;
-  int           runlength = 0;
-  unsigned char CurrentObjIndex = 0;
-  constexpr int buffer_size = 16384; // NOTE: This is probably overkill, but it will work
-  unsigned char bufferObjectMap[buffer_size] = { 0 };
 
-  auto * bufferChar = (unsigned char *)buffer;
-  for (int i = 0; i < VolumeSize; i++)
+  if (this->m_LabelCompactionTable.empty())
   {
-    if (runlength == 0)
-    {
-      CurrentObjIndex = bufferChar[i];
-      runlength = 1;
-    }
-    else
+    this->GetEntryRecordsToWrite(this->m_HeaderRecord.Entries);
+  }
+  else
+  {
+    // Entries of the compacted labels are taken from the original entry table where the original
+    // value indexes it, otherwise a new entry is named after the original value.
+    const AnalyzeObjectEntryTable::RecordContainerType & my_reference = this->m_EntryRecordsToWrite;
+    this->GetEntryRecordsFromMetaData(this->m_EntryRecordsToWrite);
+    AnalyzeObjectEntryTable::RecordContainerType & compactedEntries = this->m_HeaderRecord.Entries;
+    compactedEntries.resize(this->m_LabelCompactionTable.size());
+    for (unsigned int i = 0; i < compactedEntries.size(); i++)
     {
-      if (CurrentObjIndex == bufferChar[i])
+      const long long value = this->m_LabelCompactionTable[i];
+      if (value >= 0 && value < static_cast<long long>(my_reference.size()))
       {
-        runlength++;
-        if (runlength == 255)
-        {
-          bufferObjectMap[bufferindex] = runlength;
-          bufferObjectMap[bufferindex + 1] = CurrentObjIndex;
-          bufferindex += 2;
-          runlength = 0;
-        }
+        compactedEntries[i] = my_reference[value];
       }
       else
       {
-        bufferObjectMap[bufferindex] = runlength;
-        bufferObjectMap[bufferindex + 1] = CurrentObjIndex;
-        bufferindex += 2;
-        CurrentObjIndex = bufferChar[i];
-        runlength = 1;
-      }
-    }
-
-    planeindex++;
-    if (planeindex == PlaneSize)
-    {
-      // Just finished with a plane of data, so encode it
-      planeindex = 0;
-      if (runlength != 0)
-      {
-        bufferObjectMap[bufferindex] = runlength;
-        bufferObjectMap[bufferindex + 1] = CurrentObjIndex;
-        bufferindex += 2;
-        runlength = 0;
-      }
-    }
-    if (bufferindex == buffer_size)
-    {
-      // buffer full
-      if (outputFileStream.write(reinterpret_cast<char *>(bufferObjectMap), buffer_size).fail())
-      {
-        itkDebugMacro(<< "error: could not write buffer" << std::endl);
-        exit(-1);
+        compactedEntries[i] = AnalyzeObjectEntryTable::GetDefaultRecord();
+        AnalyzeObjectEntryTable::EntryView(&compactedEntries[i]).SetName("Label " + std::to_string(value));
       }
-      bufferindex = 0;
-    }
-  }
-  if (bufferindex != 0)
-  {
-    if (runlength != 0)
-    {
-      bufferObjectMap[bufferindex] = runlength;
-      bufferObjectMap[bufferindex + 1] = CurrentObjIndex;
-      bufferindex += 2;
-    }
-    if (outputFileStream.write(reinterpret_cast<char *>(bufferObjectMap), bufferindex).fail())
-    {
-      itkDebugMacro(<< "error: could not write buffer" << std::endl);
-      exit(-1);
     }
   }
 }
 
+/**
+ *
+ */
+void
+AnalyzeObjectLabelMapImageIO ::Write(const void * buffer)
+{
+  this->EncodeImageBuffer(buffer);
+  this->WriteHeaderAndEntryTable(this->m_RunLengthBuffer.data(), this->m_RunLengthBuffer.size());
+}
+
+void
+AnalyzeObjectLabelMapImageIO::WriteToMemory(const void * buffer, AnalyzeObjectRunLengthCodec::BufferType & output)
+{
+  // The image is encoded as by Write(); the header and the entries are then encoded into output,
+  // and the runs appended after them.
+  this->EncodeImageBuffer(buffer);
+  this->UpdateHeaderRecordToWrite();
+  this->m_HeaderRecord.Encode(output, true);
+  output.insert(output.end(), this->m_RunLengthBuffer.begin(), this->m_RunLengthBuffer.end());
+}
+
 } // end namespace itk
@@ -0,0 +1,67 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkAnalyzeObjectLabelMapImageIOPool.h"
+
+namespace itk
+{
+
+auto
+AnalyzeObjectLabelMapImageIOPool::Acquire() -> ImageIOPointer
+{
+  {
+    const std::lock_guard<std::mutex> lock(this->m_Mutex);
+    if (!this->m_IdleImageIOs.empty())
+    {
+      ImageIOPointer imageIO = this->m_IdleImageIOs.back();
+      this->m_IdleImageIOs.pop_back();
+      return imageIO;
+    }
+  }
+  return ImageIOType::New();
+}
+
+void
+AnalyzeObjectLabelMapImageIOPool::Release(ImageIOType * imageIO)
+{
+  if (imageIO == nullptr)
+  {
+    return;
+  }
+  imageIO->SetMetaDataDictionary(MetaDataDictionary());
+  const std::lock_guard<std::mutex> lock(this->m_Mutex);
+  this->m_IdleImageIOs.push_back(imageIO);
+}
+
+SizeValueType
+AnalyzeObjectLabelMapImageIOPool::GetNumberOfIdleImageIOs() const
+{
+  const std::lock_guard<std::mutex> lock(this->m_Mutex);
+  return this->m_IdleImageIOs.size();
+}
+
+void
+AnalyzeObjectLabelMapImageIOPool::Clear()
+{
+  std::vector<ImageIOPointer> idleImageIOs;
+  {
+    const std::lock_guard<std::mutex> lock(this->m_Mutex);
+    idleImageIOs.swap(this->m_IdleImageIOs);
+  }
+}
+
+} // end namespace itk
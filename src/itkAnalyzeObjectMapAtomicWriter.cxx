@@ -0,0 +1,203 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkAnalyzeObjectMapAtomicWriter.h"
+#include "itksys/SystemTools.hxx"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+#if defined(_WIN32)
+#  include <io.h>
+#  include <process.h>
+#else
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
+
+namespace itk
+{
+namespace
+{
+// Allocates the first size bytes of file on the disk, where the system can, so that a full disk is
+// found before anything is written.  Returns 0 or an errno value.
+int
+PreallocateFile(std::FILE * file, SizeValueType size)
+{
+#if defined(_POSIX_ADVISORY_INFO) && _POSIX_ADVISORY_INFO > 0
+  const int error = posix_fallocate(fileno(file), 0, static_cast<off_t>(size));
+  // Some file systems cannot preallocate; the file is then written without.
+  return error == EINVAL || error == EOPNOTSUPP ? 0 : error;
+#else
+  (void)file;
+  (void)size;
+  return 0;
+#endif
+}
+
+// Flushes file to the disk.  Returns false on failure.
+bool
+SynchronizeFile(std::FILE * file)
+{
+  if (std::fflush(file) != 0)
+  {
+    return false;
+  }
+#if defined(_WIN32)
+  return _commit(_fileno(file)) == 0;
+#else
+  return fsync(fileno(file)) == 0;
+#endif
+}
+
+// Flushes the entry of a file renamed into directory to the disk.  Systems that cannot open a
+// directory have nothing to flush.
+void
+SynchronizeDirectory(const std::string & directory)
+{
+#if !defined(_WIN32)
+  const int descriptor = open(directory.empty() ? "." : directory.c_str(), O_RDONLY);
+  if (descriptor >= 0)
+  {
+    fsync(descriptor);
+    close(descriptor);
+  }
+#else
+  (void)directory;
+#endif
+}
+} // namespace
+
+AnalyzeObjectMapAtomicWriter::~AnalyzeObjectMapAtomicWriter()
+{
+  this->Abort();
+}
+
+void
+AnalyzeObjectMapAtomicWriter::Open(const std::string & fileName, SizeValueType numberOfBytes)
+{
+  this->Abort();
+
+  // The name is unique to the process and the write, and the file is created exclusively, so that
+  // concurrent writers of the same file never share a temporary file.
+  static std::atomic<unsigned int> numberOfWrites{ 0 };
+#if defined(_WIN32)
+  const int processId = _getpid();
+#else
+  const int processId = static_cast<int>(getpid());
+#endif
+  this->m_FileName = fileName;
+  this->m_TemporaryFileName =
+    fileName + "." + std::to_string(processId) + "." + std::to_string(numberOfWrites++) + ".tmp";
+  this->m_File = std::fopen(this->m_TemporaryFileName.c_str(), "wbx");
+  if (this->m_File == nullptr)
+  {
+    // The file may be another writer's, so it is not removed.
+    const int         error = errno;
+    const std::string temporaryFileName = this->m_TemporaryFileName;
+    this->m_TemporaryFileName.clear();
+    itkGenericExceptionMacro(<< "Error: Could not create " << temporaryFileName << ": " << std::strerror(error));
+  }
+  const int preallocationError = numberOfBytes > 0 ? PreallocateFile(this->m_File, numberOfBytes) : 0;
+  if (preallocationError != 0)
+  {
+    const std::string temporaryFileName = this->m_TemporaryFileName;
+    this->Abort();
+    itkGenericExceptionMacro(<< "Error: Could not allocate " << numberOfBytes << " bytes for " << temporaryFileName
+                             << ": " << std::strerror(preallocationError));
+  }
+}
+
+void
+AnalyzeObjectMapAtomicWriter::Write(const void * data, SizeValueType numberOfBytes)
+{
+  if (this->m_File == nullptr)
+  {
+    itkGenericExceptionMacro(<< "Error: No temporary file is open for " << this->m_FileName);
+  }
+  if (numberOfBytes > 0 && std::fwrite(data, 1, numberOfBytes, this->m_File) != numberOfBytes)
+  {
+    const int         error = errno;
+    const std::string temporaryFileName = this->m_TemporaryFileName;
+    this->Abort();
+    itkGenericExceptionMacro(<< "Error: Could not write " << temporaryFileName << ": " << std::strerror(error));
+  }
+}
+
+void
+AnalyzeObjectMapAtomicWriter::Commit(bool synchronous)
+{
+  if (this->m_File == nullptr)
+  {
+    itkGenericExceptionMacro(<< "Error: No temporary file is open for " << this->m_FileName);
+  }
+  std::string error;
+  if (synchronous && !SynchronizeFile(this->m_File))
+  {
+    error = "Could not flush " + this->m_TemporaryFileName + " to the disk: " + std::strerror(errno);
+  }
+  if (std::fclose(this->m_File) != 0 && error.empty())
+  {
+    error = "Could not write " + this->m_TemporaryFileName + ": " + std::strerror(errno);
+  }
+  this->m_File = nullptr;
+  if (error.empty() && !itksys::SystemTools::RenameFile(this->m_TemporaryFileName, this->m_FileName))
+  {
+    error = "Could not replace " + this->m_FileName + " by " + this->m_TemporaryFileName;
+  }
+  if (!error.empty())
+  {
+    itksys::SystemTools::RemoveFile(this->m_TemporaryFileName);
+    this->m_TemporaryFileName.clear();
+    itkGenericExceptionMacro(<< "Error: " << error);
+  }
+  this->m_TemporaryFileName.clear();
+  if (synchronous)
+  {
+    SynchronizeDirectory(itksys::SystemTools::GetFilenamePath(this->m_FileName));
+  }
+}
+
+void
+AnalyzeObjectMapAtomicWriter::Abort()
+{
+  if (this->m_File != nullptr)
+  {
+    std::fclose(this->m_File);
+    this->m_File = nullptr;
+  }
+  if (!this->m_TemporaryFileName.empty())
+  {
+    itksys::SystemTools::RemoveFile(this->m_TemporaryFileName);
+    this->m_TemporaryFileName.clear();
+  }
+}
+
+void
+AnalyzeObjectMapAtomicWriter::WriteFile(const std::string & fileName,
+                                        const void *        data,
+                                        SizeValueType       numberOfBytes,
+                                        bool                synchronous)
+{
+  AnalyzeObjectMapAtomicWriter writer;
+  writer.Open(fileName, numberOfBytes);
+  writer.Write(data, numberOfBytes);
+  writer.Commit(synchronous);
+}
+
+} // end namespace itk
@@ -0,0 +1,161 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkAnalyzeObjectMapCache.h"
+
+#include <iterator>
+
+namespace itk
+{
+
+SizeValueType
+AnalyzeObjectMapCache::CachedObjectMap::GetSizeInBytes() const
+{
+  const SizeValueType voxelBytes = this->Voxels.IsNull() ? 0 : this->Voxels->Size();
+  return voxelBytes + this->Entries.size() * sizeof(AnalyzeObjectEntry);
+}
+
+AnalyzeObjectMapCache &
+AnalyzeObjectMapCache::GetInstance()
+{
+  static AnalyzeObjectMapCache instance;
+  return instance;
+}
+
+bool
+AnalyzeObjectMapCache::Find(const std::string & fileName,
+                            SizeValueType       fileLength,
+                            long                modifiedTime,
+                            CachedObjectMap &   map)
+{
+  const std::lock_guard<std::mutex> lock(this->m_Mutex);
+  const auto                        found = this->m_Index.find(fileName);
+  if (found == this->m_Index.end())
+  {
+    return false;
+  }
+  const ListType::iterator position = found->second;
+  if (position->second.FileLength != fileLength || position->second.ModifiedTime != modifiedTime)
+  {
+    this->Erase(position);
+    return false;
+  }
+  this->m_Maps.splice(this->m_Maps.begin(), this->m_Maps, position);
+  map = position->second;
+  return true;
+}
+
+void
+AnalyzeObjectMapCache::Insert(const std::string & fileName, const CachedObjectMap & map)
+{
+  const std::lock_guard<std::mutex> lock(this->m_Mutex);
+  const auto                        found = this->m_Index.find(fileName);
+  if (found != this->m_Index.end())
+  {
+    this->Erase(found->second);
+  }
+  const SizeValueType sizeInBytes = map.GetSizeInBytes();
+  if (map.Voxels.IsNull() || sizeInBytes > this->m_MaximumSizeInBytes)
+  {
+    return;
+  }
+  this->m_Maps.emplace_front(fileName, map);
+  this->m_Index[fileName] = this->m_Maps.begin();
+  this->m_SizeInBytes += sizeInBytes;
+  this->Evict();
+}
+
+void
+AnalyzeObjectMapCache::Remove(const std::string & fileName)
+{
+  const std::lock_guard<std::mutex> lock(this->m_Mutex);
+  const auto                        found = this->m_Index.find(fileName);
+  if (found != this->m_Index.end())
+  {
+    this->Erase(found->second);
+  }
+}
+
+void
+AnalyzeObjectMapCache::Clear()
+{
+  const std::lock_guard<std::mutex> lock(this->m_Mutex);
+  this->m_Maps.clear();
+  this->m_Index.clear();
+  this->m_SizeInBytes = 0;
+}
+
+void
+AnalyzeObjectMapCache::SetMaximumSizeInBytes(SizeValueType maximumSizeInBytes)
+{
+  const std::lock_guard<std::mutex> lock(this->m_Mutex);
+  this->m_MaximumSizeInBytes = maximumSizeInBytes;
+  this->Evict();
+}
+
+SizeValueType
+AnalyzeObjectMapCache::GetMaximumSizeInBytes() const
+{
+  const std::lock_guard<std::mutex> lock(this->m_Mutex);
+  return this->m_MaximumSizeInBytes;
+}
+
+SizeValueType
+AnalyzeObjectMapCache::GetSizeInBytes() const
+{
+  const std::lock_guard<std::mutex> lock(this->m_Mutex);
+  return this->m_SizeInBytes;
+}
+
+SizeValueType
+AnalyzeObjectMapCache::GetNumberOfCachedMaps() const
+{
+  const std::lock_guard<std::mutex> lock(this->m_Mutex);
+  return this->m_Maps.size();
+}
+
+AnalyzeObjectMapCache::EntryArrayType
+AnalyzeObjectMapCache::CopyEntries(const EntryArrayType & entries)
+{
+  EntryArrayType copies(entries.size());
+  for (unsigned int i = 0; i < entries.size(); i++)
+  {
+    copies[i] = AnalyzeObjectEntry::New();
+    copies[i]->Copy(entries[i]);
+    copies[i]->SetName(entries[i]->GetName());
+  }
+  return copies;
+}
+
+void
+AnalyzeObjectMapCache::Evict()
+{
+  while (this->m_SizeInBytes > this->m_MaximumSizeInBytes && !this->m_Maps.empty())
+  {
+    this->Erase(std::prev(this->m_Maps.end()));
+  }
+}
+
+void
+AnalyzeObjectMapCache::Erase(ListType::iterator position)
+{
+  this->m_SizeInBytes -= position->second.GetSizeInBytes();
+  this->m_Index.erase(position->first);
+  this->m_Maps.erase(position);
+}
+
+} // end namespace itk
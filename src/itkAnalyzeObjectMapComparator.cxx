@@ -0,0 +1,152 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkAnalyzeObjectMapComparator.h"
+#include "itkAnalyzeObjectMapFileTools.h"
+#include "itkAnalyzeObjectRunLengthCodec.h"
+#include "itkMacro.h"
+
+#include <algorithm>
+
+namespace itk
+{
+
+void
+AnalyzeObjectMapComparator::Compare(const unsigned char * first,
+                                    SizeValueType         numberOfFirstBytes,
+                                    const unsigned char * second,
+                                    SizeValueType         numberOfSecondBytes)
+{
+  this->m_HeaderDifferences.clear();
+  this->m_VoxelsDiffer = false;
+  this->m_FirstDifferentPlane = 0;
+  this->m_FirstDifferentRow = 0;
+  this->m_LabelStatistics.fill(LabelStatistics());
+
+  AnalyzeObjectMapHeaderRecord firstHeader;
+  AnalyzeObjectMapHeaderRecord secondHeader;
+  if (!firstHeader.Decode(first, numberOfFirstBytes, true) || !secondHeader.Decode(second, numberOfSecondBytes, true))
+  {
+    itkGenericExceptionMacro(<< "Error: Cannot compare a file that is not an object map, or is truncated.");
+  }
+
+  // The headers and the entries, field by field.
+  std::vector<std::string> & differences = this->m_HeaderDifferences;
+  if (firstHeader.Version != secondHeader.Version)
+  {
+    differences.emplace_back("Version");
+  }
+  if (firstHeader.BigEndian != secondHeader.BigEndian)
+  {
+    differences.emplace_back("BigEndian");
+  }
+  for (unsigned int d = 0; d < 4; d++)
+  {
+    if (firstHeader.Dimensions[d] != secondHeader.Dimensions[d])
+    {
+      differences.push_back("Dimensions[" + std::to_string(d) + "]");
+    }
+  }
+  if (firstHeader.NumberOfObjects != secondHeader.NumberOfObjects)
+  {
+    differences.emplace_back("NumberOfObjects");
+  }
+  const SizeValueType      numberOfEntries = std::min(firstHeader.Entries.size(), secondHeader.Entries.size());
+  std::vector<std::string> fields;
+  for (SizeValueType i = 0; i < numberOfEntries; i++)
+  {
+    fields.clear();
+    firstHeader.Entries[i].GetDifferingFields(secondHeader.Entries[i], fields);
+    for (const std::string & field : fields)
+    {
+      differences.push_back("Entries[" + std::to_string(i) + "]." + field);
+    }
+  }
+
+  if (!std::equal(firstHeader.Dimensions, firstHeader.Dimensions + 4, secondHeader.Dimensions))
+  {
+    this->m_VoxelsDiffer = true;
+    return;
+  }
+
+  // The runs, side by side.
+  const SizeValueType rowLength = firstHeader.Dimensions[0];
+  const SizeValueType planeSize = rowLength * firstHeader.Dimensions[1];
+  const SizeValueType numberOfPlanes =
+    static_cast<SizeValueType>(firstHeader.Dimensions[2]) * firstHeader.Dimensions[3];
+  LabelStatisticsContainerType & statistics = this->m_LabelStatistics;
+  const bool                     valid = AnalyzeObjectRunLengthCodec::ZipRuns(
+    first + firstHeader.DataOffset,
+    numberOfFirstBytes - firstHeader.DataOffset,
+    second + secondHeader.DataOffset,
+    numberOfSecondBytes - secondHeader.DataOffset,
+    planeSize,
+    numberOfPlanes,
+    [&](SizeValueType plane, SizeValueType voxel, SizeValueType length, unsigned char a, unsigned char b) {
+      statistics[a].FirstVoxels += length;
+      statistics[b].SecondVoxels += length;
+      if (a == b)
+      {
+        statistics[a].CommonVoxels += length;
+      }
+      else if (!this->m_VoxelsDiffer)
+      {
+        this->m_VoxelsDiffer = true;
+        this->m_FirstDifferentPlane = plane;
+        this->m_FirstDifferentRow = voxel / rowLength;
+      }
+    });
+  if (!valid)
+  {
+    itkGenericExceptionMacro(<< "Error: The runs of an object map end early, have a zero length or cross a plane.");
+  }
+}
+
+void
+AnalyzeObjectMapComparator::CompareFiles(const std::string & firstFileName, const std::string & secondFileName)
+{
+  std::vector<unsigned char> first;
+  std::vector<unsigned char> second;
+  AnalyzeObjectMapFileTools::ReadFile(firstFileName, first);
+  AnalyzeObjectMapFileTools::ReadFile(secondFileName, second);
+  this->Compare(first.data(), first.size(), second.data(), second.size());
+}
+
+void
+AnalyzeObjectMapComparator::Print(std::ostream & os) const
+{
+  for (const std::string & difference : this->m_HeaderDifferences)
+  {
+    os << "Header differs: " << difference << std::endl;
+  }
+  if (this->m_VoxelsDiffer)
+  {
+    os << "Voxels differ from plane " << this->m_FirstDifferentPlane << ", row " << this->m_FirstDifferentRow
+       << std::endl;
+  }
+  for (unsigned int label = 0; label < NumberOfLabels; label++)
+  {
+    const LabelStatistics & statistics = this->m_LabelStatistics[label];
+    if (statistics.FirstVoxels > 0 || statistics.SecondVoxels > 0)
+    {
+      os << "Label " << label << ": " << statistics.FirstVoxels << " and " << statistics.SecondVoxels
+         << " voxels, delta " << statistics.GetVoxelDelta() << ", Dice " << statistics.GetDice() << std::endl;
+    }
+  }
+}
+
+} // end namespace itk
@@ -0,0 +1,42 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkAnalyzeObjectMapFileTools.h"
+#include "itkMacro.h"
+
+#include <fstream>
+
+namespace itk
+{
+
+void
+AnalyzeObjectMapFileTools::ReadFile(const std::string & fileName, BufferType & bytes)
+{
+  std::ifstream inputFileStream(fileName.c_str(), std::ios::binary | std::ios::in);
+  if (inputFileStream.is_open() && inputFileStream.seekg(0, std::ios::end))
+  {
+    bytes.resize(static_cast<SizeValueType>(inputFileStream.tellg()));
+    inputFileStream.seekg(0, std::ios::beg);
+    inputFileStream.read(reinterpret_cast<char *>(bytes.data()), bytes.size());
+  }
+  if (!inputFileStream.is_open() || inputFileStream.fail())
+  {
+    itkGenericExceptionMacro(<< "Error: Could not read " << fileName.c_str());
+  }
+}
+
+} // end namespace itk
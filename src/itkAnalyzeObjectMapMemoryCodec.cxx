@@ -0,0 +1,47 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkAnalyzeObjectMapMemoryCodec.h"
+
+namespace itk
+{
+
+bool
+AnalyzeObjectMapMemoryCodec::DecodeHeader(const void *                   data,
+                                          SizeValueType                  numberOfBytes,
+                                          AnalyzeObjectMapHeaderRecord & header)
+{
+  header.Entries.clear();
+  return header.Decode(static_cast<const unsigned char *>(data), numberOfBytes, true);
+}
+
+bool
+AnalyzeObjectMapMemoryCodec::Decode(const void *                   data,
+                                    SizeValueType                  numberOfBytes,
+                                    AnalyzeObjectMapHeaderRecord & header,
+                                    std::vector<unsigned char> &   voxels)
+{
+  if (!DecodeHeader(data, numberOfBytes, header))
+  {
+    voxels.clear();
+    return false;
+  }
+  voxels.resize(GetNumberOfVoxels(header));
+  return DecodeVoxels(data, numberOfBytes, header, voxels.data());
+}
+
+} // end namespace itk
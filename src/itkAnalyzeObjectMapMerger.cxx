@@ -0,0 +1,221 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkAnalyzeObjectMapMerger.h"
+#include "itkAnalyzeObjectEntryTable.h"
+#include "itkAnalyzeObjectLabelMapImageIO.h"
+#include "itkAnalyzeObjectMapAtomicWriter.h"
+#include "itkAnalyzeObjectMapFileTools.h"
+#include "itkAnalyzeObjectRunLengthCodec.h"
+#include "itkMacro.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace itk
+{
+namespace
+{
+void
+DecodeHeader(const unsigned char * bytes, SizeValueType numberOfBytes, AnalyzeObjectMapHeaderRecord & header)
+{
+  if (!header.Decode(bytes, numberOfBytes, true))
+  {
+    itkGenericExceptionMacro(<< "Error: Cannot merge a file that is not an object map, or is truncated.");
+  }
+}
+} // namespace
+
+void
+AnalyzeObjectMapMerger::MergeEntries(const AnalyzeObjectMapHeaderRecord & first,
+                                     const AnalyzeObjectMapHeaderRecord & second,
+                                     AnalyzeObjectMapHeaderRecord &       merged,
+                                     LabelTableType &                     labels) const
+{
+  constexpr unsigned int NumberOfLabels = AnalyzeObjectRunLengthCodec::MaximumNumberOfLabels;
+
+  // The labels of the first map keep their entry; those of the second map are renumbered.
+  std::uint16_t firstLabels[NumberOfLabels];
+  std::uint16_t secondLabels[NumberOfLabels];
+  std::fill(firstLabels, firstLabels + NumberOfLabels, NoLabel);
+  std::fill(secondLabels, secondLabels + NumberOfLabels, NoLabel);
+  merged.Entries = first.Entries;
+  if (merged.Entries.empty())
+  {
+    merged.Entries.push_back(AnalyzeObjectEntryTable::GetDefaultRecord());
+  }
+  for (SizeValueType i = 0; i < std::min<SizeValueType>(first.Entries.size(), NumberOfLabels); i++)
+  {
+    firstLabels[i] = static_cast<std::uint16_t>(i);
+  }
+  firstLabels[0] = 0;
+  secondLabels[0] = 0;
+  if (this->m_Operation != OperationEnum::Difference)
+  {
+    std::unordered_map<std::string, std::uint16_t> labelsByName;
+    for (SizeValueType i = merged.Entries.size(); i-- > 1;)
+    {
+      labelsByName[merged.Entries[i].Name] = static_cast<std::uint16_t>(i);
+    }
+    for (SizeValueType i = 1; i < std::min<SizeValueType>(second.Entries.size(), NumberOfLabels); i++)
+    {
+      const auto match = this->m_MatchEntriesByName ? labelsByName.find(second.Entries[i].Name) : labelsByName.end();
+      if (match != labelsByName.end())
+      {
+        secondLabels[i] = match->second;
+        continue;
+      }
+      if (merged.Entries.size() >= NumberOfLabels)
+      {
+        itkGenericExceptionMacro(<< "Error: The merged object map would have more than " << NumberOfLabels
+                                 << " entries.");
+      }
+      secondLabels[i] = static_cast<std::uint16_t>(merged.Entries.size());
+      merged.Entries.push_back(second.Entries[i]);
+    }
+  }
+
+  // The label of every pair of labels, so that the runs are merged with a single lookup.
+  const SizeValueType numberOfEntries = merged.Entries.size();
+  const auto          resolve = [this, numberOfEntries](std::uint16_t a, std::uint16_t b) -> std::uint16_t {
+    if (a == NoLabel || b == NoLabel || a == b)
+    {
+      return a == b ? a : NoLabel;
+    }
+    if (this->m_ConflictFunction)
+    {
+      const unsigned char label =
+        this->m_ConflictFunction(static_cast<unsigned char>(a), static_cast<unsigned char>(b));
+      return label < numberOfEntries ? label : NoLabel;
+    }
+    switch (this->m_ConflictPolicy)
+    {
+      case ConflictPolicyEnum::KeepFirst:
+        return a;
+      case ConflictPolicyEnum::KeepSecond:
+        return b;
+      default:
+        return 0;
+    }
+  };
+  labels.resize(NumberOfLabels * NumberOfLabels);
+  for (unsigned int a = 0; a < NumberOfLabels; a++)
+  {
+    for (unsigned int b = 0; b < NumberOfLabels; b++)
+    {
+      std::uint16_t & label = labels[a * NumberOfLabels + b];
+      switch (this->m_Operation)
+      {
+        case OperationEnum::Union:
+          label = a == 0 ? secondLabels[b] : b == 0 ? firstLabels[a] : resolve(firstLabels[a], secondLabels[b]);
+          break;
+        case OperationEnum::Intersection:
+          label = a == 0 || b == 0 ? 0 : resolve(firstLabels[a], secondLabels[b]);
+          break;
+        case OperationEnum::Difference:
+          label = b == 0 ? firstLabels[a] : 0;
+          break;
+        case OperationEnum::Priority:
+          label = b == 0 ? firstLabels[a] : secondLabels[b];
+          break;
+      }
+    }
+  }
+}
+
+void
+AnalyzeObjectMapMerger::Merge(const unsigned char * first,
+                              SizeValueType         numberOfFirstBytes,
+                              const unsigned char * second,
+                              SizeValueType         numberOfSecondBytes,
+                              BufferType &          output) const
+{
+  AnalyzeObjectMapHeaderRecord firstHeader;
+  AnalyzeObjectMapHeaderRecord secondHeader;
+  DecodeHeader(first, numberOfFirstBytes, firstHeader);
+  DecodeHeader(second, numberOfSecondBytes, secondHeader);
+  if (!std::equal(firstHeader.Dimensions, firstHeader.Dimensions + 4, secondHeader.Dimensions))
+  {
+    itkGenericExceptionMacro(<< "Error: Cannot merge object maps of different sizes.");
+  }
+
+  AnalyzeObjectMapHeaderRecord merged;
+  merged.Version = VERSION7;
+  std::copy(firstHeader.Dimensions, firstHeader.Dimensions + 4, merged.Dimensions);
+  LabelTableType labels;
+  this->MergeEntries(firstHeader, secondHeader, merged, labels);
+  merged.Encode(output, true);
+
+  // Runs of the same label are joined, up to MaximumRunLength voxels, and restarted on every plane.
+  const SizeValueType planeSize = static_cast<SizeValueType>(merged.Dimensions[0]) * merged.Dimensions[1];
+  const SizeValueType numberOfPlanes = static_cast<SizeValueType>(merged.Dimensions[2]) * merged.Dimensions[3];
+  std::uint16_t       value = 0;
+  SizeValueType       count = 0;
+  const auto          flush = [&output, &value, &count]() {
+    for (; count > 0; count -= std::min<SizeValueType>(count, AnalyzeObjectRunLengthCodec::MaximumRunLength))
+    {
+      output.push_back(
+        static_cast<unsigned char>(std::min<SizeValueType>(count, AnalyzeObjectRunLengthCodec::MaximumRunLength)));
+      output.push_back(static_cast<unsigned char>(value));
+    }
+  };
+  const bool valid = AnalyzeObjectRunLengthCodec::ZipRuns(
+    first + firstHeader.DataOffset,
+    numberOfFirstBytes - firstHeader.DataOffset,
+    second + secondHeader.DataOffset,
+    numberOfSecondBytes - secondHeader.DataOffset,
+    planeSize,
+    numberOfPlanes,
+    [&](SizeValueType, SizeValueType voxel, SizeValueType length, unsigned char a, unsigned char b) {
+      const std::uint16_t label = labels[a * AnalyzeObjectRunLengthCodec::MaximumNumberOfLabels + b];
+      if (label == NoLabel)
+      {
+        itkGenericExceptionMacro(<< "Error: Labels " << static_cast<int>(a) << " and " << static_cast<int>(b)
+                                 << " have no entry in the merged object map.");
+      }
+      if (label != value || voxel == 0)
+      {
+        flush();
+        value = label;
+      }
+      count += length;
+    });
+  if (!valid)
+  {
+    itkGenericExceptionMacro(<< "Error: The runs of an object map end early, have a zero length or cross a plane.");
+  }
+  flush();
+}
+
+void
+AnalyzeObjectMapMerger::MergeFiles(const std::string & firstFileName,
+                                   const std::string & secondFileName,
+                                   const std::string & outputFileName) const
+{
+  std::vector<unsigned char> first;
+  std::vector<unsigned char> second;
+  std::vector<unsigned char> output;
+  AnalyzeObjectMapFileTools::ReadFile(firstFileName, first);
+  AnalyzeObjectMapFileTools::ReadFile(secondFileName, second);
+  this->Merge(first.data(), first.size(), second.data(), second.size(), output);
+
+  AnalyzeObjectLabelMapImageIO::InvalidateDerivedData(outputFileName);
+  AnalyzeObjectMapAtomicWriter::WriteFile(outputFileName, output.data(), output.size());
+  AnalyzeObjectLabelMapImageIO::InvalidateDerivedData(outputFileName);
+}
+
+} // end namespace itk
@@ -0,0 +1,318 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkAnalyzeObjectMapPyramid.h"
+#include "itkAnalyzeObjectLabelMapImageIO.h"
+#include "itkAnalyzeObjectMapAtomicWriter.h"
+#include "itkAnalyzeObjectRunLengthCodec.h"
+#include "itksys/SystemTools.hxx"
+
+#include <algorithm>
+#include <fstream>
+
+namespace itk
+{
+namespace
+{
+using ImageType = AnalyzeObjectMapPyramid::ImageType;
+using ReductionEnum = AnalyzeObjectMapPyramid::ReductionEnum;
+
+SizeValueType
+GetLevelSize(int dimension, SizeValueType factor)
+{
+  return (static_cast<SizeValueType>(dimension) + factor - 1) / factor;
+}
+
+// Expands runs, one plane after the other, into a ring of planes, and reduces the blocks of every
+// level as soon as their last plane has been expanded.
+class LevelBuilder
+{
+public:
+  LevelBuilder(const AnalyzeObjectMapHeaderRecord &    header,
+               ReductionEnum                           reduction,
+               const std::vector<ImageType::Pointer> & levels)
+    : m_Header(header)
+    , m_Reduction(reduction)
+    , m_Levels(levels)
+    , m_PlaneSize(static_cast<SizeValueType>(header.Dimensions[0]) * header.Dimensions[1])
+    , m_NumberOfPlanes(static_cast<SizeValueType>(header.Dimensions[2]) * header.Dimensions[3])
+    , m_RingSize(SizeValueType{ 2 } << (levels.size() - 1))
+    , m_Ring(m_RingSize * m_PlaneSize)
+  {}
+
+  void
+  operator()(unsigned char voxel_count, unsigned char voxel_value)
+  {
+    this->m_Invalid = this->m_Invalid || voxel_count == 0;
+    for (SizeValueType left = voxel_count; left > 0 && !this->m_Invalid;)
+    {
+      if (this->m_Plane == this->m_NumberOfPlanes)
+      {
+        this->m_Invalid = true;
+        return;
+      }
+      const SizeValueType length = std::min(left, this->m_PlaneSize - this->m_Position);
+      unsigned char *     plane =
+        this->m_Ring.data() + (this->m_Plane % this->m_Header.Dimensions[2]) % this->m_RingSize * this->m_PlaneSize;
+      std::fill_n(plane + this->m_Position, length, voxel_value);
+      this->m_Position += length;
+      left -= length;
+      if (this->m_Position == this->m_PlaneSize)
+      {
+        this->EndPlane();
+        this->m_Position = 0;
+        this->m_Plane++;
+      }
+    }
+  }
+
+  /** True if the runs held the voxels of every plane, and no more. */
+  bool
+  IsComplete() const
+  {
+    return !this->m_Invalid && this->m_Plane == this->m_NumberOfPlanes && this->m_Position == 0;
+  }
+
+private:
+  void
+  EndPlane()
+  {
+    const SizeValueType zDimension = this->m_Header.Dimensions[2];
+    const SizeValueType z = this->m_Plane % zDimension;
+    const SizeValueType t = this->m_Plane / zDimension;
+    for (unsigned int level = 0; level < this->m_Levels.size(); level++)
+    {
+      const SizeValueType factor = SizeValueType{ 2 } << level;
+      if ((z + 1) % factor == 0 || z + 1 == zDimension)
+      {
+        this->Reduce(level, factor, t, z - z % factor, z % factor + 1);
+      }
+    }
+  }
+
+  // Reduces the blocks of numberOfPlanes planes, from firstPlane of frame t, into a level.
+  void
+  Reduce(unsigned int  level,
+         SizeValueType factor,
+         SizeValueType t,
+         SizeValueType firstPlane,
+         SizeValueType numberOfPlanes)
+  {
+    const SizeValueType xDimension = this->m_Header.Dimensions[0];
+    const SizeValueType yDimension = this->m_Header.Dimensions[1];
+    const SizeValueType xSize = GetLevelSize(this->m_Header.Dimensions[0], factor);
+    const SizeValueType ySize = GetLevelSize(this->m_Header.Dimensions[1], factor);
+    const SizeValueType zSize = GetLevelSize(this->m_Header.Dimensions[2], factor);
+    unsigned char *     output =
+      this->m_Levels[level]->GetBufferPointer() + (t * zSize + firstPlane / factor) * ySize * xSize;
+
+    for (SizeValueType oy = 0; oy < ySize; oy++)
+    {
+      const SizeValueType yEnd = std::min((oy + 1) * factor, yDimension);
+      for (SizeValueType ox = 0; ox < xSize; ox++)
+      {
+        const SizeValueType xBegin = ox * factor;
+        const SizeValueType xEnd = std::min(xBegin + factor, xDimension);
+        unsigned char       maximum = 0;
+        for (SizeValueType dz = 0; dz < numberOfPlanes; dz++)
+        {
+          const unsigned char * plane =
+            this->m_Ring.data() + (firstPlane + dz) % this->m_RingSize * this->m_PlaneSize;
+          for (SizeValueType y = oy * factor; y < yEnd; y++)
+          {
+            const unsigned char * row = plane + y * xDimension;
+            for (SizeValueType x = xBegin; x < xEnd; x++)
+            {
+              if (this->m_Reduction == ReductionEnum::Maximum)
+              {
+                maximum = std::max(maximum, row[x]);
+              }
+              else if (this->m_Counts[row[x]]++ == 0)
+              {
+                this->m_Touched.push_back(row[x]);
+              }
+            }
+          }
+        }
+        if (this->m_Reduction == ReductionEnum::Mode)
+        {
+          // The most frequent label, the smaller one on ties; the counts are reset for the next block.
+          unsigned int  mode = 256;
+          SizeValueType count = 0;
+          for (const unsigned char label : this->m_Touched)
+          {
+            if (this->m_Counts[label] > count || (this->m_Counts[label] == count && label < mode))
+            {
+              mode = label;
+              count = this->m_Counts[label];
+            }
+            this->m_Counts[label] = 0;
+          }
+          this->m_Touched.clear();
+          maximum = static_cast<unsigned char>(mode);
+        }
+        output[oy * xSize + ox] = maximum;
+      }
+    }
+  }
+
+  const AnalyzeObjectMapHeaderRecord &    m_Header;
+  const ReductionEnum                     m_Reduction;
+  const std::vector<ImageType::Pointer> & m_Levels;
+  const SizeValueType                     m_PlaneSize;
+  const SizeValueType                     m_NumberOfPlanes;
+  const SizeValueType                     m_RingSize;
+  std::vector<unsigned char>              m_Ring;
+  SizeValueType                           m_Counts[256]{};
+  std::vector<unsigned char>              m_Touched;
+  SizeValueType                           m_Plane{ 0 };
+  SizeValueType                           m_Position{ 0 };
+  bool                                    m_Invalid{ false };
+};
+} // namespace
+
+void
+AnalyzeObjectMapPyramid::SetNumberOfLevels(unsigned int numberOfLevels)
+{
+  this->m_NumberOfLevels = std::max(1u, std::min(numberOfLevels, MaximumNumberOfLevels));
+}
+
+unsigned int
+AnalyzeObjectMapPyramid::GetNumberOfLevelsForSize(const int dimensions[4], SizeValueType maximumSize)
+{
+  unsigned int numberOfLevels = 1;
+  while (numberOfLevels < MaximumNumberOfLevels)
+  {
+    const SizeValueType factor = SizeValueType{ 2 } << (numberOfLevels - 1);
+    if (GetLevelSize(dimensions[0], factor) <= maximumSize && GetLevelSize(dimensions[1], factor) <= maximumSize &&
+        GetLevelSize(dimensions[2], factor) <= maximumSize)
+    {
+      break;
+    }
+    numberOfLevels++;
+  }
+  return numberOfLevels;
+}
+
+std::string
+AnalyzeObjectMapPyramid::GetLevelFileName(const std::string & fileName, unsigned int factor)
+{
+  const std::string extension = itksys::SystemTools::GetFilenameLastExtension(fileName);
+  return fileName.substr(0, fileName.size() - extension.size()) + "_" + std::to_string(factor) + "x" +
+         (extension.empty() ? std::string(".obj") : extension);
+}
+
+void
+AnalyzeObjectMapPyramid::AllocateLevels()
+{
+  this->m_Levels.clear();
+  for (unsigned int level = 0; level < this->m_NumberOfLevels; level++)
+  {
+    const SizeValueType    factor = SizeValueType{ 2 } << level;
+    ImageType::SizeType    size;
+    ImageType::SpacingType spacing;
+    ImageType::PointType   origin;
+    for (unsigned int d = 0; d < 4; d++)
+    {
+      const bool downsampled = d < 3;
+      size[d] = downsampled ? GetLevelSize(this->m_Header.Dimensions[d], factor) : this->m_Header.Dimensions[d];
+      spacing[d] = downsampled ? factor : 1.0;
+      origin[d] = downsampled ? 0.5 * (factor - 1) : 0.0;
+    }
+    ImageType::Pointer image = ImageType::New();
+    image->SetRegions(size);
+    image->SetSpacing(spacing);
+    image->SetOrigin(origin);
+    image->Allocate();
+    this->m_Levels.push_back(image);
+  }
+}
+
+void
+AnalyzeObjectMapPyramid::Generate(const unsigned char * input, SizeValueType numberOfInputBytes)
+{
+  if (!this->m_Header.Decode(input, numberOfInputBytes, true))
+  {
+    itkGenericExceptionMacro(<< "Error: Cannot downsample bytes that are not an object map, or are truncated.");
+  }
+  this->AllocateLevels();
+  LevelBuilder builder(this->m_Header, this->m_Reduction, this->m_Levels);
+  for (SizeValueType i = this->m_Header.DataOffset; i + 1 < numberOfInputBytes; i += 2)
+  {
+    builder(input[i], input[i + 1]);
+  }
+  if (!builder.IsComplete())
+  {
+    itkGenericExceptionMacro(<< "Error: The runs of the object map do not cover its voxels, or have a zero length.");
+  }
+}
+
+void
+AnalyzeObjectMapPyramid::GenerateFromFile(const std::string & fileName)
+{
+  std::ifstream inputFileStream(fileName.c_str(), std::ios::binary | std::ios::in);
+  if (!inputFileStream.is_open() || !AnalyzeObjectLabelMapImageIO::ProbeHeader(fileName, this->m_Header))
+  {
+    itkGenericExceptionMacro(<< "Error: " << fileName.c_str() << " is not an object map, or cannot be read.");
+  }
+  this->AllocateLevels();
+  LevelBuilder builder(this->m_Header, this->m_Reduction, this->m_Levels);
+  inputFileStream.seekg(this->m_Header.DataOffset);
+  std::vector<unsigned char> RunLengthArray(2 * NumberOfRunLengthElementsPerRead);
+  while (inputFileStream)
+  {
+    inputFileStream.read(reinterpret_cast<char *>(RunLengthArray.data()), RunLengthArray.size());
+    const SizeValueType numberOfBytes = static_cast<SizeValueType>(inputFileStream.gcount());
+    for (SizeValueType i = 0; i + 1 < numberOfBytes; i += 2)
+    {
+      builder(RunLengthArray[i], RunLengthArray[i + 1]);
+    }
+  }
+  if (!builder.IsComplete())
+  {
+    itkGenericExceptionMacro(<< "Error: The runs of " << fileName.c_str()
+                             << " do not cover its voxels, or have a zero length.");
+  }
+  if (!this->m_WriteLevelFiles)
+  {
+    return;
+  }
+
+  // Every level is written with the entries of the map, as AnalyzeObjectLabelMapImageIO writes it.
+  for (unsigned int level = 0; level < this->m_Levels.size(); level++)
+  {
+    const ImageType *            image = this->m_Levels[level];
+    const ImageType::SizeType    size = image->GetLargestPossibleRegion().GetSize();
+    AnalyzeObjectMapHeaderRecord header = this->m_Header;
+    header.Version = VERSION7;
+    for (unsigned int d = 0; d < 4; d++)
+    {
+      header.Dimensions[d] = static_cast<int>(size[d]);
+    }
+    AnalyzeObjectRunLengthCodec::BufferType bytes;
+    header.Encode(bytes, true);
+    AnalyzeObjectRunLengthCodec::EncodeVolume(
+      image->GetBufferPointer(), image->GetLargestPossibleRegion().GetNumberOfPixels(), size[0] * size[1], bytes);
+
+    const std::string levelFileName = GetLevelFileName(fileName, 2u << level);
+    AnalyzeObjectLabelMapImageIO::InvalidateDerivedData(levelFileName);
+    AnalyzeObjectMapAtomicWriter::WriteFile(levelFileName, bytes.data(), bytes.size());
+    AnalyzeObjectLabelMapImageIO::InvalidateDerivedData(levelFileName);
+  }
+}
+
+} // end namespace itk
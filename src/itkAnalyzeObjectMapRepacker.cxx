@@ -0,0 +1,265 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkAnalyzeObjectMapRepacker.h"
+#include "itkAnalyzeObjectEntryTable.h"
+#include "itkAnalyzeObjectLabelMapImageIO.h"
+#include "itkAnalyzeObjectMapAtomicWriter.h"
+#include "itkAnalyzeObjectRunLengthCodec.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace itk
+{
+namespace
+{
+using BufferType = AnalyzeObjectMapRepacker::BufferType;
+
+// Calls visitor(voxel_count, voxel_value) for every run of numberOfBytes bytes.  A trailing odd
+// byte is ignored.
+template <typename TVisitor>
+void
+VisitRuns(const unsigned char * runs, SizeValueType numberOfBytes, TVisitor && visitor)
+{
+  for (SizeValueType i = 0; i + 1 < numberOfBytes; i += 2)
+  {
+    visitor(runs[i], runs[i + 1]);
+  }
+}
+
+// Calls visitor(voxel_count, voxel_value) for every run from dataOffset to the end of inputStream,
+// reading a block of runs at a time.  afterBlock() is called after every block.
+template <typename TVisitor, typename TBlockVisitor>
+void
+VisitRuns(std::istream & inputStream, std::streamoff dataOffset, TVisitor && visitor, TBlockVisitor && afterBlock)
+{
+  inputStream.clear();
+  inputStream.seekg(dataOffset);
+  std::vector<unsigned char> RunLengthArray(2 * NumberOfRunLengthElementsPerRead);
+  while (inputStream)
+  {
+    inputStream.read(reinterpret_cast<char *>(RunLengthArray.data()), RunLengthArray.size());
+    VisitRuns(RunLengthArray.data(), static_cast<SizeValueType>(inputStream.gcount()), visitor);
+    afterBlock();
+  }
+  inputStream.clear();
+}
+
+// The labels used by the runs, and the number of voxels they cover.
+struct RunScan
+{
+  bool          Used[256]{};
+  SizeValueType NumberOfVoxels{ 0 };
+  SizeValueType NumberOfRunBytes{ 0 };
+  bool          ZeroLengthRun{ false };
+
+  void
+  operator()(unsigned char voxel_count, unsigned char voxel_value)
+  {
+    this->Used[voxel_value] = true;
+    this->NumberOfVoxels += voxel_count;
+    this->NumberOfRunBytes += 2;
+    this->ZeroLengthRun = this->ZeroLengthRun || voxel_count == 0;
+  }
+};
+
+// Re-encodes runs, relabelled, joining those of the same label and splitting them at
+// MaximumRunLength voxels and at plane boundaries.
+class RunEncoder
+{
+public:
+  RunEncoder(SizeValueType planeSize, const unsigned char labels[256], BufferType & output)
+    : m_PlaneSize(planeSize)
+    , m_Labels(labels)
+    , m_Output(output)
+  {}
+
+  void
+  operator()(unsigned char voxel_count, unsigned char voxel_value)
+  {
+    const unsigned char value = this->m_Labels[voxel_value];
+    for (SizeValueType left = voxel_count; left > 0;)
+    {
+      const SizeValueType length = std::min(left, this->m_PlaneSize - this->m_Position);
+      if (value != this->m_Value)
+      {
+        this->Flush();
+        this->m_Value = value;
+      }
+      this->m_Count += length;
+      this->m_Position += length;
+      left -= length;
+      if (this->m_Position == this->m_PlaneSize)
+      {
+        this->Flush();
+        this->m_Position = 0;
+      }
+    }
+  }
+
+  void
+  Flush()
+  {
+    for (; this->m_Count > 0; this->m_Count -= this->m_Output[this->m_Output.size() - 2])
+    {
+      this->m_Output.push_back(static_cast<unsigned char>(
+        std::min<SizeValueType>(this->m_Count, AnalyzeObjectRunLengthCodec::MaximumRunLength)));
+      this->m_Output.push_back(this->m_Value);
+    }
+  }
+
+private:
+  const SizeValueType   m_PlaneSize;
+  const unsigned char * m_Labels;
+  BufferType &          m_Output;
+  SizeValueType         m_Position{ 0 };
+  SizeValueType         m_Count{ 0 };
+  unsigned char         m_Value{ 0 };
+};
+
+// Throws unless the runs of scan cover exactly the voxels of header.
+void
+CheckRuns(const AnalyzeObjectMapHeaderRecord & header, const RunScan & scan)
+{
+  const SizeValueType numberOfVoxels = static_cast<SizeValueType>(header.Dimensions[0]) * header.Dimensions[1] *
+                                       header.Dimensions[2] * header.Dimensions[3];
+  if (scan.ZeroLengthRun || scan.NumberOfVoxels != numberOfVoxels)
+  {
+    itkGenericExceptionMacro(<< "Error: The runs of the object map cover " << scan.NumberOfVoxels
+                             << " voxels instead of " << numberOfVoxels << ", or have a zero length.");
+  }
+}
+} // namespace
+
+void
+AnalyzeObjectMapRepacker::TrimEntries(const AnalyzeObjectMapHeaderRecord & input,
+                                      const bool                           used[256],
+                                      AnalyzeObjectMapHeaderRecord &       output,
+                                      unsigned char                        labels[256]) const
+{
+  output.Version = VERSION7;
+  std::copy(input.Dimensions, input.Dimensions + 4, output.Dimensions);
+  SizeValueType numberOfEntries = input.Entries.size();
+  for (unsigned int label = 0; label < 256; label++)
+  {
+    labels[label] = static_cast<unsigned char>(label);
+  }
+  if (this->m_TrimEntries)
+  {
+    numberOfEntries = 1;
+    for (unsigned int label = 1; label < 256; label++)
+    {
+      if (used[label])
+      {
+        labels[label] = static_cast<unsigned char>(this->m_RenumberLabels ? numberOfEntries : label);
+        numberOfEntries = labels[label] + 1;
+      }
+    }
+  }
+  else
+  {
+    for (unsigned int label = 0; label < 256; label++)
+    {
+      numberOfEntries = used[label] ? std::max<SizeValueType>(numberOfEntries, label + 1) : numberOfEntries;
+    }
+  }
+
+  // Labels used without an entry get a blank one, as when an image without entries is written.
+  AnalyzeObjectEntryRecord blank = AnalyzeObjectEntryTable::GetDefaultRecord();
+  AnalyzeObjectEntryTable::EntryView(&blank).SetName("Blank Object");
+  output.Entries.assign(numberOfEntries, blank);
+  for (unsigned int label = 0; label < 256; label++)
+  {
+    const bool kept = label == 0 || used[label] || !this->m_RenumberLabels;
+    if (kept && label < input.Entries.size() && labels[label] < numberOfEntries)
+    {
+      output.Entries[labels[label]] = input.Entries[label];
+    }
+  }
+}
+
+void
+AnalyzeObjectMapRepacker::Repack(const unsigned char * input, SizeValueType numberOfInputBytes, BufferType & output)
+{
+  AnalyzeObjectMapHeaderRecord header;
+  if (!header.Decode(input, numberOfInputBytes, true))
+  {
+    itkGenericExceptionMacro(<< "Error: Cannot repack bytes that are not an object map, or are truncated.");
+  }
+  const unsigned char * runs = input + header.DataOffset;
+  const SizeValueType   numberOfRunBytes = numberOfInputBytes - header.DataOffset;
+  RunScan               scan;
+  VisitRuns(runs, numberOfRunBytes, scan);
+  CheckRuns(header, scan);
+
+  AnalyzeObjectMapHeaderRecord repacked;
+  unsigned char                labels[256];
+  this->TrimEntries(header, scan.Used, repacked, labels);
+  repacked.Encode(output, true);
+  const SizeValueType headerSize = output.size();
+  RunEncoder          encoder(static_cast<SizeValueType>(header.Dimensions[0]) * header.Dimensions[1], labels, output);
+  VisitRuns(runs, numberOfRunBytes, encoder);
+  encoder.Flush();
+  this->m_NumberOfInputRunBytes = scan.NumberOfRunBytes;
+  this->m_NumberOfOutputRunBytes = output.size() - headerSize;
+}
+
+void
+AnalyzeObjectMapRepacker::RepackFile(const std::string & inputFileName, const std::string & outputFileName)
+{
+  AnalyzeObjectMapHeaderRecord header;
+  std::ifstream                inputFileStream(inputFileName.c_str(), std::ios::binary | std::ios::in);
+  if (!inputFileStream.is_open() || !AnalyzeObjectLabelMapImageIO::ProbeHeader(inputFileName, header))
+  {
+    itkGenericExceptionMacro(<< "Error: " << inputFileName.c_str() << " is not an object map, or cannot be read.");
+  }
+  RunScan scan;
+  VisitRuns(inputFileStream, header.DataOffset, scan, []() {});
+  CheckRuns(header, scan);
+
+  AnalyzeObjectMapHeaderRecord repacked;
+  unsigned char                labels[256];
+  this->TrimEntries(header, scan.Used, repacked, labels);
+  BufferType bytes;
+  repacked.Encode(bytes, true);
+
+  // The runs are written after every block, to a temporary file that replaces the output at the end,
+  // so that a file can be repacked into itself.
+  AnalyzeObjectMapAtomicWriter writer;
+  writer.Open(outputFileName);
+  SizeValueType numberOfOutputBytes = 0;
+  const auto    writeBlock = [&writer, &bytes, &numberOfOutputBytes]() {
+    writer.Write(bytes.data(), bytes.size());
+    numberOfOutputBytes += bytes.size();
+    bytes.clear();
+  };
+  writeBlock();
+  const SizeValueType headerSize = numberOfOutputBytes;
+  RunEncoder          encoder(static_cast<SizeValueType>(header.Dimensions[0]) * header.Dimensions[1], labels, bytes);
+  VisitRuns(inputFileStream, header.DataOffset, encoder, writeBlock);
+  encoder.Flush();
+  writeBlock();
+  inputFileStream.close();
+  AnalyzeObjectLabelMapImageIO::InvalidateDerivedData(outputFileName);
+  writer.Commit();
+  AnalyzeObjectLabelMapImageIO::InvalidateDerivedData(outputFileName);
+  this->m_NumberOfInputRunBytes = scan.NumberOfRunBytes;
+  this->m_NumberOfOutputRunBytes = numberOfOutputBytes - headerSize;
+}
+
+} // end namespace itk
@@ -0,0 +1,173 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkAnalyzeObjectMapSplicer.h"
+#include "itkAnalyzeObjectLabelMapImageIO.h"
+#include "itkAnalyzeObjectMapAtomicWriter.h"
+#include "itkAnalyzeObjectPlaneIndex.h"
+#include "itkAnalyzeObjectRunLengthCodec.h"
+#include "itksys/SystemTools.hxx"
+
+#include <algorithm>
+#include <fstream>
+
+namespace itk
+{
+namespace
+{
+// Copies the bytes [begin, end) of inputStream to writer, a block at a time.  Returns false if they
+// cannot all be read.
+bool
+CopyBytes(std::istream & inputStream, AnalyzeObjectMapAtomicWriter & writer, std::streamoff begin, std::streamoff end)
+{
+  std::vector<char> block(2 * NumberOfRunLengthElementsPerRead);
+  inputStream.seekg(begin);
+  for (std::streamoff left = end - begin; left > 0;)
+  {
+    const std::streamoff length = std::min<std::streamoff>(left, block.size());
+    if (inputStream.read(block.data(), length).fail())
+    {
+      return false;
+    }
+    writer.Write(block.data(), length);
+    left -= length;
+  }
+  return true;
+}
+} // namespace
+
+void
+AnalyzeObjectMapSplicer::ReplacePlanes(const std::string &   fileName,
+                                       SizeValueType         firstPlane,
+                                       const unsigned char * voxels,
+                                       SizeValueType         numberOfPlanes)
+{
+  AnalyzeObjectMapHeaderRecord header;
+  if (!AnalyzeObjectLabelMapImageIO::ProbeHeader(fileName, header, false))
+  {
+    itkGenericExceptionMacro(<< "Error: " << fileName.c_str() << " is not an object map, or cannot be read.");
+  }
+  if (firstPlane + numberOfPlanes > static_cast<SizeValueType>(header.Dimensions[2]) * header.Dimensions[3])
+  {
+    itkGenericExceptionMacro(<< "Error: Planes " << firstPlane << " to " << firstPlane + numberOfPlanes - 1 << " of "
+                             << fileName.c_str() << " do not exist.");
+  }
+  this->Splice(fileName, firstPlane, voxels, numberOfPlanes, header.Dimensions[3]);
+}
+
+void
+AnalyzeObjectMapSplicer::ReplaceFrames(const std::string &   fileName,
+                                       SizeValueType         firstFrame,
+                                       const unsigned char * voxels,
+                                       SizeValueType         numberOfFrames)
+{
+  AnalyzeObjectMapHeaderRecord header;
+  if (!AnalyzeObjectLabelMapImageIO::ProbeHeader(fileName, header, false))
+  {
+    itkGenericExceptionMacro(<< "Error: " << fileName.c_str() << " is not an object map, or cannot be read.");
+  }
+  if (firstFrame > static_cast<SizeValueType>(header.Dimensions[3]))
+  {
+    itkGenericExceptionMacro(<< "Error: Frame " << firstFrame << " would leave a gap after the "
+                             << header.Dimensions[3] << " frames of " << fileName.c_str());
+  }
+  const SizeValueType zDimension = header.Dimensions[2];
+  this->Splice(fileName,
+               firstFrame * zDimension,
+               voxels,
+               numberOfFrames * zDimension,
+               std::max<SizeValueType>(header.Dimensions[3], firstFrame + numberOfFrames));
+}
+
+void
+AnalyzeObjectMapSplicer::AppendFrames(const std::string &   fileName,
+                                      const unsigned char * voxels,
+                                      SizeValueType         numberOfFrames)
+{
+  AnalyzeObjectMapHeaderRecord header;
+  if (!AnalyzeObjectLabelMapImageIO::ProbeHeader(fileName, header, false))
+  {
+    itkGenericExceptionMacro(<< "Error: " << fileName.c_str() << " is not an object map, or cannot be read.");
+  }
+  this->ReplaceFrames(fileName, header.Dimensions[3], voxels, numberOfFrames);
+}
+
+void
+AnalyzeObjectMapSplicer::Splice(const std::string &   fileName,
+                                SizeValueType         firstPlane,
+                                const unsigned char * voxels,
+                                SizeValueType         numberOfPlanes,
+                                SizeValueType         numberOfFrames)
+{
+  AnalyzeObjectMapHeaderRecord header;
+  if (!AnalyzeObjectLabelMapImageIO::ProbeHeader(fileName, header, true))
+  {
+    itkGenericExceptionMacro(<< "Error: " << fileName.c_str() << " is not an object map, or cannot be read.");
+  }
+  const SizeValueType planeSize = static_cast<SizeValueType>(header.Dimensions[0]) * header.Dimensions[1];
+  const SizeValueType numberOfFilePlanes = static_cast<SizeValueType>(header.Dimensions[2]) * header.Dimensions[3];
+  AnalyzeObjectPlaneIndex planeIndex;
+  std::ifstream           inputFileStream(fileName.c_str(), std::ios::binary | std::ios::in);
+  if (!planeIndex.Load(fileName + AnalyzeObjectPlaneIndex::SidecarExtension,
+                       itksys::SystemTools::FileLength(fileName),
+                       itksys::SystemTools::ModifiedTime(fileName),
+                       header.DataOffset,
+                       planeSize,
+                       numberOfFilePlanes) &&
+      !planeIndex.Build(inputFileStream, header.DataOffset, planeSize, numberOfFilePlanes))
+  {
+    itkGenericExceptionMacro(<< "The planes of " << fileName.c_str() << " can not be indexed.");
+  }
+  inputFileStream.clear();
+
+  // The header is written again only because appending frames changes its number of frames.
+  if (static_cast<SizeValueType>(header.Dimensions[3]) != numberOfFrames)
+  {
+    header.Dimensions[3] = static_cast<int>(numberOfFrames);
+    header.Version = VERSION7;
+  }
+  AnalyzeObjectRunLengthCodec::BufferType headerBytes;
+  AnalyzeObjectRunLengthCodec::BufferType runs;
+  header.Encode(headerBytes, header.BigEndian);
+  AnalyzeObjectRunLengthCodec::EncodeVolume(voxels, numberOfPlanes * planeSize, planeSize, runs);
+
+  const AnalyzeObjectPlaneIndex::OffsetType spliceBegin = planeIndex.GetPlaneOffset(firstPlane);
+  const AnalyzeObjectPlaneIndex::OffsetType spliceEnd =
+    planeIndex.GetPlaneOffset(std::min(firstPlane + numberOfPlanes, numberOfFilePlanes));
+  const AnalyzeObjectPlaneIndex::OffsetType runsEnd = planeIndex.GetPlaneOffset(numberOfFilePlanes);
+  const SizeValueType                       numberOfCopiedBytes =
+    (spliceBegin - header.DataOffset) + (runsEnd - spliceEnd);
+  AnalyzeObjectMapAtomicWriter              writer;
+  writer.Open(fileName, headerBytes.size() + runs.size() + numberOfCopiedBytes);
+  writer.Write(headerBytes.data(), headerBytes.size());
+  const bool copied = CopyBytes(inputFileStream, writer, header.DataOffset, spliceBegin);
+  writer.Write(runs.data(), runs.size());
+  if (!copied || !CopyBytes(inputFileStream, writer, spliceEnd, runsEnd))
+  {
+    writer.Abort();
+    itkGenericExceptionMacro(<< "Error: Could not splice planes into " << fileName.c_str());
+  }
+  inputFileStream.close();
+
+  AnalyzeObjectLabelMapImageIO::InvalidateDerivedData(fileName);
+  writer.Commit();
+  AnalyzeObjectLabelMapImageIO::InvalidateDerivedData(fileName);
+  this->m_NumberOfEncodedBytes = runs.size();
+  this->m_NumberOfCopiedBytes = numberOfCopiedBytes;
+}
+
+} // end namespace itk
@@ -0,0 +1,218 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkAnalyzeObjectPlaneIndex.h"
+#include "itkAnalyzeObjectMapAtomicWriter.h"
+#include "itkAnalyzeObjectRunLengthCodec.h"
+#include "itkByteSwapper.h"
+
+#include <fstream>
+
+namespace itk
+{
+namespace
+{
+// "AOBJIDX1", followed by the sidecar format version.
+constexpr std::uint64_t SidecarMagic = 0x414F424A49445831ULL;
+constexpr std::uint64_t SidecarVersion = 1;
+constexpr std::size_t   SidecarHeaderWords = 7;
+
+// FNV-1a over the values of the words, so that it does not depend on the byte order of the host.
+std::uint64_t
+SidecarChecksum(const std::vector<std::uint64_t> & words, std::size_t numberOfWords)
+{
+  std::uint64_t hash = 14695981039346656037ULL;
+  for (std::size_t i = 0; i < numberOfWords; i++)
+  {
+    for (unsigned int b = 0; b < 64; b += 8)
+    {
+      hash ^= (words[i] >> b) & 0xFF;
+      hash *= 1099511628211ULL;
+    }
+  }
+  return hash;
+}
+} // namespace
+
+bool
+AnalyzeObjectPlaneIndex::Build(std::istream & inputStream,
+                               OffsetType     dataOffset,
+                               SizeValueType  planeSize,
+                               SizeValueType  numberOfPlanes)
+{
+  this->m_PlaneOffsets.clear();
+  this->m_PlaneOffsets.reserve(numberOfPlanes + 1);
+  this->m_PlaneOffsets.push_back(dataOffset);
+  this->m_PlaneLabels.assign(numberOfPlanes * WordsPerPlane, 0);
+  this->m_PlaneSize = planeSize;
+
+  inputStream.clear();
+  inputStream.seekg(dataOffset);
+
+  // Only the run lengths are summed and the run values recorded, no voxel is expanded.
+  std::vector<unsigned char> RunLengthArray(2 * NumberOfRunLengthElementsPerRead);
+  OffsetType                 position = dataOffset;
+  SizeValueType              voxelsInPlane = 0;
+  while (this->m_PlaneOffsets.size() <= numberOfPlanes && inputStream)
+  {
+    inputStream.read(reinterpret_cast<char *>(RunLengthArray.data()), RunLengthArray.size());
+    const auto bytesRead = static_cast<SizeValueType>(inputStream.gcount()) & ~SizeValueType{ 1 };
+    for (SizeValueType i = 0; i < bytesRead && this->m_PlaneOffsets.size() <= numberOfPlanes; i += 2)
+    {
+      const SizeValueType voxel_count = RunLengthArray[i];
+      voxelsInPlane += voxel_count;
+      if (voxel_count == 0 || voxelsInPlane > planeSize)
+      {
+        this->Clear();
+        return false;
+      }
+      const unsigned char voxel_value = RunLengthArray[i + 1];
+      this->m_PlaneLabels[(this->m_PlaneOffsets.size() - 1) * WordsPerPlane + voxel_value / 64] |=
+        std::uint64_t{ 1 } << (voxel_value % 64);
+      if (voxelsInPlane == planeSize)
+      {
+        this->m_PlaneOffsets.push_back(position + static_cast<OffsetType>(i) + 2);
+        voxelsInPlane = 0;
+      }
+    }
+    position += static_cast<OffsetType>(bytesRead);
+  }
+  inputStream.clear();
+
+  if (this->m_PlaneOffsets.size() != numberOfPlanes + 1)
+  {
+    this->Clear();
+    return false;
+  }
+  return true;
+}
+
+bool
+AnalyzeObjectPlaneIndex::Save(const std::string & fileName, SizeValueType fileLength, long modifiedTime) const
+{
+  if (this->IsEmpty())
+  {
+    return false;
+  }
+  const SizeValueType        numberOfPlanes = this->GetNumberOfPlanes();
+  std::vector<std::uint64_t> words;
+  words.reserve(SidecarHeaderWords + this->m_PlaneOffsets.size() + this->m_PlaneLabels.size() + 1);
+  words.push_back(SidecarMagic);
+  words.push_back(SidecarVersion);
+  words.push_back(fileLength);
+  words.push_back(static_cast<std::uint64_t>(modifiedTime));
+  words.push_back(static_cast<std::uint64_t>(this->m_PlaneOffsets[0]));
+  words.push_back(this->m_PlaneSize);
+  words.push_back(numberOfPlanes);
+  words.insert(words.end(), this->m_PlaneOffsets.begin(), this->m_PlaneOffsets.end());
+  words.insert(words.end(), this->m_PlaneLabels.begin(), this->m_PlaneLabels.end());
+  words.push_back(SidecarChecksum(words, words.size()));
+
+  ByteSwapper<std::uint64_t>::SwapRangeFromSystemToLittleEndian(words.data(), words.size());
+  // A reader that opens the sidecar while it is written sees the old one or the new one, never a
+  // truncated one.
+  try
+  {
+    AnalyzeObjectMapAtomicWriter::WriteFile(fileName, words.data(), words.size() * sizeof(std::uint64_t));
+  }
+  catch (const ExceptionObject &)
+  {
+    return false;
+  }
+  return true;
+}
+
+bool
+AnalyzeObjectPlaneIndex::Load(const std::string & fileName,
+                              SizeValueType       fileLength,
+                              long                modifiedTime,
+                              OffsetType          dataOffset,
+                              SizeValueType       planeSize,
+                              SizeValueType       numberOfPlanes)
+{
+  this->Clear();
+  const std::size_t numberOfWords =
+    SidecarHeaderWords + (numberOfPlanes + 1) + numberOfPlanes * WordsPerPlane + 1;
+  std::vector<std::uint64_t> words(numberOfWords);
+  std::ifstream              inputFileStream(fileName.c_str(), std::ios::binary | std::ios::in);
+  inputFileStream.read(reinterpret_cast<char *>(words.data()), numberOfWords * sizeof(std::uint64_t));
+  if (inputFileStream.fail() || inputFileStream.peek() != std::ifstream::traits_type::eof())
+  {
+    return false;
+  }
+  ByteSwapper<std::uint64_t>::SwapRangeFromSystemToLittleEndian(words.data(), words.size());
+
+  if (words[0] != SidecarMagic || words[1] != SidecarVersion || words[2] != fileLength ||
+      words[3] != static_cast<std::uint64_t>(modifiedTime) || words[4] != static_cast<std::uint64_t>(dataOffset) ||
+      words[5] != planeSize || words[6] != numberOfPlanes ||
+      words[numberOfWords - 1] != SidecarChecksum(words, numberOfWords - 1))
+  {
+    return false;
+  }
+
+  const auto offsetsBegin = words.begin() + SidecarHeaderWords;
+  const auto labelsBegin = offsetsBegin + (numberOfPlanes + 1);
+  this->m_PlaneOffsets.assign(offsetsBegin, labelsBegin);
+  this->m_PlaneLabels.assign(labelsBegin, words.end() - 1);
+  this->m_PlaneSize = planeSize;
+  for (SizeValueType plane = 0; plane < numberOfPlanes; plane++)
+  {
+    if (this->m_PlaneOffsets[plane + 1] <= this->m_PlaneOffsets[plane])
+    {
+      this->Clear();
+      return false;
+    }
+  }
+  if (this->m_PlaneOffsets[0] != dataOffset ||
+      this->m_PlaneOffsets[numberOfPlanes] > static_cast<OffsetType>(fileLength))
+  {
+    this->Clear();
+    return false;
+  }
+  return true;
+}
+
+bool
+AnalyzeObjectPlaneIndex::GetPlaneUniformLabel(SizeValueType plane, unsigned char & label) const
+{
+  int found = -1;
+  for (unsigned int w = 0; w < WordsPerPlane; w++)
+  {
+    const std::uint64_t word = this->m_PlaneLabels[plane * WordsPerPlane + w];
+    if (word == 0)
+    {
+      continue;
+    }
+    if (found >= 0 || (word & (word - 1)) != 0)
+    {
+      return false;
+    }
+    found = static_cast<int>(w * 64);
+    for (std::uint64_t bit = word; bit > 1; bit >>= 1)
+    {
+      found++;
+    }
+  }
+  if (found < 0)
+  {
+    return false;
+  }
+  label = static_cast<unsigned char>(found);
+  return true;
+}
+
+} // end namespace itk
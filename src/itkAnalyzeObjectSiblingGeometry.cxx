@@ -0,0 +1,238 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkAnalyzeObjectSiblingGeometry.h"
+#include "itkImageIOFactory.h"
+#include "itksys/Directory.hxx"
+#include "itksys/SystemTools.hxx"
+
+#include <ctime>
+
+namespace itk
+{
+
+AnalyzeObjectSiblingGeometry &
+AnalyzeObjectSiblingGeometry::GetInstance()
+{
+  static AnalyzeObjectSiblingGeometry instance;
+  return instance;
+}
+
+const std::vector<std::string> &
+AnalyzeObjectSiblingGeometry::GetSiblingExtensions()
+{
+  static const std::vector<std::string> extensions{ ".nii", ".nii.gz", ".hdr" };
+  return extensions;
+}
+
+template <typename TValue>
+const TValue *
+AnalyzeObjectSiblingGeometry::LeastRecentlyUsedMap<TValue>::Find(const std::string & key)
+{
+  const auto found = this->m_Index.find(key);
+  if (found == this->m_Index.end())
+  {
+    return nullptr;
+  }
+  this->m_Values.splice(this->m_Values.begin(), this->m_Values, found->second);
+  return &found->second->second;
+}
+
+template <typename TValue>
+void
+AnalyzeObjectSiblingGeometry::LeastRecentlyUsedMap<TValue>::Insert(const std::string & key,
+                                                                   TValue              value,
+                                                                   SizeValueType       maximumNumberOfValues)
+{
+  const auto found = this->m_Index.find(key);
+  if (found != this->m_Index.end())
+  {
+    this->m_Values.erase(found->second);
+  }
+  this->m_Values.emplace_front(key, std::move(value));
+  this->m_Index[key] = this->m_Values.begin();
+  this->Evict(maximumNumberOfValues);
+}
+
+template <typename TValue>
+void
+AnalyzeObjectSiblingGeometry::LeastRecentlyUsedMap<TValue>::Evict(SizeValueType maximumNumberOfValues)
+{
+  while (this->m_Values.size() > maximumNumberOfValues)
+  {
+    this->m_Index.erase(this->m_Values.back().first);
+    this->m_Values.pop_back();
+  }
+}
+
+template <typename TValue>
+void
+AnalyzeObjectSiblingGeometry::LeastRecentlyUsedMap<TValue>::Clear()
+{
+  this->m_Values.clear();
+  this->m_Index.clear();
+}
+
+bool
+AnalyzeObjectSiblingGeometry::Find(const std::string & objectMapFileName, Geometry & geometry)
+{
+  const std::string path = itksys::SystemTools::GetFilenamePath(objectMapFileName);
+  const std::string directory = path.empty() ? std::string(".") : path;
+  const std::string stem =
+    itksys::SystemTools::GetFilenameWithoutLastExtension(itksys::SystemTools::GetFilenameName(objectMapFileName));
+  const long directoryModifiedTime = itksys::SystemTools::ModifiedTime(directory);
+
+  // The directory is listed outside of the lock, so that lookups in other directories go on.
+  std::string siblingName;
+  bool        listed = false;
+  {
+    const std::lock_guard<std::mutex> lock(this->m_Mutex);
+    const DirectoryListing *          found = this->m_Directories.Find(directory);
+    if (found != nullptr && found->ModifiedTime == directoryModifiedTime && found->ReadTime > directoryModifiedTime)
+    {
+      const auto sibling = found->Siblings.find(stem);
+      siblingName = sibling == found->Siblings.end() ? std::string() : sibling->second;
+      listed = true;
+    }
+  }
+  if (!listed)
+  {
+    DirectoryListing listing = ListDirectory(directory, directoryModifiedTime);
+    const auto       sibling = listing.Siblings.find(stem);
+    siblingName = sibling == listing.Siblings.end() ? std::string() : sibling->second;
+    const std::lock_guard<std::mutex> lock(this->m_Mutex);
+    this->m_Directories.Insert(directory, std::move(listing), this->m_MaximumNumberOfEntries);
+  }
+  if (siblingName.empty())
+  {
+    return false;
+  }
+
+  const std::string siblingFileName = path.empty() ? siblingName : path + "/" + siblingName;
+  const long        siblingModifiedTime = itksys::SystemTools::ModifiedTime(siblingFileName);
+  {
+    const std::lock_guard<std::mutex> lock(this->m_Mutex);
+    const Geometry *                  found = this->m_Geometries.Find(siblingFileName);
+    if (found != nullptr && found->ModifiedTime == siblingModifiedTime && found->ReadTime > siblingModifiedTime)
+    {
+      geometry = *found;
+      return geometry.GetNumberOfDimensions() > 0;
+    }
+  }
+
+  // A header that cannot be read is remembered as well, so that it is not read again.
+  Geometry read;
+  ReadGeometry(siblingFileName, siblingModifiedTime, read);
+  geometry = read;
+  const std::lock_guard<std::mutex> lock(this->m_Mutex);
+  this->m_Geometries.Insert(siblingFileName, std::move(read), this->m_MaximumNumberOfEntries);
+  return geometry.GetNumberOfDimensions() > 0;
+}
+
+void
+AnalyzeObjectSiblingGeometry::Clear()
+{
+  const std::lock_guard<std::mutex> lock(this->m_Mutex);
+  this->m_Directories.Clear();
+  this->m_Geometries.Clear();
+}
+
+void
+AnalyzeObjectSiblingGeometry::SetMaximumNumberOfEntries(SizeValueType maximumNumberOfEntries)
+{
+  const std::lock_guard<std::mutex> lock(this->m_Mutex);
+  this->m_MaximumNumberOfEntries = maximumNumberOfEntries;
+  this->m_Directories.Evict(maximumNumberOfEntries);
+  this->m_Geometries.Evict(maximumNumberOfEntries);
+}
+
+SizeValueType
+AnalyzeObjectSiblingGeometry::GetMaximumNumberOfEntries() const
+{
+  const std::lock_guard<std::mutex> lock(this->m_Mutex);
+  return this->m_MaximumNumberOfEntries;
+}
+
+AnalyzeObjectSiblingGeometry::DirectoryListing
+AnalyzeObjectSiblingGeometry::ListDirectory(const std::string & directory, long modifiedTime)
+{
+  DirectoryListing listing;
+  listing.ModifiedTime = modifiedTime;
+  listing.ReadTime = static_cast<long>(std::time(nullptr));
+  itksys::Directory files;
+  if (!files.Load(directory))
+  {
+    return listing;
+  }
+
+  const std::vector<std::string> &               extensions = GetSiblingExtensions();
+  std::unordered_map<std::string, SizeValueType> preference;
+  for (unsigned long i = 0; i < files.GetNumberOfFiles(); i++)
+  {
+    const std::string name = files.GetFile(i);
+    for (SizeValueType e = 0; e < extensions.size(); e++)
+    {
+      const std::string & extension = extensions[e];
+      if (name.size() <= extension.size() ||
+          name.compare(name.size() - extension.size(), extension.size(), extension) != 0)
+      {
+        continue;
+      }
+      const std::string stem = name.substr(0, name.size() - extension.size());
+      const auto        found = preference.find(stem);
+      if (found == preference.end() || e < found->second)
+      {
+        preference[stem] = e;
+        listing.Siblings[stem] = name;
+      }
+    }
+  }
+  return listing;
+}
+
+bool
+AnalyzeObjectSiblingGeometry::ReadGeometry(const std::string & fileName, long modifiedTime, Geometry & geometry)
+{
+  geometry = Geometry();
+  geometry.FileName = fileName;
+  geometry.ModifiedTime = modifiedTime;
+  geometry.ReadTime = static_cast<long>(std::time(nullptr));
+  ImageIOBase::Pointer imageIO = ImageIOFactory::CreateImageIO(fileName.c_str(), IOFileModeEnum::ReadMode);
+  if (imageIO.IsNull())
+  {
+    return false;
+  }
+  try
+  {
+    imageIO->SetFileName(fileName);
+    imageIO->ReadImageInformation();
+  }
+  catch (ExceptionObject &)
+  {
+    return false;
+  }
+  for (unsigned int d = 0; d < imageIO->GetNumberOfDimensions(); d++)
+  {
+    geometry.Size.push_back(imageIO->GetDimensions(d));
+    geometry.Spacing.push_back(imageIO->GetSpacing(d));
+    geometry.Origin.push_back(imageIO->GetOrigin(d));
+    geometry.Direction.push_back(imageIO->GetDirection(d));
+  }
+  return true;
+}
+
+} // end namespace itk
@@ -0,0 +1,159 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#  pragma warning(disable : 4786)
+#endif
+
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionIterator.h"
+
+#include "itkAnalyzeObjectLabelMapImageIO.h"
+#include "itkAnalyzeObjectPlaneIndex.h"
+#include "itksys/Directory.hxx"
+#include "itksys/SystemTools.hxx"
+
+#include <fstream>
+
+// Replaces an object map with UseAtomicWrite and UseSynchronousWrite on, and checks that the new map
+// is read back, that no temporary file is left, and that errors are thrown, whether the write is
+// atomic or not, and leave the previous map when it is atomic.
+int
+AnalyzeObjectMapAtomicWriteTest(int ac, char * av[])
+{
+  if (ac != 2)
+  {
+    std::cerr << "USAGE: " << av[0] << " <outputFileName>" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const std::string OutputObjectFileName = av[1];
+
+  using ImageType = itk::Image<unsigned short, 3>;
+  using WriterType = itk::ImageFileWriter<ImageType>;
+  using ReaderType = itk::ImageFileReader<ImageType>;
+
+  ImageType::Pointer        image = ImageType::New();
+  const ImageType::SizeType size = { { 40, 30, 5 } };
+  image->SetRegions(ImageType::RegionType(size));
+  image->Allocate();
+  image->FillBuffer(3);
+
+  itk::AnalyzeObjectLabelMapImageIO::Pointer io = itk::AnalyzeObjectLabelMapImageIO::New();
+  WriterType::Pointer                        writer = WriterType::New();
+  writer->SetImageIO(io);
+  writer->SetInput(image);
+  writer->SetFileName(OutputObjectFileName);
+  int error_count = 0;
+  try
+  {
+    writer->Update();
+
+    // The previous map has a sidecar plane index, which no longer describes the new map.
+    const std::string sidecarFileName = OutputObjectFileName + itk::AnalyzeObjectPlaneIndex::SidecarExtension;
+    std::ofstream(sidecarFileName.c_str()) << "stale";
+    itk::ImageRegionIterator<ImageType> it(image, image->GetLargestPossibleRegion());
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+      it.Set(static_cast<unsigned short>((it.GetIndex()[0] / 7 + it.GetIndex()[2]) % 4));
+    }
+    image->Modified();
+    io->UseAtomicWriteOn();
+    io->UseSynchronousWriteOn();
+    writer->Update();
+
+    ReaderType::Pointer reader = ReaderType::New();
+    reader->SetFileName(OutputObjectFileName);
+    reader->Update();
+    if (!std::equal(image->GetBufferPointer(),
+                    image->GetBufferPointer() + image->GetLargestPossibleRegion().GetNumberOfPixels(),
+                    reader->GetOutput()->GetBufferPointer()) ||
+        itksys::SystemTools::FileExists(sidecarFileName, true))
+    {
+      std::cerr << "The map was not replaced" << std::endl;
+      error_count++;
+    }
+  }
+  catch (itk::ExceptionObject & err)
+  {
+    std::cerr << "ExceptionObject caught !" << std::endl << err << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // A label that does not fit, without label compaction, and a directory that does not exist, are
+  // reported by exceptions.  A write that is not atomic has truncated the map by then.
+  const unsigned long length = itksys::SystemTools::FileLength(OutputObjectFileName);
+  int                 caught = 0;
+  image->SetPixel({ { 1, 2, 3 } }, 300);
+  io->UseLabelCompactionOff();
+  for (const bool atomic : { true, false })
+  {
+    io->SetUseAtomicWrite(atomic);
+    writer->SetFileName(OutputObjectFileName);
+    try
+    {
+      writer->Update();
+    }
+    catch (itk::ExceptionObject &)
+    {
+      caught++;
+    }
+    writer->SetFileName(OutputObjectFileName + ".missing/map.obj");
+    try
+    {
+      writer->Update();
+    }
+    catch (itk::ExceptionObject &)
+    {
+      caught++;
+    }
+    if (atomic && itksys::SystemTools::FileLength(OutputObjectFileName) != length)
+    {
+      std::cerr << "A failed atomic write changed the map" << std::endl;
+      error_count++;
+    }
+  }
+  if (caught != 4)
+  {
+    std::cerr << "A failed write was not reported" << std::endl;
+    error_count++;
+  }
+
+  // Every temporary file was renamed or removed.
+  const std::string directoryName = itksys::SystemTools::GetFilenamePath(OutputObjectFileName);
+  const std::string baseName = itksys::SystemTools::GetFilenameName(OutputObjectFileName);
+  itksys::Directory directory;
+  directory.Load(directoryName.empty() ? "." : directoryName);
+  for (unsigned long i = 0; i < directory.GetNumberOfFiles(); i++)
+  {
+    const std::string fileName = directory.GetFile(i);
+    if (fileName.compare(0, baseName.size() + 1, baseName + ".") == 0 && fileName.size() > 4 &&
+        fileName.compare(fileName.size() - 4, 4, ".tmp") == 0)
+    {
+      std::cerr << "The temporary file " << fileName << " was left" << std::endl;
+      error_count++;
+    }
+  }
+
+  if (error_count)
+  {
+    std::cerr << error_count << " errors writing atomically" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,190 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#  pragma warning(disable : 4786)
+#endif
+
+#include "itkAnalyzeObjectLabelMapImageIO.h"
+#include "itkAnalyzeObjectMapBatchReader.h"
+#include "itkMetaDataObject.h"
+
+#include <algorithm>
+#include <vector>
+
+// Reads a batch of object maps, some of them missing, through a small queue, and checks that
+// the maps come back in order and match the maps read through the ImageIO.
+int
+AnalyzeObjectMapBatchReaderTest(int ac, char * av[])
+{
+  if (ac != 2)
+  {
+    std::cerr << "USAGE: " << av[0] << " <inputFileName>" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const std::string InputObjectFileName = av[1];
+
+  using ImageType = itk::Image<unsigned char, 3>;
+  using RGBImageType = itk::Image<itk::RGBPixel<unsigned char>, 3>;
+  using ObjectMapType = itk::AnalyzeObjectMap<ImageType, RGBImageType>;
+  using BatchReaderType = itk::AnalyzeObjectMapBatchReader<ObjectMapType>;
+
+  std::vector<unsigned char>       expected;
+  itk::AnalyzeObjectEntryArrayType expectedEntries;
+  try
+  {
+    itk::AnalyzeObjectLabelMapImageIO::Pointer io = itk::AnalyzeObjectLabelMapImageIO::New();
+    io->SetFileName(InputObjectFileName);
+    io->ReadImageInformation();
+    expected.resize(io->GetImageSizeInPixels());
+    io->Read(expected.data());
+    itk::ExposeMetaData<itk::AnalyzeObjectEntryArrayType>(
+      io->GetMetaDataDictionary(), itk::ANALYZE_OBJECT_LABEL_MAP_ENTRY_ARRAY, expectedEntries);
+  }
+  catch (itk::ExceptionObject & err)
+  {
+    std::cerr << "ExceptionObject caught !" << std::endl << err << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  BatchReaderType::FileNamesContainer fileNames;
+  for (unsigned int i = 0; i < 24; i++)
+  {
+    fileNames.push_back(i % 7 == 5 ? InputObjectFileName + ".missing" : InputObjectFileName);
+  }
+
+  int                      error_count = 0;
+  BatchReaderType::Pointer reader = BatchReaderType::New();
+  reader->SetFileNames(fileNames);
+  reader->SetNumberOfWorkUnits(3);
+  reader->SetQueueCapacity(2);
+  reader->Start();
+
+  unsigned int numberOfMaps = 0;
+  unsigned int numberOfErrors = 0;
+  while (true)
+  {
+    ObjectMapType::Pointer objectMap;
+    std::string            fileName;
+    const unsigned int     i = numberOfMaps + numberOfErrors;
+    try
+    {
+      if (!reader->GetNext(objectMap, &fileName))
+      {
+        break;
+      }
+    }
+    catch (itk::ExceptionObject &)
+    {
+      if (i % 7 != 5)
+      {
+        std::cerr << "Reading file " << i << " threw" << std::endl;
+        error_count++;
+      }
+      numberOfErrors++;
+      continue;
+    }
+    numberOfMaps++;
+    if (i % 7 == 5 || fileName != fileNames[i])
+    {
+      std::cerr << "File " << i << " was returned out of order" << std::endl;
+      error_count++;
+      continue;
+    }
+
+    const ImageType::SizeType size = objectMap->GetLargestPossibleRegion().GetSize();
+    if (size[0] * size[1] * size[2] != expected.size() ||
+        !std::equal(expected.begin(), expected.end(), objectMap->GetBufferPointer()))
+    {
+      std::cerr << "The voxels of file " << i << " differ" << std::endl;
+      error_count++;
+    }
+    itk::AnalyzeObjectEntryArrayType entries;
+    itk::ExposeMetaData<itk::AnalyzeObjectEntryArrayType>(
+      objectMap->GetMetaDataDictionary(), itk::ANALYZE_OBJECT_LABEL_MAP_ENTRY_ARRAY, entries);
+    if (entries.size() != expectedEntries.size() || objectMap->GetNumberOfObjects() != static_cast<int>(entries.size()))
+    {
+      std::cerr << "The entries of file " << i << " differ" << std::endl;
+      error_count++;
+      continue;
+    }
+    for (unsigned int e = 0; e < entries.size(); e++)
+    {
+      if (entries[e]->GetName() != expectedEntries[e]->GetName() ||
+          entries[e]->GetEndGreen() != expectedEntries[e]->GetEndGreen() ||
+          entries[e]->GetOpacity() != expectedEntries[e]->GetOpacity())
+      {
+        std::cerr << "Entry " << e << " of file " << i << " differs" << std::endl;
+        error_count++;
+      }
+    }
+  }
+  if (numberOfMaps != 21 || numberOfErrors != 3)
+  {
+    std::cerr << numberOfMaps << " maps and " << numberOfErrors << " errors were returned" << std::endl;
+    error_count++;
+  }
+
+  // A reader stopped half way through can be restarted, and a destroyed one stops its threads.
+  reader->SetFileNames(BatchReaderType::FileNamesContainer(6, InputObjectFileName));
+  reader->Start();
+  ObjectMapType::Pointer objectMap;
+  reader->GetNext(objectMap);
+  reader->Start();
+  unsigned int numberOfRestartedMaps = 0;
+  while (reader->GetNext(objectMap))
+  {
+    numberOfRestartedMaps++;
+  }
+  if (numberOfRestartedMaps != 6)
+  {
+    std::cerr << numberOfRestartedMaps << " maps were returned after a restart" << std::endl;
+    error_count++;
+  }
+
+  // Through the cache the first map is decoded and cached, the others are copied out of the cache.
+  itk::AnalyzeObjectMapCache::GetInstance().Clear();
+  reader->UseCacheOn();
+  reader->Start();
+  numberOfRestartedMaps = 0;
+  while (reader->GetNext(objectMap))
+  {
+    if (!std::equal(expected.begin(), expected.end(), objectMap->GetBufferPointer()))
+    {
+      std::cerr << "The voxels read through the cache differ" << std::endl;
+      error_count++;
+    }
+    numberOfRestartedMaps++;
+  }
+  if (numberOfRestartedMaps != 6 || itk::AnalyzeObjectMapCache::GetInstance().GetNumberOfCachedMaps() != 1)
+  {
+    std::cerr << numberOfRestartedMaps << " maps were read through the cache" << std::endl;
+    error_count++;
+  }
+  itk::AnalyzeObjectMapCache::GetInstance().Clear();
+
+  reader->Start();
+  reader = nullptr;
+
+  if (error_count)
+  {
+    std::cerr << error_count << " errors reading a batch of object maps" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
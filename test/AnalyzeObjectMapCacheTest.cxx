@@ -0,0 +1,198 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#  pragma warning(disable : 4786)
+#endif
+
+#include "itkAnalyzeObjectLabelMapImageIO.h"
+#include "itkMetaDataObject.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+// Reads the whole file through a new IO, returning the IO.
+itk::AnalyzeObjectLabelMapImageIO::Pointer
+ReadObjectMap(const char * fileName, bool useCache, std::vector<unsigned short> & voxels)
+{
+  itk::AnalyzeObjectLabelMapImageIO::Pointer io = itk::AnalyzeObjectLabelMapImageIO::New();
+  io->SetFileName(fileName);
+  io->SetUseCache(useCache);
+  io->SetOutputComponentType(itk::IOComponentEnum::USHORT);
+  io->ReadImageInformation();
+  voxels.assign(io->GetImageSizeInPixels(), 0);
+  io->Read(voxels.data());
+  return io;
+}
+
+std::string
+GetFirstEntryName(itk::AnalyzeObjectLabelMapImageIO * io)
+{
+  itk::AnalyzeObjectEntryArrayType entries;
+  itk::ExposeMetaData<itk::AnalyzeObjectEntryArrayType>(
+    io->GetMetaDataDictionary(), itk::ANALYZE_OBJECT_LABEL_MAP_ENTRY_ARRAY, entries);
+  return entries.empty() ? std::string() : entries[0]->GetName();
+}
+} // namespace
+
+// Reads an object map repeatedly through the object map cache, checking that the cached voxels
+// and entries are shared or copied as documented, and that eviction and invalidation work.
+int
+AnalyzeObjectMapCacheTest(int ac, char * av[])
+{
+  if (ac != 3)
+  {
+    std::cerr << "USAGE: " << av[0] << " <inputFileName> <outputFileName>" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const char * InputObjectFileName = av[1];
+  const char * OutputObjectFileName = av[2];
+
+  itk::AnalyzeObjectMapCache & cache = itk::AnalyzeObjectMapCache::GetInstance();
+  cache.Clear();
+
+  int error_count = 0;
+  try
+  {
+    std::vector<unsigned short> expected, first, second;
+    ReadObjectMap(InputObjectFileName, false, expected);
+    itk::AnalyzeObjectLabelMapImageIO::Pointer firstIO = ReadObjectMap(InputObjectFileName, true, first);
+    if (cache.GetNumberOfCachedMaps() != 1 || firstIO->GetCachedVoxels().IsNull())
+    {
+      std::cerr << "The decoded object map was not cached" << std::endl;
+      error_count++;
+    }
+
+    // Renaming an entry of the first reader must not be seen by the next one.
+    itk::AnalyzeObjectEntryArrayType entries;
+    itk::ExposeMetaData<itk::AnalyzeObjectEntryArrayType>(
+      firstIO->GetMetaDataDictionary(), itk::ANALYZE_OBJECT_LABEL_MAP_ENTRY_ARRAY, entries);
+    const std::string originalName = entries[0]->GetName();
+    entries[0]->SetName("Renamed");
+
+    itk::AnalyzeObjectLabelMapImageIO::Pointer secondIO = ReadObjectMap(InputObjectFileName, true, second);
+    if (secondIO->ReadSharedVoxels() != firstIO->GetCachedVoxels())
+    {
+      std::cerr << "The cached voxels were not shared" << std::endl;
+      error_count++;
+    }
+    if (GetFirstEntryName(secondIO) != originalName)
+    {
+      std::cerr << "A change to the entries of one reader reached the cache" << std::endl;
+      error_count++;
+    }
+    if (first != expected || second != expected)
+    {
+      std::cerr << "The cached voxels differ from the decoded voxels" << std::endl;
+      error_count++;
+    }
+
+    // A region is copied out of the cached voxels.
+    itk::ImageIORegion region(3);
+    region.SetIndex(0, 1);
+    region.SetIndex(1, 2);
+    region.SetIndex(2, 1);
+    region.SetSize(0, secondIO->GetDimensions(0) - 2);
+    region.SetSize(1, 3);
+    region.SetSize(2, 2);
+    secondIO->SetIORegion(region);
+    std::vector<unsigned short> regionVoxels(region.GetNumberOfPixels());
+    secondIO->Read(regionVoxels.data());
+    for (unsigned int z = 0, index = 0; z < 2; z++)
+    {
+      for (unsigned int y = 0; y < 3; y++)
+      {
+        for (unsigned int x = 0; x < region.GetSize(0); x++, index++)
+        {
+          const unsigned int wholeIndex =
+            ((z + 1) * secondIO->GetDimensions(1) + y + 2) * secondIO->GetDimensions(0) + x + 1;
+          if (regionVoxels[index] != expected[wholeIndex])
+          {
+            error_count++;
+          }
+        }
+      }
+    }
+
+    // Writing a cached file evicts it.
+    std::vector<unsigned char> narrowVoxels(expected.begin(), expected.end());
+    itk::AnalyzeObjectLabelMapImageIO::Pointer writeIO = itk::AnalyzeObjectLabelMapImageIO::New();
+    writeIO->SetNumberOfDimensions(3);
+    for (unsigned int d = 0; d < 3; d++)
+    {
+      writeIO->SetDimensions(d, firstIO->GetDimensions(d));
+    }
+    writeIO->SetComponentType(itk::IOComponentEnum::UCHAR);
+    writeIO->SetFileName(OutputObjectFileName);
+    writeIO->Write(narrowVoxels.data());
+    ReadObjectMap(OutputObjectFileName, true, second);
+    if (cache.GetNumberOfCachedMaps() != 2)
+    {
+      std::cerr << "The written object map was not cached" << std::endl;
+      error_count++;
+    }
+    writeIO->Write(narrowVoxels.data());
+    if (cache.GetNumberOfCachedMaps() != 1)
+    {
+      std::cerr << "Writing an object map did not evict it from the cache" << std::endl;
+      error_count++;
+    }
+
+    // A region of a file that is not cached is streamed, without caching the file.
+    itk::AnalyzeObjectLabelMapImageIO::Pointer regionIO = itk::AnalyzeObjectLabelMapImageIO::New();
+    regionIO->SetFileName(OutputObjectFileName);
+    regionIO->UseCacheOn();
+    regionIO->ReadImageInformation();
+    regionIO->SetIORegion(region);
+    regionIO->Read(regionVoxels.data());
+    if (cache.GetNumberOfCachedMaps() != 1 || regionIO->GetCachedVoxels().IsNotNull())
+    {
+      std::cerr << "Reading a region of an object map that is not cached cached it" << std::endl;
+      error_count++;
+    }
+    itk::AnalyzeObjectMapCache::VoxelContainerType::ConstPointer sharedVoxels = regionIO->ReadSharedVoxels();
+    if (cache.GetNumberOfCachedMaps() != 2 ||
+        !std::equal(narrowVoxels.begin(), narrowVoxels.end(), sharedVoxels->GetBufferPointer()))
+    {
+      std::cerr << "The shared voxels were not decoded and cached" << std::endl;
+      error_count++;
+    }
+
+    // Lowering the budget evicts everything.
+    cache.SetMaximumSizeInBytes(0);
+    if (cache.GetNumberOfCachedMaps() != 0 || cache.GetSizeInBytes() != 0)
+    {
+      std::cerr << "Lowering the budget did not evict the cached maps" << std::endl;
+      error_count++;
+    }
+  }
+  catch (itk::ExceptionObject & err)
+  {
+    std::cerr << "ExceptionObject caught !" << std::endl << err << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (error_count)
+  {
+    std::cerr << error_count << " errors reading through the object map cache" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
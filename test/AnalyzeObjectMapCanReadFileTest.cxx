@@ -0,0 +1,131 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#  pragma warning(disable : 4786)
+#endif
+
+#include "itkAnalyzeObjectLabelMapImageIO.h"
+
+#include <fstream>
+#include <vector>
+
+// Checks that CanReadFile() looks at the content of .obj files: object maps of either byte order
+// are accepted, Wavefront meshes and truncated files are not, and reading them throws.
+int
+AnalyzeObjectMapCanReadFileTest(int ac, char * av[])
+{
+  if (ac != 5)
+  {
+    std::cerr << "USAGE: " << av[0]
+              << " <inputFileName> <wavefrontFileName> <truncatedFileName> <littleEndianFileName>" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const char * InputObjectFileName = av[1];
+  const char * WavefrontFileName = av[2];
+  const char * TruncatedFileName = av[3];
+  const char * LittleEndianFileName = av[4];
+
+  {
+    std::ofstream wavefront(WavefrontFileName);
+    wavefront << "# A Wavefront mesh\nv 0.0 0.0 0.0\nv 1.0 0.0 0.0\nv 0.0 1.0 0.0\nf 1 2 3\n";
+  }
+  {
+    std::ofstream truncated(TruncatedFileName, std::ios::binary);
+    const unsigned char version7[] = { 0x01, 0x31, 0xF3, 0x8D, 0, 0, 0 };
+    truncated.write(reinterpret_cast<const char *>(version7), sizeof(version7));
+  }
+  {
+    // A little endian VERSION7 map of 4x2 voxels with one entry, all background.
+    std::ofstream     littleEndian(LittleEndianFileName, std::ios::binary);
+    const int         header[6] = { itk::VERSION7, 4, 2, 1, 1, 1 };
+    std::vector<char> bytes;
+    for (int value : header)
+    {
+      for (unsigned int b = 0; b < 4; b++)
+      {
+        bytes.push_back(static_cast<char>(static_cast<unsigned int>(value) >> (8 * b)));
+      }
+    }
+    bytes.resize(bytes.size() + itk::AnalyzeObjectEntryRecord::SizeInFile, 0);
+    bytes.push_back(8);
+    bytes.push_back(0);
+    littleEndian.write(bytes.data(), bytes.size());
+  }
+
+  int                                        error_count = 0;
+  itk::AnalyzeObjectLabelMapImageIO::Pointer io = itk::AnalyzeObjectLabelMapImageIO::New();
+  if (!io->CanReadFile(InputObjectFileName) || !io->CanReadFile(LittleEndianFileName))
+  {
+    std::cerr << "An object map was not recognized" << std::endl;
+    error_count++;
+  }
+  if (io->CanReadFile(WavefrontFileName) || io->CanReadFile(TruncatedFileName))
+  {
+    std::cerr << "A file that is not an object map was claimed" << std::endl;
+    error_count++;
+  }
+
+  // The header sniffed by CanReadFile() is used by the next ReadImageInformation().
+  try
+  {
+    io->SetFileName(LittleEndianFileName);
+    if (!io->CanReadFile(LittleEndianFileName))
+    {
+      error_count++;
+    }
+    io->ReadImageInformation();
+    std::vector<unsigned char> voxels(io->GetImageSizeInPixels(), 1);
+    io->Read(voxels.data());
+    if (io->GetNumberOfDimensions() != 2 || io->GetDimensions(0) != 4 || io->GetDimensions(1) != 2 ||
+        voxels != std::vector<unsigned char>(8, 0))
+    {
+      std::cerr << "The little endian object map was not read" << std::endl;
+      error_count++;
+    }
+  }
+  catch (itk::ExceptionObject & err)
+  {
+    std::cerr << "ExceptionObject caught !" << std::endl << err << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Reading a file that is not an object map throws instead of exiting.
+  bool caught = false;
+  try
+  {
+    io->SetFileName(WavefrontFileName);
+    io->ReadImageInformation();
+  }
+  catch (itk::ExceptionObject &)
+  {
+    caught = true;
+  }
+  if (!caught)
+  {
+    std::cerr << "Reading a Wavefront mesh did not throw" << std::endl;
+    error_count++;
+  }
+
+  if (error_count)
+  {
+    std::cerr << error_count << " errors recognizing object maps" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
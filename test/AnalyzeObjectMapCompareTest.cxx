@@ -0,0 +1,176 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#  pragma warning(disable : 4786)
+#endif
+
+#include "itkAnalyzeObjectMapComparator.h"
+#include "itkAnalyzeObjectEntry.h"
+#include "itkAnalyzeObjectEntryTable.h"
+#include "itkAnalyzeObjectRunLengthCodec.h"
+
+#include <cmath>
+#include <vector>
+
+namespace
+{
+using BufferType = std::vector<unsigned char>;
+
+// Encodes the header of an object map with the entries of table.
+BufferType
+EncodeHeader(const int dimensions[4], const itk::AnalyzeObjectEntryTable & table)
+{
+  itk::AnalyzeObjectMapHeaderRecord header;
+  header.Version = itk::VERSION7;
+  std::copy(dimensions, dimensions + 4, header.Dimensions);
+  header.Entries = table.GetRecords();
+  BufferType bytes;
+  header.Encode(bytes, true);
+  return bytes;
+}
+} // namespace
+
+// Compares object maps that differ in an entry, in a voxel, in their size or only in the way their
+// runs are split, and an object map file with itself.
+int
+AnalyzeObjectMapCompareTest(int ac, char * av[])
+{
+  if (ac != 2)
+  {
+    std::cerr << "USAGE: " << av[0] << " <inputFileName>" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const char * InputObjectFileName = av[1];
+
+  int                             error_count = 0;
+  itk::AnalyzeObjectMapComparator comparator;
+  try
+  {
+    comparator.CompareFiles(InputObjectFileName, InputObjectFileName);
+  }
+  catch (itk::ExceptionObject & err)
+  {
+    std::cerr << "ExceptionObject caught !" << std::endl << err << std::endl;
+    return EXIT_FAILURE;
+  }
+  itk::SizeValueType plane = 0;
+  itk::SizeValueType row = 0;
+  if (!comparator.IsEqual() || comparator.GetFirstDifference(plane, row) ||
+      comparator.GetLabelStatistics()[0].GetDice() != 1.0 || comparator.GetLabelStatistics()[0].FirstVoxels == 0)
+  {
+    std::cerr << "A file differs from itself" << std::endl;
+    comparator.Print(std::cerr);
+    error_count++;
+  }
+
+  // Planes of 10 by 4 voxels: label 1 fills the first half of every plane, label 2 the rest.
+  const int                    dimensions[4] = { 10, 4, 3, 1 };
+  const itk::SizeValueType     numberOfVoxels = 10 * 4 * 3;
+  itk::AnalyzeObjectEntryTable table;
+  table.AddEntry("Background");
+  table.AddEntry("Left");
+  table.AddEntry("Right");
+  BufferType firstVoxels(numberOfVoxels);
+  for (itk::SizeValueType i = 0; i < numberOfVoxels; i++)
+  {
+    firstVoxels[i] = i % 40 < 20 ? 1 : 2;
+  }
+  BufferType first = EncodeHeader(dimensions, table);
+  itk::AnalyzeObjectRunLengthCodec::EncodeVolume(firstVoxels.data(), numberOfVoxels, 40, first);
+
+  // The voxel 5 of row 1 of plane 2 is moved from the first label to the second, and the opacity
+  // of the second entry is changed.
+  BufferType secondVoxels = firstVoxels;
+  secondVoxels[2 * 40 + 15] = 2;
+  itk::AnalyzeObjectEntryTable secondTable = table;
+  secondTable[2].SetOpacity(0.25f);
+  BufferType second = EncodeHeader(dimensions, secondTable);
+  itk::AnalyzeObjectRunLengthCodec::EncodeVolume(secondVoxels.data(), numberOfVoxels, 40, second);
+
+  comparator.Compare(first.data(), first.size(), second.data(), second.size());
+  const itk::AnalyzeObjectMapComparator::LabelStatistics & left = comparator.GetLabelStatistics()[1];
+  const itk::AnalyzeObjectMapComparator::LabelStatistics & right = comparator.GetLabelStatistics()[2];
+  if (comparator.GetHeaderDifferences() != std::vector<std::string>{ "Entries[2].Opacity" })
+  {
+    std::cerr << "The header differences are wrong" << std::endl;
+    comparator.Print(std::cerr);
+    error_count++;
+  }
+  if (!comparator.GetFirstDifference(plane, row) || plane != 2 || row != 1)
+  {
+    std::cerr << "The first difference is at plane " << plane << ", row " << row << std::endl;
+    error_count++;
+  }
+  if (left.FirstVoxels != 60 || left.SecondVoxels != 59 || left.GetVoxelDelta() != -1 || right.GetVoxelDelta() != 1 ||
+      std::abs(left.GetDice() - 118.0 / 119.0) > 1e-12 || right.CommonVoxels != 60)
+  {
+    std::cerr << "The label statistics are wrong" << std::endl;
+    comparator.Print(std::cerr);
+    error_count++;
+  }
+
+  // The same voxels with runs split differently.
+  BufferType split = EncodeHeader(dimensions, table);
+  for (unsigned int p = 0; p < 3; p++)
+  {
+    const unsigned char runs[] = { 5, 1, 15, 1, 20, 2 };
+    split.insert(split.end(), runs, runs + sizeof(runs));
+  }
+  comparator.Compare(first.data(), first.size(), split.data(), split.size());
+  if (!comparator.IsEqual())
+  {
+    std::cerr << "Runs split differently were reported as different" << std::endl;
+    error_count++;
+  }
+
+  // Maps of different sizes only have their headers compared.
+  const int  otherDimensions[4] = { 10, 4, 2, 1 };
+  BufferType other = EncodeHeader(otherDimensions, table);
+  itk::AnalyzeObjectRunLengthCodec::EncodeVolume(firstVoxels.data(), 80, 40, other);
+  comparator.Compare(first.data(), first.size(), other.data(), other.size());
+  if (comparator.GetHeaderDifferences() != std::vector<std::string>{ "Dimensions[2]" } ||
+      comparator.VoxelsAreEqual() || comparator.GetLabelStatistics()[1].FirstVoxels != 0)
+  {
+    std::cerr << "Maps of different sizes were compared wrongly" << std::endl;
+    error_count++;
+  }
+
+  // A truncated run stream is an error.
+  bool caught = false;
+  try
+  {
+    comparator.Compare(first.data(), first.size(), split.data(), split.size() - 2);
+  }
+  catch (itk::ExceptionObject &)
+  {
+    caught = true;
+  }
+  if (!caught)
+  {
+    std::cerr << "A truncated map was compared" << std::endl;
+    error_count++;
+  }
+
+  if (error_count)
+  {
+    std::cerr << error_count << " errors comparing object maps" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
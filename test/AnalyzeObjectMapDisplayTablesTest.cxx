@@ -0,0 +1,112 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#  pragma warning(disable : 4786)
+#endif
+
+#include "itkAnalyzeObjectMap.h"
+
+// Checks that the display tables of an object map follow its entries as they are changed, added,
+// replaced and removed, and that the RGB image is colored from them.
+int
+AnalyzeObjectMapDisplayTablesTest(int, char *[])
+{
+  using ImageType = itk::Image<unsigned char, 3>;
+  using RGBImageType = itk::Image<itk::RGBPixel<unsigned char>, 3>;
+  using ObjectMapType = itk::AnalyzeObjectMap<ImageType, RGBImageType>;
+
+  int                    error_count = 0;
+  ObjectMapType::Pointer objectMap = ObjectMapType::New();
+  objectMap->AddAnalyzeObjectEntry("Red");
+  objectMap->AddAnalyzeObjectEntry("Hidden");
+  objectMap->GetObjectEntry(1)->SetEndRed(300);
+  objectMap->GetObjectEntry(1)->SetEndBlue(-4);
+  objectMap->GetObjectEntry(1)->SetOpacity(1.0f);
+  objectMap->GetObjectEntry(1)->SetShades(7);
+  objectMap->GetObjectEntry(2)->SetEndGreen(90);
+  objectMap->GetObjectEntry(2)->SetDisplayFlag(0);
+  objectMap->GetObjectEntry(2)->SetBlendFactor(0.25f);
+
+  const ObjectMapType::DisplayTables & tables = objectMap->GetDisplayTables();
+  if (tables.RGBA[4] != 255 || tables.RGBA[5] != 0 || tables.RGBA[6] != 0 || tables.RGBA[7] != 255 ||
+      tables.Shades[1] != 7 || !tables.Visible[1])
+  {
+    std::cerr << "The first entry was not packed" << std::endl;
+    error_count++;
+  }
+  if (tables.RGBA[9] != 90 || tables.RGBA[11] != 0 || tables.Opacity[2] != 0.5f || tables.BlendFactor[2] != 0.25f ||
+      tables.Visible[2])
+  {
+    std::cerr << "The hidden entry was not packed" << std::endl;
+    error_count++;
+  }
+  if (tables.RGBA[4 * 3 + 3] != 0 || tables.Visible[3] || tables.Visible.count() != 2)
+  {
+    std::cerr << "A label without an entry is not transparent" << std::endl;
+    error_count++;
+  }
+
+  // A modified entry.
+  objectMap->GetObjectEntry(2)->SetDisplayFlag(1);
+  if (!objectMap->GetDisplayTables().Visible[2] || objectMap->GetDisplayTables().RGBA[11] != 128)
+  {
+    std::cerr << "A modified entry was not repacked" << std::endl;
+    error_count++;
+  }
+
+  // Entries exchanged without being modified.
+  itk::AnalyzeObjectEntryArrayType & entries = *objectMap->GetAnalyzeObjectEntryArrayPointer();
+  std::swap(entries[1], entries[2]);
+  if (objectMap->GetDisplayTables().RGBA[4] != 0 || objectMap->GetDisplayTables().RGBA[8] != 255)
+  {
+    std::cerr << "Exchanged entries were not repacked" << std::endl;
+    error_count++;
+  }
+
+  // A removed entry.
+  objectMap->DeleteAnalyzeObjectEntry("Hidden");
+  if (objectMap->GetDisplayTables().RGBA[4] != 255 || objectMap->GetDisplayTables().Visible[2])
+  {
+    std::cerr << "A removed entry was not unpacked" << std::endl;
+    error_count++;
+  }
+
+  // The RGB image is colored from the tables.
+  ImageType::RegionType region;
+  region.SetSize({ { 2, 1, 1 } });
+  objectMap->SetRegions(region);
+  objectMap->Allocate();
+  objectMap->FillBuffer(0);
+  ImageType::IndexType index = { { 1, 0, 0 } };
+  objectMap->SetPixel(index, 1);
+  RGBImageType::Pointer rgb = objectMap->ObjectMapToRGBImage();
+  if (rgb->GetPixel(index).GetRed() != 255 || rgb->GetPixel(index).GetBlue() != 0 ||
+      rgb->GetPixel({ { 0, 0, 0 } }).GetRed() != 0)
+  {
+    std::cerr << "The RGB image was not colored from the tables" << std::endl;
+    error_count++;
+  }
+
+  if (error_count)
+  {
+    std::cerr << error_count << " errors packing display tables" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
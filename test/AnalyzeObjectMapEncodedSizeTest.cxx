@@ -0,0 +1,138 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#  pragma warning(disable : 4786)
+#endif
+
+#include "itkImageFileWriter.h"
+#include "itkImageRegionIterator.h"
+
+#include "itkAnalyzeObjectLabelMapImageIO.h"
+#include "itkAnalyzeObjectEntryTable.h"
+#include "itkMetaDataObject.h"
+#include "itksys/SystemTools.hxx"
+
+// Computes the encoded size of label images, with runs longer than 255 voxels, with labels that
+// are compacted and with the entries of a table, on one and several threads, and checks it against
+// the length of the files written.
+int
+AnalyzeObjectMapEncodedSizeTest(int ac, char * av[])
+{
+  if (ac != 2)
+  {
+    std::cerr << "USAGE: " << av[0] << " <outputFileName>" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const char * OutputObjectFileName = av[1];
+
+  using ImageType = itk::Image<unsigned short, 3>;
+  using WriterType = itk::ImageFileWriter<ImageType>;
+
+  ImageType::Pointer        image = ImageType::New();
+  const ImageType::SizeType size = { { 255, 4, 7 } };
+  image->SetRegions(ImageType::RegionType(size));
+  image->Allocate();
+  itk::ImageRegionIterator<ImageType> it(image, image->GetLargestPossibleRegion());
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+  {
+    // Even planes hold a single label, so runs of 4 * 255 voxels, plane 3 runs of 400 and 620 voxels,
+    // and the other planes short runs.
+    const ImageType::IndexType index = it.GetIndex();
+    unsigned short             label = static_cast<unsigned short>((index[0] / 3 + index[1]) % 5);
+    if (index[2] % 2 == 0)
+    {
+      label = static_cast<unsigned short>(index[2] % 3);
+    }
+    else if (index[2] == 3)
+    {
+      label = index[0] + index[1] * size[0] < 400 ? 1 : 2;
+    }
+    it.Set(label);
+  }
+
+  itk::AnalyzeObjectLabelMapImageIO::Pointer io = itk::AnalyzeObjectLabelMapImageIO::New();
+  io->SetNumberOfDimensions(3);
+  for (unsigned int d = 0; d < 3; d++)
+  {
+    io->SetDimensions(d, size[d]);
+  }
+  io->SetComponentType(itk::IOComponentEnum::USHORT);
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetImageIO(io);
+  writer->SetInput(image);
+  writer->SetFileName(OutputObjectFileName);
+  int error_count = 0;
+  try
+  {
+    // 256 blank entries, then the entries of a table, then entries of compacted labels.
+    for (int pass = 0; pass < 3; pass++)
+    {
+      if (pass == 1)
+      {
+        itk::AnalyzeObjectEntryTable table;
+        table.AddEntry("Background");
+        table.AddEntry("Rows");
+        itk::EncapsulateMetaData<itk::AnalyzeObjectEntryTable>(
+          image->GetMetaDataDictionary(), itk::ANALYZE_OBJECT_LABEL_MAP_ENTRY_TABLE, table);
+        io->SetMetaDataDictionary(image->GetMetaDataDictionary());
+      }
+      else if (pass == 2)
+      {
+        for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+        {
+          it.Set(static_cast<unsigned short>(it.Get() * 1000));
+        }
+        image->Modified();
+      }
+      const itk::SizeValueType single = io->ComputeEncodedSizeInBytes(image->GetBufferPointer(), 1);
+      const itk::SizeValueType threaded = io->ComputeEncodedSizeInBytes(image->GetBufferPointer(), 3);
+      writer->Update();
+      if (single != threaded || single != itksys::SystemTools::FileLength(OutputObjectFileName))
+      {
+        std::cerr << "Pass " << pass << ": sizes of " << single << " and " << threaded
+                  << " bytes computed for a file of " << itksys::SystemTools::FileLength(OutputObjectFileName)
+                  << " bytes" << std::endl;
+        error_count++;
+      }
+    }
+  }
+  catch (itk::ExceptionObject & err)
+  {
+    std::cerr << "ExceptionObject caught !" << std::endl << err << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Labels that cannot be written without compaction are reported, as by Write().
+  io->UseLabelCompactionOff();
+  try
+  {
+    io->ComputeEncodedSizeInBytes(image->GetBufferPointer());
+    std::cerr << "Labels above 255 were not reported" << std::endl;
+    error_count++;
+  }
+  catch (itk::ExceptionObject &)
+  {}
+
+  if (error_count)
+  {
+    std::cerr << error_count << " errors computing encoded sizes" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,173 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#  pragma warning(disable : 4786)
+#endif
+
+#include "itkAnalyzeObjectLabelMapImageIO.h"
+#include "itkMetaDataObject.h"
+
+#include <cstring>
+#include <vector>
+
+namespace
+{
+// Returns true if the fields of both entries are the same.
+bool
+SameEntry(const itk::AnalyzeObjectEntry * a, const itk::AnalyzeObjectEntry * b)
+{
+  return a->GetName() == b->GetName() && a->GetDisplayFlag() == b->GetDisplayFlag() &&
+         a->GetStartRed() == b->GetStartRed() && a->GetEndBlue() == b->GetEndBlue() &&
+         a->GetZTranslationIncrement() == b->GetZTranslationIncrement() &&
+         a->GetMinimumXValue() == b->GetMinimumXValue() && a->GetMaximumZValue() == b->GetMaximumZValue() &&
+         a->GetOpacity() == b->GetOpacity() && a->GetOpacityThickness() == b->GetOpacityThickness() &&
+         a->GetBlendFactor() == b->GetBlendFactor();
+}
+} // namespace
+
+// Writes the same entries twice and checks that writing leaves them unchanged and that they are
+// read back as written, then encodes and decodes entry records in both byte orders.
+int
+AnalyzeObjectMapEntryEncodeTest(int ac, char * av[])
+{
+  if (ac != 2)
+  {
+    std::cerr << "USAGE: " << av[0] << " <outputFileName>" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const char * ObjectFileName = av[1];
+
+  itk::AnalyzeObjectEntryArrayType entries(3);
+  for (unsigned int i = 0; i < entries.size(); i++)
+  {
+    entries[i] = itk::AnalyzeObjectEntry::New();
+    entries[i]->SetName("Entry " + std::to_string(i));
+    entries[i]->SetDisplayFlag(1 + i);
+    entries[i]->SetStartRed(0x01020304 + i);
+    entries[i]->SetEndBlue(-7 - static_cast<int>(i));
+    entries[i]->SetZTranslationIncrement(1000000 + i);
+    entries[i]->SetMinimumXValue(static_cast<short int>(-300 + i));
+    entries[i]->SetMaximumZValue(static_cast<short int>(0x0102 + i));
+    entries[i]->SetOpacity(0.25f + i);
+    entries[i]->SetOpacityThickness(3 + i);
+    entries[i]->SetBlendFactor(0.125f * i);
+  }
+  itk::AnalyzeObjectEntryArrayType original(entries.size());
+  for (unsigned int i = 0; i < entries.size(); i++)
+  {
+    original[i] = itk::AnalyzeObjectEntry::New();
+    original[i]->Copy(entries[i]);
+    original[i]->SetName(entries[i]->GetName());
+  }
+
+  int                        error_count = 0;
+  std::vector<unsigned char> voxels(6 * 5, 2);
+  try
+  {
+    for (unsigned int write = 0; write < 2; write++)
+    {
+      itk::AnalyzeObjectLabelMapImageIO::Pointer WriteIO = itk::AnalyzeObjectLabelMapImageIO::New();
+      WriteIO->SetNumberOfDimensions(2);
+      WriteIO->SetDimensions(0, 6);
+      WriteIO->SetDimensions(1, 5);
+      WriteIO->SetComponentType(itk::IOComponentEnum::UCHAR);
+      WriteIO->SetFileName(ObjectFileName);
+      itk::EncapsulateMetaData<itk::AnalyzeObjectEntryArrayType>(
+        WriteIO->GetMetaDataDictionary(), itk::ANALYZE_OBJECT_LABEL_MAP_ENTRY_ARRAY, entries);
+      WriteIO->Write(voxels.data());
+
+      itk::AnalyzeObjectLabelMapImageIO::Pointer ReadIO = itk::AnalyzeObjectLabelMapImageIO::New();
+      ReadIO->SetFileName(ObjectFileName);
+      ReadIO->ReadImageInformation();
+      itk::AnalyzeObjectEntryArrayType read;
+      itk::ExposeMetaData<itk::AnalyzeObjectEntryArrayType>(
+        ReadIO->GetMetaDataDictionary(), itk::ANALYZE_OBJECT_LABEL_MAP_ENTRY_ARRAY, read);
+      if (read.size() != entries.size())
+      {
+        std::cerr << "Write " << write << " stored " << read.size() << " entries" << std::endl;
+        error_count++;
+        continue;
+      }
+      for (unsigned int i = 0; i < entries.size(); i++)
+      {
+        if (!SameEntry(entries[i], original[i]))
+        {
+          std::cerr << "Write " << write << " changed entry " << i << std::endl;
+          error_count++;
+        }
+        if (!SameEntry(read[i], original[i]))
+        {
+          std::cerr << "Entry " << i << " was not read back as written by write " << write << std::endl;
+          error_count++;
+        }
+      }
+    }
+  }
+  catch (itk::ExceptionObject & err)
+  {
+    std::cerr << "ExceptionObject caught !" << std::endl << err << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // A header record encoded in either byte order is decoded back to the same values.
+  itk::AnalyzeObjectMapHeaderRecord record;
+  record.Version = itk::VERSION7;
+  record.Dimensions[0] = 300;
+  record.Dimensions[1] = 2;
+  record.Dimensions[2] = 70000;
+  record.Dimensions[3] = 1;
+  record.Entries.resize(entries.size());
+  for (unsigned int i = 0; i < entries.size(); i++)
+  {
+    entries[i]->CopyToRecord(record.Entries[i]);
+  }
+  for (bool bigEndian : { true, false })
+  {
+    std::vector<unsigned char> bytes;
+    record.Encode(bytes, bigEndian);
+    const unsigned char               expectedVersion[4] = { 0x01, 0x31, 0xF3, 0x8D };
+    const bool                        versionFirst =
+      bigEndian ? std::memcmp(bytes.data(), expectedVersion, 4) == 0 : bytes[0] == expectedVersion[3];
+    itk::AnalyzeObjectMapHeaderRecord decoded;
+    if (!versionFirst || !decoded.Decode(bytes.data(), bytes.size(), true) || decoded.BigEndian != bigEndian ||
+        decoded.Dimensions[2] != 70000 || decoded.NumberOfObjects != 3 || decoded.DataOffset != bytes.size())
+    {
+      std::cerr << "The header was not encoded " << (bigEndian ? "big" : "little") << " endian" << std::endl;
+      error_count++;
+      continue;
+    }
+    for (unsigned int i = 0; i < entries.size(); i++)
+    {
+      itk::AnalyzeObjectEntry::Pointer entry = itk::AnalyzeObjectEntry::New();
+      entry->CopyFromRecord(decoded.Entries[i]);
+      if (!SameEntry(entry, original[i]))
+      {
+        std::cerr << "Entry " << i << " was not encoded " << (bigEndian ? "big" : "little") << " endian" << std::endl;
+        error_count++;
+      }
+    }
+  }
+
+  if (error_count)
+  {
+    std::cerr << error_count << " errors encoding object entries" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
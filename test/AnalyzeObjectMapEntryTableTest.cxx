@@ -0,0 +1,144 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#  pragma warning(disable : 4786)
+#endif
+
+#include "itkAnalyzeObjectLabelMapImageIO.h"
+#include "itkAnalyzeObjectMap.h"
+#include "itkMetaDataObject.h"
+
+#include <vector>
+
+// Reads an object map into an entry table and checks it against the entry array, changes the
+// table through its views, and checks that the changes are written and converted back to entries.
+int
+AnalyzeObjectMapEntryTableTest(int ac, char * av[])
+{
+  if (ac != 3)
+  {
+    std::cerr << "USAGE: " << av[0] << " <inputFileName> <outputFileName>" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const char * InputObjectFileName = av[1];
+  const char * OutputObjectFileName = av[2];
+
+  int error_count = 0;
+  try
+  {
+    itk::AnalyzeObjectLabelMapImageIO::Pointer io = itk::AnalyzeObjectLabelMapImageIO::New();
+    io->SetFileName(InputObjectFileName);
+    io->ReadImageInformation();
+    itk::AnalyzeObjectEntryArrayType entries;
+    itk::ExposeMetaData<itk::AnalyzeObjectEntryArrayType>(
+      io->GetMetaDataDictionary(), itk::ANALYZE_OBJECT_LABEL_MAP_ENTRY_ARRAY, entries);
+    std::vector<unsigned char> voxels(io->GetImageSizeInPixels());
+    io->Read(voxels.data());
+
+    // The same file read into a table holds the same entries, and no entry array.
+    io->UseEntryTableOn();
+    io->ReadImageInformation();
+    itk::AnalyzeObjectEntryTable table;
+    itk::AnalyzeObjectEntryTable expected;
+    expected.CopyFromEntryArray(entries);
+    if (!itk::ExposeMetaData<itk::AnalyzeObjectEntryTable>(
+          io->GetMetaDataDictionary(), itk::ANALYZE_OBJECT_LABEL_MAP_ENTRY_TABLE, table) ||
+        table != expected || io->GetMetaDataDictionary().HasKey(itk::ANALYZE_OBJECT_LABEL_MAP_ENTRY_ARRAY))
+    {
+      std::cerr << "The entry table read differs from the entry array" << std::endl;
+      error_count++;
+    }
+    for (itk::SizeValueType i = 0; i < entries.size() && i < table.GetNumberOfEntries(); i++)
+    {
+      if (table[i].GetName() != entries[i]->GetName() || table[i].GetEndGreen() != entries[i]->GetEndGreen() ||
+          table[i].GetOpacity() != entries[i]->GetOpacity() ||
+          table[i].GetMaximumYValue() != entries[i]->GetMaximumYValue())
+      {
+        std::cerr << "View " << i << " differs from its entry" << std::endl;
+        error_count++;
+      }
+    }
+
+    // Changes made through the views are written.
+    const itk::SizeValueType last = table.GetNumberOfEntries() - 1;
+    table[1].SetOpacity(0.75f);
+    table[1].SetMinimumZValue(-12);
+    table[last].Copy(table[1]);
+    table.AddEntry("A name longer than the thirty one characters kept").SetEndRed(200);
+    io->SetFileName(OutputObjectFileName);
+    itk::EncapsulateMetaData<itk::AnalyzeObjectEntryTable>(
+      io->GetMetaDataDictionary(), itk::ANALYZE_OBJECT_LABEL_MAP_ENTRY_TABLE, table);
+    io->Write(voxels.data());
+
+    itk::AnalyzeObjectLabelMapImageIO::Pointer readIO = itk::AnalyzeObjectLabelMapImageIO::New();
+    readIO->SetFileName(OutputObjectFileName);
+    readIO->ReadImageInformation();
+    itk::AnalyzeObjectEntryArrayType written;
+    itk::ExposeMetaData<itk::AnalyzeObjectEntryArrayType>(
+      readIO->GetMetaDataDictionary(), itk::ANALYZE_OBJECT_LABEL_MAP_ENTRY_ARRAY, written);
+    if (written.size() != last + 2 || written[1]->GetOpacity() != 0.75f || written[1]->GetMinimumZValue() != -12 ||
+        written[last]->GetMinimumZValue() != -12 || written[last]->GetName() != entries[last]->GetName() ||
+        written[last + 1]->GetName() != "A name longer than the thirty o" || written[last + 1]->GetEndRed() != 200 ||
+        written[last + 1]->GetOpacity() != 0.5f || written[last + 1]->GetDisplayFlag() != 1)
+    {
+      std::cerr << "The changes made to the table were not written" << std::endl;
+      error_count++;
+    }
+
+    // An image read with a table gets entries of its own in an object map.
+    using ImageType = itk::Image<unsigned char, 4>;
+    ImageType::Pointer    image = ImageType::New();
+    ImageType::RegionType region;
+    region.SetSize({ { 2, 2, 1, 1 } });
+    image->SetRegions(region);
+    image->Allocate();
+    itk::EncapsulateMetaData<itk::AnalyzeObjectEntryTable>(
+      image->GetMetaDataDictionary(), itk::ANALYZE_OBJECT_LABEL_MAP_ENTRY_TABLE, table);
+    itk::AnalyzeObjectMap<ImageType>::Pointer objectMap = itk::AnalyzeObjectMap<ImageType>::New();
+    objectMap->ImageToObjectMap(image);
+    if (objectMap->GetNumberOfObjects() != static_cast<int>(table.GetNumberOfEntries()) ||
+        objectMap->GetObjectEntry(1)->GetOpacity() != 0.75f)
+    {
+      std::cerr << "The table was not converted to object entries" << std::endl;
+      error_count++;
+    }
+  }
+  catch (itk::ExceptionObject & err)
+  {
+    std::cerr << "ExceptionObject caught !" << std::endl << err << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // New entries of a table have the values of a new entry.
+  itk::AnalyzeObjectEntryTable defaults(2);
+  itk::AnalyzeObjectEntryTable fromEntry;
+  fromEntry.CopyFromEntryArray({ itk::AnalyzeObjectEntry::New(), itk::AnalyzeObjectEntry::New() });
+  if (defaults != fromEntry)
+  {
+    std::cerr << "The default entry record differs from a new entry" << std::endl;
+    error_count++;
+  }
+
+  if (error_count)
+  {
+    std::cerr << error_count << " errors using entry tables" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
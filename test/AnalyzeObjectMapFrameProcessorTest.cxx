@@ -0,0 +1,208 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#  pragma warning(disable : 4786)
+#endif
+
+#include "itkAnalyzeObjectMapFrameProcessor.h"
+#include "itkAnalyzeObjectEntryTable.h"
+#include "itkAnalyzeObjectRunLengthCodec.h"
+
+#include <fstream>
+#include <numeric>
+#include <vector>
+
+// Reads single frames of an object map of several frames, some of whose planes hold a single
+// label, and maps the count of a label and ObjectMapToRGBImage() over its frames on several threads.
+int
+AnalyzeObjectMapFrameProcessorTest(int ac, char * av[])
+{
+  if (ac != 2)
+  {
+    std::cerr << "USAGE: " << av[0] << " <outputFileName>" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const char * OutputObjectFileName = av[1];
+
+  using ObjectMapType = itk::AnalyzeObjectMap<>;
+  using ProcessorType = itk::AnalyzeObjectMapFrameProcessor<ObjectMapType>;
+  int error_count = 0;
+
+  // Frames of 6 by 5 by 4 voxels.  Label 1 grows with the frame, and plane 2 of the even frames
+  // only holds label 2.
+  const int                       dimensions[4] = { 6, 5, 4, 7 };
+  constexpr itk::SizeValueType    frameSize = 6 * 5 * 4;
+  const itk::SizeValueType        numberOfVoxels = frameSize * 7;
+  std::vector<unsigned char>      voxels(numberOfVoxels, 0);
+  std::vector<itk::SizeValueType> labelOneVoxels(7, 0);
+  for (itk::SizeValueType i = 0; i < numberOfVoxels; i++)
+  {
+    const itk::SizeValueType t = i / frameSize;
+    const itk::SizeValueType z = i % frameSize / 30;
+    if (t % 2 == 0 && z == 2)
+    {
+      voxels[i] = 2;
+    }
+    else if (i % frameSize % 11 < t)
+    {
+      voxels[i] = 1;
+      labelOneVoxels[t]++;
+    }
+  }
+  itk::AnalyzeObjectEntryTable table;
+  table.AddEntry("Background");
+  table.AddEntry("Growing");
+  table[1].SetEndRed(200);
+  table.AddEntry("Plane");
+  itk::AnalyzeObjectMapHeaderRecord header;
+  header.Version = itk::VERSION7;
+  std::copy(dimensions, dimensions + 4, header.Dimensions);
+  header.Entries = table.GetRecords();
+  std::vector<unsigned char> bytes;
+  header.Encode(bytes, true);
+  itk::AnalyzeObjectRunLengthCodec::EncodeVolume(voxels.data(), numberOfVoxels, 30, bytes);
+  std::ofstream outputFileStream(OutputObjectFileName, std::ios::binary | std::ios::out | std::ios::trunc);
+  outputFileStream.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+  outputFileStream.close();
+
+  ProcessorType::Pointer processor = ProcessorType::New();
+  processor->SetFileName(OutputObjectFileName);
+  processor->SetNumberOfWorkUnits(3);
+  try
+  {
+    processor->Initialize();
+    for (const itk::SizeValueType frame : { 0, 3, 6 })
+    {
+      ObjectMapType::Pointer objectMap = processor->ReadFrame(frame);
+      if (objectMap->GetLargestPossibleRegion().GetSize()[3] != 1 ||
+          objectMap->GetLargestPossibleRegion().GetNumberOfPixels() != frameSize ||
+          !std::equal(voxels.begin() + frame * frameSize,
+                      voxels.begin() + (frame + 1) * frameSize,
+                      objectMap->GetBufferPointer()) ||
+          objectMap->GetNumberOfObjects() != 3)
+      {
+        std::cerr << "Frame " << frame << " was read wrongly" << std::endl;
+        error_count++;
+      }
+    }
+    const itk::AnalyzeObjectPlaneIndex::OffsetType dataOffset = 24 + 3 * itk::AnalyzeObjectEntryRecord::SizeInFile;
+    if (processor->GetNumberOfFrames() != 7 || processor->GetFrameOffset(0) != dataOffset ||
+        processor->GetFrameOffset(1) <= processor->GetFrameOffset(0))
+    {
+      std::cerr << "The frames are not indexed" << std::endl;
+      error_count++;
+    }
+
+    // The voxels of label 1 in every frame, gathered in the order of the frames.
+    const std::vector<itk::SizeValueType> counts = processor->MapReduce(
+      [](ObjectMapType * frame, itk::SizeValueType) {
+        return static_cast<itk::SizeValueType>(
+          std::count(frame->GetBufferPointer(),
+                     frame->GetBufferPointer() + frame->GetLargestPossibleRegion().GetNumberOfPixels(),
+                     1));
+      },
+      [](std::vector<itk::SizeValueType> & result, itk::SizeValueType count) { result.push_back(count); },
+      std::vector<itk::SizeValueType>());
+    using RGBImageType = itk::Image<itk::RGBPixel<unsigned char>, 4>;
+    const itk::SizeValueType red = processor->MapReduce(
+      [](ObjectMapType * frame, itk::SizeValueType) {
+        RGBImageType::Pointer rgb = frame->ObjectMapToRGBImage();
+        return static_cast<itk::SizeValueType>(
+          std::count_if(rgb->GetBufferPointer(),
+                        rgb->GetBufferPointer() + frameSize,
+                        [](const itk::RGBPixel<unsigned char> & pixel) { return pixel[0] == 200; }));
+      },
+      [](itk::SizeValueType & result, itk::SizeValueType frameRed) { result += frameRed; },
+      itk::SizeValueType{ 0 });
+    if (counts != labelOneVoxels ||
+        red != std::accumulate(labelOneVoxels.begin(), labelOneVoxels.end(), itk::SizeValueType{ 0 }))
+    {
+      std::cerr << "The frames were mapped or reduced wrongly" << std::endl;
+      error_count++;
+    }
+
+    // map() may return a reference, to a value that cannot be default constructed.
+    struct FrameNumber
+    {
+      explicit FrameNumber(itk::SizeValueType number)
+        : Number(number)
+      {}
+      itk::SizeValueType Number;
+    };
+    std::vector<FrameNumber> frameNumbers;
+    for (itk::SizeValueType t = 0; t < processor->GetNumberOfFrames(); t++)
+    {
+      frameNumbers.emplace_back(t);
+    }
+    const itk::SizeValueType order = processor->MapReduce(
+      [&frameNumbers](ObjectMapType *, itk::SizeValueType t) -> const FrameNumber & { return frameNumbers[t]; },
+      [](itk::SizeValueType & result, FrameNumber frameNumber) { result = 10 * result + frameNumber.Number; },
+      itk::SizeValueType{ 0 });
+    if (order != 123456)
+    {
+      std::cerr << "Referenced values were mapped or reduced wrongly: " << order << std::endl;
+      error_count++;
+    }
+  }
+  catch (itk::ExceptionObject & err)
+  {
+    std::cerr << "ExceptionObject caught !" << std::endl << err << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // An exception thrown for a frame, and a frame that does not exist, are reported.
+  int caught = 0;
+  try
+  {
+    processor->MapReduce(
+      [](ObjectMapType *, itk::SizeValueType t) {
+        if (t == 4)
+        {
+          itkGenericExceptionMacro(<< "Frame " << t);
+        }
+        return 0;
+      },
+      [](int &, int) {},
+      0);
+  }
+  catch (itk::ExceptionObject &)
+  {
+    caught++;
+  }
+  try
+  {
+    processor->ReadFrame(7);
+  }
+  catch (itk::ExceptionObject &)
+  {
+    caught++;
+  }
+  if (caught != 2)
+  {
+    std::cerr << "An error was not reported" << std::endl;
+    error_count++;
+  }
+
+  if (error_count)
+  {
+    std::cerr << error_count << " errors processing frames" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,224 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#  pragma warning(disable : 4786)
+#endif
+
+#include "itkAnalyzeObjectLabelMapImageIOPool.h"
+#include "itkMetaDataObject.h"
+
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+namespace
+{
+// Reads the whole of fileName with io and returns its voxels.
+std::vector<unsigned char>
+ReadVoxels(itk::AnalyzeObjectLabelMapImageIO * io, const std::string & fileName)
+{
+  io->SetFileName(fileName);
+  io->ReadImageInformation();
+  std::vector<unsigned char> voxels(io->GetImageSizeInPixels());
+  io->Read(voxels.data());
+  return voxels;
+}
+
+// Returns the entries of the meta data dictionary of io.
+itk::AnalyzeObjectEntryArrayType
+GetEntries(itk::AnalyzeObjectLabelMapImageIO * io)
+{
+  itk::AnalyzeObjectEntryArrayType entries;
+  itk::ExposeMetaData<itk::AnalyzeObjectEntryArrayType>(
+    io->GetMetaDataDictionary(), itk::ANALYZE_OBJECT_LABEL_MAP_ENTRY_ARRAY, entries);
+  return entries;
+}
+
+// Writes a small object map of labels to fileName with io.
+void
+WriteLabels(itk::AnalyzeObjectLabelMapImageIO * io, const std::string & fileName, unsigned char label)
+{
+  std::vector<unsigned char> voxels(8 * 4 * 3, 0);
+  std::fill(voxels.begin() + 10, voxels.begin() + 50, label);
+  io->SetNumberOfDimensions(3);
+  io->SetDimensions(0, 8);
+  io->SetDimensions(1, 4);
+  io->SetDimensions(2, 3);
+  io->SetComponentType(itk::IOComponentEnum::UCHAR);
+  io->SetFileName(fileName);
+  io->SetMetaDataDictionary(itk::MetaDataDictionary());
+  io->Write(voxels.data());
+}
+
+std::vector<char>
+ReadBytes(const std::string & fileName)
+{
+  std::ifstream file(fileName.c_str(), std::ios::binary);
+  return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+} // namespace
+
+// Reads and writes several files with a single IO and checks that the results are those of a new
+// IO for every file, that entries still held by the caller are never reused, and that IOs taken
+// from a pool by several threads read the same voxels.
+int
+AnalyzeObjectMapImageIOPoolTest(int ac, char * av[])
+{
+  if (ac != 3)
+  {
+    std::cerr << "USAGE: " << av[0] << " <inputFileName> <outputPrefix>" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const std::string InputObjectFileName = av[1];
+  const std::string OutputPrefix = av[2];
+  const std::string SmallFileName = OutputPrefix + "Small.obj";
+  const std::string ReusedFileName = OutputPrefix + "Reused.obj";
+
+  int error_count = 0;
+  try
+  {
+    WriteLabels(itk::AnalyzeObjectLabelMapImageIO::New(), SmallFileName, 1);
+    const std::vector<unsigned char> expectedLarge =
+      ReadVoxels(itk::AnalyzeObjectLabelMapImageIO::New(), InputObjectFileName);
+    const std::vector<unsigned char> expectedSmall =
+      ReadVoxels(itk::AnalyzeObjectLabelMapImageIO::New(), SmallFileName);
+
+    // Files of different sizes read one after the other with the same IO.
+    itk::AnalyzeObjectLabelMapImageIO::Pointer io = itk::AnalyzeObjectLabelMapImageIO::New();
+    for (unsigned int i = 0; i < 6; i++)
+    {
+      const bool large = i % 2 == 0;
+      if (ReadVoxels(io, large ? InputObjectFileName : SmallFileName) != (large ? expectedLarge : expectedSmall))
+      {
+        std::cerr << "Read " << i << " with a reused IO differs" << std::endl;
+        error_count++;
+      }
+    }
+    if (io->GetScratchBufferSizeInBytes() == 0)
+    {
+      std::cerr << "The IO kept no buffer" << std::endl;
+      error_count++;
+    }
+
+    // Entries held by the caller are left alone by the next read; the others are reused.
+    ReadVoxels(io, InputObjectFileName);
+    const itk::AnalyzeObjectEntryArrayType held = GetEntries(io);
+    const std::string                      heldName = held.back()->GetName();
+    ReadVoxels(io, SmallFileName);
+    const itk::AnalyzeObjectEntry * smallEntry = GetEntries(io)[0];
+    if (held.back()->GetName() != heldName || smallEntry == held[0].GetPointer())
+    {
+      std::cerr << "An entry held by the caller was reused" << std::endl;
+      error_count++;
+    }
+    ReadVoxels(io, SmallFileName);
+    if (GetEntries(io)[0].GetPointer() != smallEntry)
+    {
+      std::cerr << "An entry nobody held was not reused" << std::endl;
+      error_count++;
+    }
+
+    // Writing with a reused IO gives the same file as writing with a new one.
+    WriteLabels(io, ReusedFileName, 2);
+    WriteLabels(io, ReusedFileName, 1);
+    if (ReadBytes(ReusedFileName) != ReadBytes(SmallFileName))
+    {
+      std::cerr << "A file written with a reused IO differs" << std::endl;
+      error_count++;
+    }
+    io->ReleaseScratchBuffers();
+    if (io->GetScratchBufferSizeInBytes() != 0 || ReadVoxels(io, InputObjectFileName) != expectedLarge)
+    {
+      std::cerr << "Releasing the buffers failed" << std::endl;
+      error_count++;
+    }
+
+    // Several threads reading with IOs of a pool.
+    constexpr unsigned int                NumberOfThreads = 4;
+    itk::AnalyzeObjectLabelMapImageIOPool pool;
+    std::vector<int>                      threadErrors(NumberOfThreads, 0);
+    std::vector<std::thread>              threads;
+    for (unsigned int t = 0; t < NumberOfThreads; t++)
+    {
+      threads.emplace_back([&, t]() {
+        for (unsigned int i = 0; i < 10; i++)
+        {
+          itk::AnalyzeObjectLabelMapImageIOPool::Lease lease(pool);
+          const bool                                   large = (i + t) % 2 == 0;
+          try
+          {
+            if (ReadVoxels(lease.Get(), large ? InputObjectFileName : SmallFileName) !=
+                (large ? expectedLarge : expectedSmall))
+            {
+              threadErrors[t]++;
+            }
+          }
+          catch (itk::ExceptionObject &)
+          {
+            threadErrors[t]++;
+          }
+        }
+      });
+    }
+    for (auto & thread : threads)
+    {
+      thread.join();
+    }
+    for (unsigned int t = 0; t < NumberOfThreads; t++)
+    {
+      if (threadErrors[t] > 0)
+      {
+        std::cerr << "Thread " << t << " read " << threadErrors[t] << " files wrong" << std::endl;
+        error_count++;
+      }
+    }
+    const itk::SizeValueType numberOfIdle = pool.GetNumberOfIdleImageIOs();
+    if (numberOfIdle < 1 || numberOfIdle > NumberOfThreads)
+    {
+      std::cerr << "The pool holds " << numberOfIdle << " IOs" << std::endl;
+      error_count++;
+    }
+    itk::AnalyzeObjectLabelMapImageIOPool::ImageIOPointer pooled = pool.Acquire();
+    if (pool.GetNumberOfIdleImageIOs() != numberOfIdle - 1 || !GetEntries(pooled).empty())
+    {
+      std::cerr << "An IO of the pool still holds the entries of its last file" << std::endl;
+      error_count++;
+    }
+    pool.Release(pooled);
+    pool.Clear();
+    if (pool.GetNumberOfIdleImageIOs() != 0)
+    {
+      std::cerr << "The pool was not cleared" << std::endl;
+      error_count++;
+    }
+  }
+  catch (itk::ExceptionObject & err)
+  {
+    std::cerr << "ExceptionObject caught !" << std::endl << err << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (error_count)
+  {
+    std::cerr << error_count << " errors reusing object map IOs" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
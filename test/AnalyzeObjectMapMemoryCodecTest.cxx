@@ -0,0 +1,145 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#  pragma warning(disable : 4786)
+#endif
+
+#include "itkAnalyzeObjectLabelMapImageIO.h"
+#include "itkAnalyzeObjectMapMemoryCodec.h"
+
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+// Decodes an object map read into memory with the standalone codec and with
+// AnalyzeObjectLabelMapImageIO, checks both against the file read by the IO, and encodes it back
+// into memory, as the IO writes it to a file.
+int
+AnalyzeObjectMapMemoryCodecTest(int ac, char * av[])
+{
+  if (ac != 3)
+  {
+    std::cerr << "USAGE: " << av[0] << " <inputFileName> <outputFileName>" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const char * InputObjectFileName = av[1];
+  const char * OutputObjectFileName = av[2];
+
+  std::ifstream              inputFileStream(InputObjectFileName, std::ios::binary | std::ios::in);
+  std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(inputFileStream)), std::istreambuf_iterator<char>());
+  inputFileStream.close();
+
+  int error_count = 0;
+  try
+  {
+    // The voxels of the file, as read by the IO.
+    itk::AnalyzeObjectLabelMapImageIO::Pointer fileIO = itk::AnalyzeObjectLabelMapImageIO::New();
+    fileIO->SetFileName(InputObjectFileName);
+    fileIO->ReadImageInformation();
+    std::vector<unsigned char> fileVoxels(fileIO->GetImageSizeInPixels());
+    fileIO->Read(fileVoxels.data());
+
+    itk::AnalyzeObjectMapHeaderRecord header;
+    std::vector<unsigned char>        voxels;
+    if (!itk::AnalyzeObjectMapMemoryCodec::Decode(bytes.data(), bytes.size(), header, voxels) ||
+        voxels != fileVoxels || header.Entries.empty())
+    {
+      std::cerr << "The codec did not decode the map in memory" << std::endl;
+      error_count++;
+    }
+    itk::AnalyzeObjectMapMemoryCodec::BufferType encoded;
+    itk::AnalyzeObjectMapHeaderRecord            decoded;
+    std::vector<unsigned char>                   decodedVoxels;
+    if (!itk::AnalyzeObjectMapMemoryCodec::Encode(header, voxels.data(), encoded) ||
+        !itk::AnalyzeObjectMapMemoryCodec::Decode(encoded.data(), encoded.size(), decoded, decodedVoxels) ||
+        decodedVoxels != voxels || decoded.Entries.size() != header.Entries.size() ||
+        !std::equal(header.Dimensions, header.Dimensions + 4, decoded.Dimensions))
+    {
+      std::cerr << "The codec did not encode the map into memory" << std::endl;
+      error_count++;
+    }
+
+    // The IO reads the whole map, then the last plane alone, from memory.
+    itk::AnalyzeObjectLabelMapImageIO::Pointer memoryIO = itk::AnalyzeObjectLabelMapImageIO::New();
+    memoryIO->ReadImageInformationFromMemory(bytes.data(), bytes.size());
+    std::vector<unsigned char> memoryVoxels(memoryIO->GetImageSizeInPixels());
+    memoryIO->ReadFromMemory(bytes.data(), bytes.size(), memoryVoxels.data());
+    const unsigned int       numberOfDimensions = memoryIO->GetNumberOfDimensions();
+    itk::ImageIORegion       region = memoryIO->GetIORegion();
+    const itk::SizeValueType planeSize = memoryIO->GetDimensions(0) * memoryIO->GetDimensions(1);
+    region.SetIndex(numberOfDimensions - 1, memoryIO->GetDimensions(numberOfDimensions - 1) - 1);
+    region.SetSize(numberOfDimensions - 1, 1);
+    memoryIO->SetIORegion(region);
+    std::vector<unsigned char> plane(planeSize);
+    memoryIO->ReadFromMemory(bytes.data(), bytes.size(), plane.data());
+    if (memoryVoxels != fileVoxels || numberOfDimensions != fileIO->GetNumberOfDimensions() ||
+        !std::equal(plane.begin(), plane.end(), fileVoxels.end() - planeSize))
+    {
+      std::cerr << "The IO did not read the map from memory" << std::endl;
+      error_count++;
+    }
+
+    // The IO encodes into memory the bytes it writes to a file, entries included.
+    itk::AnalyzeObjectMapMemoryCodec::BufferType written;
+    fileIO->WriteToMemory(fileVoxels.data(), written);
+    fileIO->SetFileName(OutputObjectFileName);
+    fileIO->Write(fileVoxels.data());
+    std::ifstream              outputFileStream(OutputObjectFileName, std::ios::binary | std::ios::in);
+    std::vector<unsigned char> fileBytes((std::istreambuf_iterator<char>(outputFileStream)),
+                                         std::istreambuf_iterator<char>());
+    if (written.empty() || written != fileBytes)
+    {
+      std::cerr << "The IO did not encode the map into memory as into a file" << std::endl;
+      error_count++;
+    }
+  }
+  catch (itk::ExceptionObject & err)
+  {
+    std::cerr << "ExceptionObject caught !" << std::endl << err << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Truncated maps are refused by the codec, and reported by the IO.
+  itk::AnalyzeObjectMapHeaderRecord header;
+  std::vector<unsigned char>        voxels;
+  if (itk::AnalyzeObjectMapMemoryCodec::Decode(bytes.data(), bytes.size() - 2, header, voxels) ||
+      itk::AnalyzeObjectMapMemoryCodec::Decode(bytes.data(), 30, header, voxels))
+  {
+    std::cerr << "A truncated map was decoded" << std::endl;
+    error_count++;
+  }
+  itk::AnalyzeObjectLabelMapImageIO::Pointer truncatedIO = itk::AnalyzeObjectLabelMapImageIO::New();
+  try
+  {
+    truncatedIO->ReadImageInformationFromMemory(bytes.data(), bytes.size() - 2);
+    voxels.resize(truncatedIO->GetImageSizeInPixels());
+    truncatedIO->ReadFromMemory(bytes.data(), bytes.size() - 2, voxels.data());
+    std::cerr << "A truncated map was read" << std::endl;
+    error_count++;
+  }
+  catch (itk::ExceptionObject &)
+  {}
+
+  if (error_count)
+  {
+    std::cerr << error_count << " errors decoding and encoding object maps in memory" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,276 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#  pragma warning(disable : 4786)
+#endif
+
+#include "itkAnalyzeObjectMapMerger.h"
+#include "itkAnalyzeObjectEntry.h"
+#include "itkAnalyzeObjectEntryTable.h"
+#include "itkAnalyzeObjectRunLengthCodec.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace
+{
+using MergerType = itk::AnalyzeObjectMapMerger;
+using BufferType = std::vector<unsigned char>;
+
+// Encodes a whole object map file with entries of the given names.
+BufferType
+EncodeObjectMap(const int dimensions[4], const std::vector<std::string> & names, const BufferType & voxels)
+{
+  itk::AnalyzeObjectMapHeaderRecord header;
+  header.Version = itk::VERSION7;
+  std::copy(dimensions, dimensions + 4, header.Dimensions);
+  itk::AnalyzeObjectEntryTable table;
+  for (const std::string & name : names)
+  {
+    table.AddEntry(name);
+  }
+  header.Entries = table.GetRecords();
+  BufferType bytes;
+  header.Encode(bytes, true);
+  itk::AnalyzeObjectRunLengthCodec::EncodeVolume(
+    voxels.data(), voxels.size(), static_cast<itk::SizeValueType>(dimensions[0]) * dimensions[1], bytes);
+  return bytes;
+}
+
+// Decodes the header and the voxels of a whole object map file.
+bool
+DecodeObjectMap(const BufferType & bytes, itk::AnalyzeObjectMapHeaderRecord & header, BufferType & voxels)
+{
+  if (!header.Decode(bytes.data(), bytes.size(), true))
+  {
+    return false;
+  }
+  voxels.assign(static_cast<itk::SizeValueType>(header.Dimensions[0]) * header.Dimensions[1] *
+                  header.Dimensions[2] * header.Dimensions[3],
+                0);
+  itk::SizeValueType index = 0;
+  return itk::AnalyzeObjectRunLengthCodec::DecodeRuns(bytes.data() + header.DataOffset,
+                                                      bytes.size() - header.DataOffset,
+                                                      voxels.data(),
+                                                      voxels.size(),
+                                                      index) &&
+         index == voxels.size();
+}
+} // namespace
+
+// Merges two small object maps with every operation and checks the voxels, the entries and the
+// runs against a merge done voxel by voxel, then merges an object map file with itself.
+int
+AnalyzeObjectMapMergeTest(int ac, char * av[])
+{
+  if (ac != 3)
+  {
+    std::cerr << "USAGE: " << av[0] << " <inputFileName> <outputFileName>" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const char * InputObjectFileName = av[1];
+  const char * OutputObjectFileName = av[2];
+
+  // Planes of 300 voxels, so that runs of the merged map have to be split at 255 voxels.
+  const int                      dimensions[4] = { 100, 3, 4, 1 };
+  const itk::SizeValueType       numberOfVoxels = 100 * 3 * 4;
+  const std::vector<std::string> firstNames = { "Background", "Brain", "Skull" };
+  const std::vector<std::string> secondNames = { "Background", "Lesion", "Skull" };
+  BufferType                     firstVoxels(numberOfVoxels);
+  BufferType                     secondVoxels(numberOfVoxels);
+  for (itk::SizeValueType i = 0; i < numberOfVoxels; i++)
+  {
+    const itk::SizeValueType x = i % 100;
+    const itk::SizeValueType z = i / 300;
+    firstVoxels[i] = x < 20 ? 0 : x < 70 ? 1 : 2;
+    secondVoxels[i] = z == 0 ? 0 : x % 30 < 10 ? 0 : x % 30 < 20 ? 1 : 2;
+  }
+  const BufferType first = EncodeObjectMap(dimensions, firstNames, firstVoxels);
+  const BufferType second = EncodeObjectMap(dimensions, secondNames, secondVoxels);
+
+  // The labels of the second map in the merged map: Lesion is appended, Skull is matched.
+  const unsigned char secondToMerged[3] = { 0, 3, 2 };
+
+  int error_count = 0;
+  struct Case
+  {
+    MergerType::OperationEnum      Operation;
+    MergerType::ConflictPolicyEnum Policy;
+    bool                           UseFunction;
+  };
+  const Case cases[] = {
+    { MergerType::OperationEnum::Union, MergerType::ConflictPolicyEnum::KeepFirst, false },
+    { MergerType::OperationEnum::Union, MergerType::ConflictPolicyEnum::KeepSecond, false },
+    { MergerType::OperationEnum::Union, MergerType::ConflictPolicyEnum::Background, false },
+    { MergerType::OperationEnum::Union, MergerType::ConflictPolicyEnum::KeepFirst, true },
+    { MergerType::OperationEnum::Intersection, MergerType::ConflictPolicyEnum::KeepSecond, false },
+    { MergerType::OperationEnum::Difference, MergerType::ConflictPolicyEnum::KeepFirst, false },
+    { MergerType::OperationEnum::Priority, MergerType::ConflictPolicyEnum::KeepFirst, false },
+  };
+  for (const Case & c : cases)
+  {
+    MergerType merger;
+    merger.SetOperation(c.Operation);
+    merger.SetConflictPolicy(c.Policy);
+    if (c.UseFunction)
+    {
+      merger.SetConflictFunction([](unsigned char a, unsigned char b) { return std::max(a, b); });
+    }
+    BufferType merged;
+    try
+    {
+      merger.Merge(first.data(), first.size(), second.data(), second.size(), merged);
+    }
+    catch (itk::ExceptionObject & err)
+    {
+      std::cerr << "ExceptionObject caught !" << std::endl << err << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    BufferType expected(numberOfVoxels);
+    for (itk::SizeValueType i = 0; i < numberOfVoxels; i++)
+    {
+      const unsigned char a = firstVoxels[i];
+      const unsigned char b = secondToMerged[secondVoxels[i]];
+      unsigned char       resolved = a;
+      if (c.Policy == MergerType::ConflictPolicyEnum::KeepSecond)
+      {
+        resolved = b;
+      }
+      else if (c.Policy == MergerType::ConflictPolicyEnum::Background && a != b)
+      {
+        resolved = 0;
+      }
+      if (c.UseFunction)
+      {
+        resolved = std::max(a, b);
+      }
+      switch (c.Operation)
+      {
+        case MergerType::OperationEnum::Union:
+          expected[i] = a == 0 ? b : b == 0 ? a : resolved;
+          break;
+        case MergerType::OperationEnum::Intersection:
+          expected[i] = a == 0 || b == 0 ? 0 : resolved;
+          break;
+        case MergerType::OperationEnum::Difference:
+          expected[i] = b == 0 ? a : 0;
+          break;
+        case MergerType::OperationEnum::Priority:
+          expected[i] = b == 0 ? a : b;
+          break;
+      }
+    }
+
+    itk::AnalyzeObjectMapHeaderRecord header;
+    BufferType                        voxels;
+    const itk::SizeValueType          numberOfEntries = c.Operation == MergerType::OperationEnum::Difference ? 3 : 4;
+    if (!DecodeObjectMap(merged, header, voxels) || voxels != expected || header.Entries.size() != numberOfEntries ||
+        std::string(header.Entries[2].Name) != "Skull" ||
+        (numberOfEntries == 4 && std::string(header.Entries[3].Name) != "Lesion"))
+    {
+      std::cerr << "Operation " << static_cast<int>(c.Operation) << " with policy " << static_cast<int>(c.Policy)
+                << " merged wrongly" << std::endl;
+      error_count++;
+      continue;
+    }
+
+    // The runs are those the writer would have encoded.
+    BufferType runs;
+    itk::AnalyzeObjectRunLengthCodec::EncodeVolume(expected.data(), numberOfVoxels, 300, runs);
+    if (BufferType(merged.begin() + header.DataOffset, merged.end()) != runs)
+    {
+      std::cerr << "Operation " << static_cast<int>(c.Operation) << " did not merge the runs" << std::endl;
+      error_count++;
+    }
+  }
+
+  // Without matching by name, Skull of the second map gets an entry of its own.
+  {
+    MergerType merger;
+    merger.SetOperation(MergerType::OperationEnum::Priority);
+    merger.SetMatchEntriesByName(false);
+    BufferType merged;
+    merger.Merge(first.data(), first.size(), second.data(), second.size(), merged);
+    itk::AnalyzeObjectMapHeaderRecord header;
+    BufferType                        voxels;
+    if (!DecodeObjectMap(merged, header, voxels) || header.Entries.size() != 5 || voxels[300 + 25] != 4)
+    {
+      std::cerr << "Entries were matched by name" << std::endl;
+      error_count++;
+    }
+  }
+
+  // Maps of different sizes are not merged.
+  const int  otherDimensions[4] = { 100, 3, 3, 1 };
+  const auto other = EncodeObjectMap(otherDimensions, firstNames, BufferType(900, 1));
+  bool       caught = false;
+  try
+  {
+    BufferType merged;
+    MergerType().Merge(first.data(), first.size(), other.data(), other.size(), merged);
+  }
+  catch (itk::ExceptionObject &)
+  {
+    caught = true;
+  }
+  if (!caught)
+  {
+    std::cerr << "Maps of different sizes were merged" << std::endl;
+    error_count++;
+  }
+
+  // The union of a file with itself has the voxels and the entries of the file.
+  try
+  {
+    MergerType().MergeFiles(InputObjectFileName, InputObjectFileName, OutputObjectFileName);
+  }
+  catch (itk::ExceptionObject & err)
+  {
+    std::cerr << "ExceptionObject caught !" << std::endl << err << std::endl;
+    return EXIT_FAILURE;
+  }
+  BufferType inputBytes;
+  BufferType outputBytes;
+  for (BufferType * bytes : { &inputBytes, &outputBytes })
+  {
+    std::ifstream file(bytes == &inputBytes ? InputObjectFileName : OutputObjectFileName, std::ios::binary);
+    bytes->assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+  itk::AnalyzeObjectMapHeaderRecord inputHeader;
+  itk::AnalyzeObjectMapHeaderRecord outputHeader;
+  BufferType                        inputVoxels;
+  BufferType                        outputVoxels;
+  if (!DecodeObjectMap(inputBytes, inputHeader, inputVoxels) ||
+      !DecodeObjectMap(outputBytes, outputHeader, outputVoxels) || inputVoxels != outputVoxels ||
+      inputHeader.Entries.size() != outputHeader.Entries.size())
+  {
+    std::cerr << "The union of a file with itself differs from the file" << std::endl;
+    error_count++;
+  }
+
+  if (error_count)
+  {
+    std::cerr << error_count << " errors merging object maps" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
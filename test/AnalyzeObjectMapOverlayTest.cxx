@@ -0,0 +1,205 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#  pragma warning(disable : 4786)
+#endif
+
+#include "itkAnalyzeObjectMap.h"
+#include "itkAnalyzeObjectMapOverlayImageFilter.h"
+
+#include <limits>
+
+// Paints an object map over an intensity ramp and checks the colour of every kind of entry, then
+// checks that a single slice is painted as in the whole image.
+int
+AnalyzeObjectMapOverlayTest(int, char *[])
+{
+  constexpr unsigned int Dimension = 3;
+  using IntensityImageType = itk::Image<unsigned short, Dimension>;
+  using ImageType = itk::Image<unsigned char, Dimension>;
+  using ObjectMapType = itk::AnalyzeObjectMap<ImageType>;
+  using FilterType = itk::AnalyzeObjectMapOverlayImageFilter<IntensityImageType, ObjectMapType>;
+  using RGBPixelType = FilterType::OutputPixelType;
+
+  // Every column has the intensity 16 * x, and every row is painted with the label of its y.
+  IntensityImageType::RegionType region;
+  region.SetSize(0, 16);
+  region.SetSize(1, 8);
+  region.SetSize(2, 3);
+  IntensityImageType::Pointer intensityImage = IntensityImageType::New();
+  intensityImage->SetRegions(region);
+  intensityImage->Allocate();
+  ObjectMapType::Pointer objectMap = ObjectMapType::New();
+  objectMap->SetRegions(region);
+  objectMap->Allocate();
+  const unsigned char rowLabels[8] = { 0, 1, 2, 3, 4, 5, 200, 0 };
+  for (itk::ImageRegionIterator<IntensityImageType> it(intensityImage, region); !it.IsAtEnd(); ++it)
+  {
+    it.Set(static_cast<unsigned short>(16 * it.GetIndex()[0]));
+    objectMap->SetPixel(it.GetIndex(), rowLabels[it.GetIndex()[1]]);
+  }
+
+  objectMap->AddAnalyzeObjectEntry("Red");
+  objectMap->GetObjectEntry(1)->SetEndRed(255);
+  objectMap->GetObjectEntry(1)->SetOpacity(1.0f);
+  objectMap->AddAnalyzeObjectEntry("Blue ramp");
+  objectMap->GetObjectEntry(2)->SetEndBlue(255);
+  objectMap->GetObjectEntry(2)->SetShades(2);
+  objectMap->GetObjectEntry(2)->SetOpacity(1.0f);
+  objectMap->AddAnalyzeObjectEntry("Translucent green");
+  objectMap->GetObjectEntry(3)->SetEndGreen(255);
+  objectMap->AddAnalyzeObjectEntry("Hidden");
+  objectMap->GetObjectEntry(4)->SetEndRed(255);
+  objectMap->GetObjectEntry(4)->SetOpacity(1.0f);
+  objectMap->GetObjectEntry(4)->SetDisplayFlag(0);
+  objectMap->AddAnalyzeObjectEntry("Shaded yellow");
+  objectMap->GetObjectEntry(5)->SetEndRed(255);
+  objectMap->GetObjectEntry(5)->SetEndGreen(255);
+  objectMap->GetObjectEntry(5)->SetOpacity(1.0f);
+  objectMap->GetObjectEntry(5)->SetBlendFactor(0.5f);
+
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(intensityImage);
+  filter->SetLabelImage(objectMap);
+  filter->SetIntensityMinimum(0);
+  filter->SetIntensityMaximum(255);
+  try
+  {
+    filter->Update();
+  }
+  catch (itk::ExceptionObject & err)
+  {
+    std::cerr << "ExceptionObject caught !" << std::endl << err << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  int                                 error_count = 0;
+  const FilterType::OutputImageType * output = filter->GetOutput();
+
+  // Checks the voxel x, y of the middle slice.
+  const auto check = [&](itk::IndexValueType x, itk::IndexValueType y, const RGBPixelType & expected) {
+    const FilterType::OutputImageType::IndexType index = { { x, y, 1 } };
+    const RGBPixelType &                         pixel = output->GetPixel(index);
+    for (unsigned int c = 0; c < 3; c++)
+    {
+      if (pixel[c] != expected[c])
+      {
+        std::cerr << "Voxel " << x << ',' << y << " is " << static_cast<int>(pixel[0]) << ' '
+                  << static_cast<int>(pixel[1]) << ' ' << static_cast<int>(pixel[2]) << " instead of "
+                  << static_cast<int>(expected[0]) << ' ' << static_cast<int>(expected[1]) << ' '
+                  << static_cast<int>(expected[2]) << std::endl;
+        error_count++;
+        return;
+      }
+    }
+  };
+  const auto rgb = [](int red, int green, int blue) {
+    RGBPixelType pixel;
+    pixel[0] = static_cast<unsigned char>(red);
+    pixel[1] = static_cast<unsigned char>(green);
+    pixel[2] = static_cast<unsigned char>(blue);
+    return pixel;
+  };
+  for (itk::IndexValueType x = 0; x < 16; x += 5)
+  {
+    const int gray = static_cast<int>(16 * x);
+    check(x, 0, rgb(gray, gray, gray));
+    check(x, 1, rgb(255, 0, 0));
+    check(x, 2, x < 8 ? rgb(0, 0, 0) : rgb(0, 0, 255));
+    check(x, 3, rgb(gray / 2, (gray + 255) / 2, gray / 2));
+    check(x, 4, rgb(gray, gray, gray));
+    check(x, 5, rgb(127 + gray / 2, 127 + gray / 2, 0));
+    check(x, 6, rgb(gray, gray, gray));
+  }
+
+  // A slice is painted as in the whole image, although the intensities of the other slices differ.
+  IntensityImageType::IndexType outside = { { 3, 0, 2 } };
+  intensityImage->SetPixel(outside, 4000);
+  ObjectMapType::RegionType slice = region;
+  slice.SetIndex(2, 1);
+  slice.SetSize(2, 1);
+  FilterType::Pointer sliceFilter = FilterType::New();
+  sliceFilter->SetInput(intensityImage);
+  sliceFilter->SetLabelImage(objectMap);
+  sliceFilter->SetIntensityMinimum(0);
+  sliceFilter->SetIntensityMaximum(255);
+  sliceFilter->GetOutput()->SetRequestedRegion(slice);
+  sliceFilter->Update();
+  for (itk::ImageRegionConstIterator<FilterType::OutputImageType> it(sliceFilter->GetOutput(), slice); !it.IsAtEnd();
+       ++it)
+  {
+    if (it.Get() != output->GetPixel(it.GetIndex()))
+    {
+      std::cerr << "The slice differs from the whole image" << std::endl;
+      error_count++;
+      break;
+    }
+  }
+
+  // Without a window the range of the intensities is used, and a table given to the filter
+  // replaces the entries of the object map.
+  itk::AnalyzeObjectEntryTable table(2);
+  table[1].SetEndGreen(255);
+  table[1].SetOpacity(1.0f);
+  FilterType::Pointer tableFilter = FilterType::New();
+  tableFilter->SetInput(intensityImage);
+  tableFilter->SetLabelImage(objectMap);
+  tableFilter->SetEntryTable(table);
+  tableFilter->GetOutput()->SetRequestedRegion(slice);
+  tableFilter->Update();
+  FilterType::OutputImageType::IndexType brightest = { { 15, 0, 1 } };
+  FilterType::OutputImageType::IndexType painted = { { 0, 1, 1 } };
+  FilterType::OutputImageType::IndexType unpainted = { { 0, 2, 1 } };
+  if (tableFilter->GetOutput()->GetPixel(brightest) != rgb(255, 255, 255) ||
+      tableFilter->GetOutput()->GetPixel(painted) != rgb(0, 255, 0) ||
+      tableFilter->GetOutput()->GetPixel(unpainted) != rgb(0, 0, 0))
+  {
+    std::cerr << "The entry table or the intensity range was not used" << std::endl;
+    error_count++;
+  }
+
+  // A NaN intensity is painted as the bottom of the window.
+  using FloatImageType = itk::Image<float, Dimension>;
+  using FloatFilterType = itk::AnalyzeObjectMapOverlayImageFilter<FloatImageType, ObjectMapType>;
+  FloatImageType::Pointer floatImage = FloatImageType::New();
+  floatImage->SetRegions(region);
+  floatImage->Allocate();
+  floatImage->FillBuffer(100.0f);
+  floatImage->SetPixel(brightest, std::numeric_limits<float>::quiet_NaN());
+  FloatFilterType::Pointer floatFilter = FloatFilterType::New();
+  floatFilter->SetInput(floatImage);
+  floatFilter->SetLabelImage(objectMap);
+  floatFilter->SetIntensityMinimum(0);
+  floatFilter->SetIntensityMaximum(255);
+  floatFilter->Update();
+  FloatImageType::IndexType beside = { { 14, 0, 1 } };
+  if (floatFilter->GetOutput()->GetPixel(brightest) != rgb(0, 0, 0) ||
+      floatFilter->GetOutput()->GetPixel(beside) != rgb(100, 100, 100))
+  {
+    std::cerr << "A NaN intensity was not painted as the bottom of the window" << std::endl;
+    error_count++;
+  }
+
+  if (error_count)
+  {
+    std::cerr << error_count << " errors painting the overlay" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
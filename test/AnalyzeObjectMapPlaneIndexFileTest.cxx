@@ -0,0 +1,141 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#  pragma warning(disable : 4786)
+#endif
+
+#include "itkAnalyzeObjectLabelMapImageIO.h"
+#include "itksys/SystemTools.hxx"
+
+#include <fstream>
+#include <vector>
+
+// Reads a region of an object map through a sidecar plane index, and checks that the sidecar is
+// reused, that a corrupt or stale sidecar is ignored, and that planes are found by label.
+int
+AnalyzeObjectMapPlaneIndexFileTest(int ac, char * av[])
+{
+  if (ac != 2)
+  {
+    std::cerr << "USAGE: " << av[0] << " <outputFileName>" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const std::string ObjectFileName = av[1];
+  const std::string SidecarFileName = ObjectFileName + ".idx";
+
+  // Label 1 fills plane 0, label 2 is drawn in planes 1 and 4, label 3 in plane 3.
+  const unsigned int         size[3] = { 32, 16, 6 };
+  const unsigned int         PlaneSize = size[0] * size[1];
+  std::vector<unsigned char> Image(PlaneSize * size[2], 0);
+  std::fill_n(Image.begin(), PlaneSize, 1);
+  for (unsigned int i = 5; i < 200; i++)
+  {
+    Image[1 * PlaneSize + i] = 2;
+    Image[4 * PlaneSize + i] = 2;
+    Image[3 * PlaneSize + i + 100] = 3;
+  }
+
+  itk::AnalyzeObjectLabelMapImageIO::Pointer WriteIO = itk::AnalyzeObjectLabelMapImageIO::New();
+  WriteIO->SetNumberOfDimensions(3);
+  for (unsigned int d = 0; d < 3; d++)
+  {
+    WriteIO->SetDimensions(d, size[d]);
+  }
+  WriteIO->SetComponentType(itk::IOComponentEnum::UCHAR);
+  WriteIO->SetFileName(ObjectFileName);
+
+  itk::ImageIORegion region(3);
+  region.SetIndex(0, 3);
+  region.SetIndex(1, 2);
+  region.SetIndex(2, 0);
+  region.SetSize(0, 20);
+  region.SetSize(1, 10);
+  region.SetSize(2, 5);
+
+  int error_count = 0;
+  try
+  {
+    WriteIO->Write(Image.data());
+    if (itksys::SystemTools::FileExists(SidecarFileName))
+    {
+      std::cerr << "A stale sidecar was not removed by Write()" << std::endl;
+      error_count++;
+    }
+
+    // The first read builds the index and saves it; the second one loads it.  The last one finds
+    // the sidecar corrupt, ignores it, and rebuilds it.
+    for (unsigned int pass = 0; pass < 3; pass++)
+    {
+      if (pass == 2)
+      {
+        std::fstream sidecar(SidecarFileName.c_str(), std::ios::binary | std::ios::in | std::ios::out);
+        sidecar.seekp(8 * 9);
+        sidecar.put('\x7f');
+      }
+      itk::AnalyzeObjectLabelMapImageIO::Pointer ReadIO = itk::AnalyzeObjectLabelMapImageIO::New();
+      ReadIO->SetFileName(ObjectFileName);
+      ReadIO->UsePlaneIndexFileOn();
+      ReadIO->ReadImageInformation();
+      ReadIO->SetIORegion(region);
+      std::vector<unsigned char> Buffer(region.GetNumberOfPixels(), 255);
+      ReadIO->Read(Buffer.data());
+      if (!itksys::SystemTools::FileExists(SidecarFileName))
+      {
+        std::cerr << "No sidecar was written in pass " << pass << std::endl;
+        error_count++;
+      }
+
+      unsigned int index = 0;
+      for (unsigned int z = 0; z < 5; z++)
+      {
+        for (unsigned int y = 2; y < 12; y++)
+        {
+          for (unsigned int x = 3; x < 23; x++, index++)
+          {
+            if (Buffer[index] != Image[z * PlaneSize + y * size[0] + x])
+            {
+              error_count++;
+            }
+          }
+        }
+      }
+
+      const std::vector<itk::SizeValueType> planesWithLabel2 = ReadIO->GetPlanesContainingLabel(2);
+      const std::vector<itk::SizeValueType> planesWithLabel3 = ReadIO->GetPlanesContainingLabel(3);
+      if (planesWithLabel2 != std::vector<itk::SizeValueType>{ 1, 4 } ||
+          planesWithLabel3 != std::vector<itk::SizeValueType>{ 3 } || !ReadIO->GetPlanesContainingLabel(7).empty())
+      {
+        std::cerr << "The planes holding a label were not found in pass " << pass << std::endl;
+        error_count++;
+      }
+    }
+  }
+  catch (itk::ExceptionObject & err)
+  {
+    std::cerr << "ExceptionObject caught !" << std::endl << err << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (error_count)
+  {
+    std::cerr << error_count << " errors reading through the sidecar plane index" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,151 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#  pragma warning(disable : 4786)
+#endif
+
+#include "itkAnalyzeObjectLabelMapImageIO.h"
+#include "itkMetaDataObject.h"
+
+#include <cstring>
+#include <vector>
+
+// Probes the header of an object map and checks it against ReadImageInformation(), then probes
+// a batch of files and a little endian header held in memory.
+int
+AnalyzeObjectMapProbeTest(int ac, char * av[])
+{
+  if (ac != 2)
+  {
+    std::cerr << "USAGE: " << av[0] << " <inputFileName>" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const std::string InputObjectFileName = av[1];
+
+  itk::AnalyzeObjectLabelMapImageIO::Pointer io = itk::AnalyzeObjectLabelMapImageIO::New();
+  io->SetFileName(InputObjectFileName);
+  itk::AnalyzeObjectEntryArrayType entries;
+  try
+  {
+    io->ReadImageInformation();
+  }
+  catch (itk::ExceptionObject & err)
+  {
+    std::cerr << "ExceptionObject caught !" << std::endl << err << std::endl;
+    return EXIT_FAILURE;
+  }
+  itk::ExposeMetaData<itk::AnalyzeObjectEntryArrayType>(
+    io->GetMetaDataDictionary(), itk::ANALYZE_OBJECT_LABEL_MAP_ENTRY_ARRAY, entries);
+
+  int                                error_count = 0;
+  itk::AnalyzeObjectMapHeaderRecord record;
+  if (!itk::AnalyzeObjectLabelMapImageIO::ProbeHeader(InputObjectFileName, record) || !record.Valid)
+  {
+    std::cerr << "Could not probe " << InputObjectFileName << std::endl;
+    return EXIT_FAILURE;
+  }
+  for (unsigned int d = 0; d < io->GetNumberOfDimensions(); d++)
+  {
+    if (static_cast<itk::SizeValueType>(record.Dimensions[d]) != io->GetDimensions(d))
+    {
+      std::cerr << "Dimension " << d << " differs" << std::endl;
+      error_count++;
+    }
+  }
+  if (record.Entries.size() != entries.size() || record.NumberOfObjects != static_cast<int>(entries.size()))
+  {
+    std::cerr << "The number of entries differs" << std::endl;
+    return EXIT_FAILURE;
+  }
+  for (unsigned int i = 0; i < entries.size(); i++)
+  {
+    const itk::AnalyzeObjectEntryRecord & entry = record.Entries[i];
+    if (entries[i]->GetName() != std::string(entry.Name) || entries[i]->GetEndRed() != entry.EndRed ||
+        entries[i]->GetStartBlue() != entry.StartBlue || entries[i]->GetShades() != entry.Shades ||
+        entries[i]->GetOpacity() != entry.Opacity || entries[i]->GetMaximumZValue() != entry.MaximumZValue ||
+        entries[i]->GetBlendFactor() != entry.BlendFactor)
+    {
+      std::cerr << "Entry " << i << " differs" << std::endl;
+      error_count++;
+    }
+  }
+
+  // Probing without the entries reads the header only.
+  itk::AnalyzeObjectMapHeaderRecord headerOnly;
+  if (!itk::AnalyzeObjectLabelMapImageIO::ProbeHeader(InputObjectFileName, headerOnly, false) ||
+      !headerOnly.Entries.empty() || headerOnly.DataOffset != record.DataOffset)
+  {
+    std::cerr << "Probing the header only failed" << std::endl;
+    error_count++;
+  }
+
+  // A batch with files that cannot be probed.
+  std::vector<std::string> fileNames;
+  for (unsigned int i = 0; i < 50; i++)
+  {
+    fileNames.push_back(i % 10 == 3 ? InputObjectFileName + ".missing" : InputObjectFileName);
+  }
+  std::vector<itk::AnalyzeObjectMapHeaderRecord> records;
+  itk::AnalyzeObjectLabelMapImageIO::ProbeHeaders(fileNames, records, true, 4);
+  for (unsigned int i = 0; i < fileNames.size(); i++)
+  {
+    const bool expectValid = i % 10 != 3;
+    const bool sameHeader =
+      records[i].Entries.size() == entries.size() && records[i].Dimensions[0] == record.Dimensions[0];
+    if (records[i].Valid != expectValid || (expectValid && !sameHeader))
+    {
+      std::cerr << "Batch probe " << i << " is wrong" << std::endl;
+      error_count++;
+    }
+  }
+
+  // A little endian VERSION6 header, which has no time dimension, followed by a single entry.
+  std::vector<unsigned char> bytes(20 + itk::AnalyzeObjectEntryRecord::SizeInFile, 0);
+  const int                  header[5] = { itk::VERSION6, 7, 5, 3, 1 };
+  for (unsigned int i = 0; i < 5; i++)
+  {
+    for (unsigned int b = 0; b < 4; b++)
+    {
+      bytes[4 * i + b] = static_cast<unsigned char>(static_cast<unsigned int>(header[i]) >> (8 * b));
+    }
+  }
+  std::memcpy(bytes.data() + 20, "Background", 10);
+  bytes[20 + 44] = 42; // Least significant byte of StartRed.
+  itk::AnalyzeObjectMapHeaderRecord littleEndian;
+  if (!littleEndian.Decode(bytes.data(), bytes.size(), true) || littleEndian.BigEndian ||
+      littleEndian.Version != itk::VERSION6 || littleEndian.Dimensions[2] != 3 || littleEndian.Dimensions[3] != 1 ||
+      littleEndian.DataOffset != bytes.size() || std::string(littleEndian.Entries[0].Name) != "Background" ||
+      littleEndian.Entries[0].StartRed != 42)
+  {
+    std::cerr << "The little endian header was not decoded" << std::endl;
+    error_count++;
+  }
+  if (littleEndian.Decode(bytes.data(), bytes.size() - 1, true))
+  {
+    std::cerr << "A truncated entry table was accepted" << std::endl;
+    error_count++;
+  }
+
+  if (error_count)
+  {
+    std::cerr << error_count << " errors probing object map headers" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
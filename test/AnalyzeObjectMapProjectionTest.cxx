@@ -0,0 +1,162 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#  pragma warning(disable : 4786)
+#endif
+
+#include "itkAnalyzeObjectLabelMapImageIO.h"
+
+#include <fstream>
+#include <vector>
+
+namespace
+{
+using BufferType = std::vector<unsigned char>;
+using IOType = itk::AnalyzeObjectLabelMapImageIO;
+
+// Counts the columns of the projections of labels that differ from those computed from voxels,
+// which hold numberOfPlanes planes of planeSize voxels.
+int
+CheckProjections(const std::vector<IOType::ProjectionImageType::Pointer> & projections,
+                 const std::vector<unsigned char> &                        labels,
+                 const BufferType &                                        voxels,
+                 itk::SizeValueType                                        planeSize)
+{
+  int errors = projections.size() != labels.size();
+  for (itk::SizeValueType i = 0; i < projections.size() && i < labels.size(); i++)
+  {
+    const unsigned char * projection = projections[i]->GetBufferPointer();
+    errors += projections[i]->GetLargestPossibleRegion().GetNumberOfPixels() != planeSize;
+    for (itk::SizeValueType column = 0; column < planeSize; column++)
+    {
+      unsigned char expected = 0;
+      for (itk::SizeValueType voxel = column; voxel < voxels.size(); voxel += planeSize)
+      {
+        expected |= voxels[voxel] == labels[i];
+      }
+      errors += projection[column] != expected;
+    }
+  }
+  return errors;
+}
+} // namespace
+
+// Projects labels of an object map of two frames, with planes that hold a single label and planes
+// that hold none of the labels, with one and with several threads, and the labels of inputFileName.
+int
+AnalyzeObjectMapProjectionTest(int ac, char * av[])
+{
+  if (ac != 3)
+  {
+    std::cerr << "USAGE: " << av[0] << " <inputFileName> <outputFileName>" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const char * InputObjectFileName = av[1];
+  const char * OutputObjectFileName = av[2];
+
+  int error_count = 0;
+
+  // Planes of 70 by 3 voxels, so that a mask spans several words.  Plane 1 of every frame only holds
+  // label 2, label 1 is a diagonal and label 3 only occurs in the last frame.
+  const int                dimensions[4] = { 70, 3, 5, 2 };
+  const itk::SizeValueType planeSize = 70 * 3;
+  const itk::SizeValueType numberOfVoxels = planeSize * 5 * 2;
+  BufferType               voxels(numberOfVoxels, 0);
+  for (itk::SizeValueType i = 0; i < numberOfVoxels; i++)
+  {
+    const itk::SizeValueType x = i % 70;
+    const itk::SizeValueType plane = i / planeSize;
+    if (plane % 5 == 1)
+    {
+      voxels[i] = 2;
+    }
+    else if (x == plane * 7)
+    {
+      voxels[i] = 1;
+    }
+    else if (plane > 5 && x > 60 && i % planeSize >= 140)
+    {
+      voxels[i] = 3;
+    }
+  }
+  itk::AnalyzeObjectMapHeaderRecord header;
+  header.Version = itk::VERSION7;
+  std::copy(dimensions, dimensions + 4, header.Dimensions);
+  header.Entries.resize(4);
+  BufferType bytes;
+  header.Encode(bytes, true);
+  itk::AnalyzeObjectRunLengthCodec::EncodeVolume(voxels.data(), numberOfVoxels, planeSize, bytes);
+  std::ofstream outputFileStream(OutputObjectFileName, std::ios::binary | std::ios::out | std::ios::trunc);
+  outputFileStream.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+  outputFileStream.close();
+
+  IOType::Pointer                  io = IOType::New();
+  const std::vector<unsigned char> labels = { 1, 2, 3, 9, 1 };
+  try
+  {
+    io->SetFileName(OutputObjectFileName);
+    io->ReadImageInformation();
+    for (const itk::ThreadIdType numberOfThreads : { 1, 3, 0 })
+    {
+      const int errors = CheckProjections(io->GetLabelProjections(labels, numberOfThreads), labels, voxels, planeSize);
+      if (errors > 0)
+      {
+        std::cerr << errors << " columns projected with " << numberOfThreads << " threads are wrong" << std::endl;
+        error_count++;
+      }
+    }
+
+    // The projections take the x and y axes of the map, here swapped.
+    io->SetDirection(0, std::vector<double>{ 0.0, 1.0, 0.0, 0.0 });
+    io->SetDirection(1, std::vector<double>{ 1.0, 0.0, 0.0, 0.0 });
+    const IOType::ProjectionImageType::DirectionType direction = io->GetLabelProjections(labels)[0]->GetDirection();
+    if (direction[0][0] != 0.0 || direction[1][0] != 1.0 || direction[0][1] != 1.0 || direction[1][1] != 0.0)
+    {
+      std::cerr << "The projections do not have the direction of the object map" << std::endl;
+      error_count++;
+    }
+
+    // The labels of a file, against its decoded voxels.
+    io->SetFileName(InputObjectFileName);
+    io->ReadImageInformation();
+    BufferType fileVoxels(io->GetImageSizeInPixels());
+    io->ReadToBuffer(fileVoxels.data(), itk::IOComponentEnum::UCHAR);
+    const itk::SizeValueType         filePlaneSize = io->GetDimensions(0) * io->GetDimensions(1);
+    const std::vector<unsigned char> fileLabels = { 0, 1, 2, 3, 4, 5 };
+    const int                        errors =
+      CheckProjections(io->GetLabelProjections(fileLabels, 2), fileLabels, fileVoxels, filePlaneSize);
+    if (errors > 0)
+    {
+      std::cerr << errors << " columns projected from " << InputObjectFileName << " are wrong" << std::endl;
+      error_count++;
+    }
+  }
+  catch (itk::ExceptionObject & err)
+  {
+    std::cerr << "ExceptionObject caught !" << std::endl << err << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (error_count)
+  {
+    std::cerr << error_count << " errors projecting object maps" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
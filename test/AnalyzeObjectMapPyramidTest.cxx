@@ -0,0 +1,247 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#  pragma warning(disable : 4786)
+#endif
+
+#include "itkAnalyzeObjectMapPyramid.h"
+#include "itkAnalyzeObjectEntryTable.h"
+#include "itkAnalyzeObjectRunLengthCodec.h"
+
+#include <fstream>
+#include <vector>
+
+namespace
+{
+using BufferType = std::vector<unsigned char>;
+using PyramidType = itk::AnalyzeObjectMapPyramid;
+
+// The label of the block of factor voxels at (ox, oy, oz) of frame t, computed from the voxels.
+unsigned char
+ReduceBlock(const BufferType &         voxels,
+            const int                  dimensions[4],
+            int                        factor,
+            int                        ox,
+            int                        oy,
+            int                        oz,
+            int                        t,
+            PyramidType::ReductionEnum reduction)
+{
+  unsigned int counts[256] = {};
+  for (int z = oz * factor; z < std::min((oz + 1) * factor, dimensions[2]); z++)
+  {
+    for (int y = oy * factor; y < std::min((oy + 1) * factor, dimensions[1]); y++)
+    {
+      for (int x = ox * factor; x < std::min((ox + 1) * factor, dimensions[0]); x++)
+      {
+        counts[voxels[((t * dimensions[2] + z) * dimensions[1] + y) * dimensions[0] + x]]++;
+      }
+    }
+  }
+  unsigned int label = 0;
+  for (unsigned int i = 1; i < 256; i++)
+  {
+    if (reduction == PyramidType::ReductionEnum::Maximum ? counts[i] > 0 : counts[i] > counts[label])
+    {
+      label = i;
+    }
+  }
+  return static_cast<unsigned char>(label);
+}
+
+// Counts the voxels of every level that differ from those computed block by block.
+int
+CheckLevels(const PyramidType & pyramid, const BufferType & voxels, const int dimensions[4])
+{
+  int errors = 0;
+  for (unsigned int level = 0; level < pyramid.GetNumberOfGeneratedLevels(); level++)
+  {
+    const int                              factor = 2 << level;
+    const PyramidType::ImageType *         image = pyramid.GetLevel(level);
+    const PyramidType::ImageType::SizeType size = image->GetLargestPossibleRegion().GetSize();
+    const unsigned char *                  output = image->GetBufferPointer();
+    for (int t = 0; t < dimensions[3]; t++)
+    {
+      for (int oz = 0; oz < static_cast<int>(size[2]); oz++)
+      {
+        for (int oy = 0; oy < static_cast<int>(size[1]); oy++)
+        {
+          for (int ox = 0; ox < static_cast<int>(size[0]); ox++)
+          {
+            const unsigned char expected =
+              ReduceBlock(voxels, dimensions, factor, ox, oy, oz, t, pyramid.GetReduction());
+            errors += *output++ != expected;
+          }
+        }
+      }
+    }
+    if (size[0] != static_cast<itk::SizeValueType>((dimensions[0] + factor - 1) / factor) ||
+        size[3] != static_cast<itk::SizeValueType>(dimensions[3]) || image->GetSpacing()[2] != factor)
+    {
+      errors++;
+    }
+  }
+  return errors;
+}
+} // namespace
+
+// Downsamples an object map of two frames by mode and by maximum, and checks every level against
+// the labels of its blocks.  The levels of a map written to outputFileName are then written next to
+// it, and the levels of inputFileName are generated from the file.
+int
+AnalyzeObjectMapPyramidTest(int ac, char * av[])
+{
+  if (ac != 3)
+  {
+    std::cerr << "USAGE: " << av[0] << " <inputFileName> <outputFileName>" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const char * InputObjectFileName = av[1];
+  const char * OutputObjectFileName = av[2];
+
+  int error_count = 0;
+
+  // Blobs of labels 1 to 3 over a background, with sizes that are not multiples of the factors.
+  const int                dimensions[4] = { 13, 10, 9, 2 };
+  const itk::SizeValueType numberOfVoxels = 13 * 10 * 9 * 2;
+  BufferType               voxels(numberOfVoxels);
+  for (itk::SizeValueType i = 0; i < numberOfVoxels; i++)
+  {
+    const itk::SizeValueType x = i % 13;
+    const itk::SizeValueType y = i / 13 % 10;
+    const itk::SizeValueType z = i / 130 % 9;
+    voxels[i] = x < 4 && y < 7 ? 1 : (x + y + z + i / 1170) % 7 == 0 ? 3 : z > 5 ? 2 : 0;
+  }
+  itk::AnalyzeObjectEntryTable table;
+  table.AddEntry("Background");
+  table.AddEntry("One");
+  table.AddEntry("Two");
+  table.AddEntry("Three");
+  itk::AnalyzeObjectMapHeaderRecord header;
+  header.Version = itk::VERSION7;
+  std::copy(dimensions, dimensions + 4, header.Dimensions);
+  header.Entries = table.GetRecords();
+  BufferType input;
+  header.Encode(input, true);
+  itk::AnalyzeObjectRunLengthCodec::EncodeVolume(voxels.data(), numberOfVoxels, 130, input);
+
+  PyramidType pyramid;
+  try
+  {
+    for (const PyramidType::ReductionEnum reduction :
+         { PyramidType::ReductionEnum::Mode, PyramidType::ReductionEnum::Maximum })
+    {
+      pyramid.SetReduction(reduction);
+      pyramid.SetNumberOfLevels(3);
+      pyramid.Generate(input.data(), input.size());
+      const int errors = CheckLevels(pyramid, voxels, dimensions);
+      if (pyramid.GetNumberOfGeneratedLevels() != 3 || errors > 0)
+      {
+        std::cerr << errors << " voxels of the levels reduced by "
+                  << (reduction == PyramidType::ReductionEnum::Mode ? "mode" : "maximum") << " are wrong" << std::endl;
+        error_count++;
+      }
+    }
+  }
+  catch (itk::ExceptionObject & err)
+  {
+    std::cerr << "ExceptionObject caught !" << std::endl << err << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const int largeDimensions[4] = { 512, 512, 300, 1 };
+  if (PyramidType::GetNumberOfLevelsForSize(largeDimensions, 64) != 3 ||
+      PyramidType::GetNumberOfLevelsForSize(dimensions, 64) != 1 ||
+      PyramidType::GetLevelFileName("maps/brain.obj", 4) != "maps/brain_4x.obj")
+  {
+    std::cerr << "The number of levels of a preview, or the name of a level file, is wrong" << std::endl;
+    error_count++;
+  }
+
+  // The levels written next to a map hold the levels generated from it.
+  try
+  {
+    std::ofstream outputFileStream(OutputObjectFileName, std::ios::binary | std::ios::out | std::ios::trunc);
+    outputFileStream.write(reinterpret_cast<const char *>(input.data()), input.size());
+    outputFileStream.close();
+    pyramid.SetNumberOfLevels(2);
+    pyramid.SetWriteLevelFiles(true);
+    pyramid.GenerateFromFile(OutputObjectFileName);
+    if (CheckLevels(pyramid, voxels, dimensions) > 0)
+    {
+      std::cerr << "The levels generated from a file are wrong" << std::endl;
+      error_count++;
+    }
+    std::ifstream levelFileStream(PyramidType::GetLevelFileName(OutputObjectFileName, 4).c_str(), std::ios::binary);
+    BufferType    level((std::istreambuf_iterator<char>(levelFileStream)), std::istreambuf_iterator<char>());
+    itk::AnalyzeObjectMapHeaderRecord levelHeader;
+    BufferType                        levelVoxels(4 * 3 * 3 * 2);
+    itk::SizeValueType                index = 0;
+    if (!levelHeader.Decode(level.data(), level.size(), true) || levelHeader.Entries.size() != 4 ||
+        levelHeader.Dimensions[0] != 4 || levelHeader.Dimensions[3] != 2 ||
+        !itk::AnalyzeObjectRunLengthCodec::DecodeRuns(level.data() + levelHeader.DataOffset,
+                                                      level.size() - levelHeader.DataOffset,
+                                                      levelVoxels.data(),
+                                                      levelVoxels.size(),
+                                                      index) ||
+        index != levelVoxels.size() ||
+        !std::equal(levelVoxels.begin(), levelVoxels.end(), pyramid.GetLevel(1)->GetBufferPointer()))
+    {
+      std::cerr << "The level file does not hold the level" << std::endl;
+      error_count++;
+    }
+
+    pyramid.SetWriteLevelFiles(false);
+    pyramid.GenerateFromFile(InputObjectFileName);
+    const PyramidType::ImageType::SizeType size = pyramid.GetLevel(0)->GetLargestPossibleRegion().GetSize();
+    if (size[0] != static_cast<itk::SizeValueType>((pyramid.GetHeader().Dimensions[0] + 1) / 2))
+    {
+      std::cerr << "The levels of " << InputObjectFileName << " have a wrong size" << std::endl;
+      error_count++;
+    }
+  }
+  catch (itk::ExceptionObject & err)
+  {
+    std::cerr << "ExceptionObject caught !" << std::endl << err << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Runs that do not cover the map are an error.
+  bool caught = false;
+  try
+  {
+    pyramid.Generate(input.data(), input.size() - 2);
+  }
+  catch (itk::ExceptionObject &)
+  {
+    caught = true;
+  }
+  if (!caught)
+  {
+    std::cerr << "A truncated map was downsampled" << std::endl;
+    error_count++;
+  }
+
+  if (error_count)
+  {
+    std::cerr << error_count << " errors downsampling object maps" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
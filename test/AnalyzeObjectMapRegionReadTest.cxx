@@ -0,0 +1,130 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#  pragma warning(disable : 4786)
+#endif
+
+#include "itkAnalyzeObjectLabelMapImageIO.h"
+
+#include <vector>
+
+// Writes a 4D object map and reads several regions of it, comparing them against the whole image.
+int
+AnalyzeObjectMapRegionReadTest(int ac, char * av[])
+{
+  if (ac != 2)
+  {
+    std::cerr << "USAGE: " << av[0] << " <outputFileName>" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const char * ObjectFileName = av[1];
+
+  const unsigned int         size[4] = { 300, 20, 9, 2 };
+  std::vector<unsigned char> Image(size[0] * size[1] * size[2] * size[3]);
+  for (unsigned int i = 0; i < Image.size(); i++)
+  {
+    // Long runs of background interrupted by short runs of changing labels.
+    const unsigned int x = i % size[0];
+    Image[i] = (x > 40 && x < 290) ? static_cast<unsigned char>((i / 7) % 5) : 0;
+  }
+
+  itk::AnalyzeObjectLabelMapImageIO::Pointer WriteIO = itk::AnalyzeObjectLabelMapImageIO::New();
+  WriteIO->SetNumberOfDimensions(4);
+  for (unsigned int d = 0; d < 4; d++)
+  {
+    WriteIO->SetDimensions(d, size[d]);
+  }
+  WriteIO->SetComponentType(itk::IOComponentEnum::UCHAR);
+  WriteIO->SetFileName(ObjectFileName);
+
+  itk::AnalyzeObjectLabelMapImageIO::Pointer ReadIO = itk::AnalyzeObjectLabelMapImageIO::New();
+  ReadIO->SetFileName(ObjectFileName);
+  try
+  {
+    WriteIO->Write(Image.data());
+    ReadIO->ReadImageInformation();
+  }
+  catch (itk::ExceptionObject & err)
+  {
+    std::cerr << "ExceptionObject caught !" << std::endl << err << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const unsigned int regions[][8] = {
+    { 0, 0, 0, 0, 300, 20, 9, 2 },  // The whole image
+    { 35, 3, 2, 1, 64, 10, 4, 1 },  // A brick in the second time frame
+    { 0, 19, 8, 0, 300, 1, 1, 2 },  // The last row of the last plane
+    { 299, 0, 0, 0, 1, 20, 9, 2 },  // The last column
+    { 120, 7, 5, 1, 1, 1, 1, 1 },   // A single voxel
+    { 250, 2, 0, 0, 50, 17, 9, 1 }, // A brick that contains runs longer than its rows
+  };
+
+  int error_count = 0;
+  for (const auto & r : regions)
+  {
+    itk::ImageIORegion region(4);
+    for (unsigned int d = 0; d < 4; d++)
+    {
+      region.SetIndex(d, r[d]);
+      region.SetSize(d, r[d + 4]);
+    }
+    if (ReadIO->GenerateStreamableReadRegionFromRequestedRegion(region).GetNumberOfPixels() !=
+        region.GetNumberOfPixels())
+    {
+      std::cerr << "The streamable region differs from the requested region" << std::endl;
+      error_count++;
+    }
+    ReadIO->SetIORegion(region);
+    std::vector<unsigned char> Buffer(region.GetNumberOfPixels(), 255);
+    try
+    {
+      ReadIO->Read(Buffer.data());
+    }
+    catch (itk::ExceptionObject & err)
+    {
+      std::cerr << "ExceptionObject caught !" << std::endl << err << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    unsigned int index = 0;
+    for (unsigned int t = r[3]; t < r[3] + r[7]; t++)
+    {
+      for (unsigned int z = r[2]; z < r[2] + r[6]; z++)
+      {
+        for (unsigned int y = r[1]; y < r[1] + r[5]; y++)
+        {
+          for (unsigned int x = r[0]; x < r[0] + r[4]; x++, index++)
+          {
+            if (Buffer[index] != Image[((t * size[2] + z) * size[1] + y) * size[0] + x])
+            {
+              error_count++;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  if (error_count)
+  {
+    std::cerr << error_count << " voxels differ between the regions and the whole image" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,207 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#  pragma warning(disable : 4786)
+#endif
+
+#include "itkAnalyzeObjectMapRepacker.h"
+#include "itkAnalyzeObjectMapComparator.h"
+#include "itkAnalyzeObjectEntryTable.h"
+#include "itkAnalyzeObjectRunLengthCodec.h"
+
+#include <vector>
+
+namespace
+{
+using BufferType = std::vector<unsigned char>;
+
+// Encodes the header of an object map with the entries of table.
+BufferType
+EncodeHeader(const int dimensions[4], const itk::AnalyzeObjectEntryTable & table)
+{
+  itk::AnalyzeObjectMapHeaderRecord header;
+  header.Version = itk::VERSION7;
+  std::copy(dimensions, dimensions + 4, header.Dimensions);
+  header.Entries = table.GetRecords();
+  BufferType bytes;
+  header.Encode(bytes, true);
+  return bytes;
+}
+
+// Returns the names of the entries of a whole object map held in memory.
+std::vector<std::string>
+GetEntryNames(const BufferType & bytes)
+{
+  itk::AnalyzeObjectMapHeaderRecord header;
+  header.Decode(bytes.data(), bytes.size(), true);
+  std::vector<std::string> names;
+  for (itk::AnalyzeObjectEntryRecord & record : header.Entries)
+  {
+    names.push_back(itk::AnalyzeObjectEntryTable::EntryView(&record).GetName());
+  }
+  return names;
+}
+} // namespace
+
+// Repacks object maps whose runs are split, join and cross planes, with and without renumbering
+// their labels, and an object map file into another file and then into itself.
+int
+AnalyzeObjectMapRepackTest(int ac, char * av[])
+{
+  if (ac != 3)
+  {
+    std::cerr << "USAGE: " << av[0] << " <inputFileName> <outputFileName>" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const char * InputObjectFileName = av[1];
+  const char * OutputObjectFileName = av[2];
+
+  int error_count = 0;
+
+  // Planes of 10 by 4 voxels: label 2 fills plane 0, label 0 and label 5 share plane 1, and label 5
+  // fills plane 2.  256 entries are written, as for an image without entries.
+  const int                    dimensions[4] = { 10, 4, 3, 1 };
+  const itk::SizeValueType     numberOfVoxels = 10 * 4 * 3;
+  itk::AnalyzeObjectEntryTable table;
+  for (unsigned int i = 0; i < 256; i++)
+  {
+    table.AddEntry("Blank Object");
+  }
+  table[0].SetName("Background");
+  table[2].SetName("Two");
+  table[3].SetName("Unused");
+  table[5].SetName("Five");
+  BufferType voxels(numberOfVoxels, 5);
+  std::fill(voxels.begin(), voxels.begin() + 40, 2);
+  std::fill(voxels.begin() + 40, voxels.begin() + 60, 0);
+  BufferType          input = EncodeHeader(dimensions, table);
+  const unsigned char runs[] = { 10, 2, 10, 2, 20, 2, 20, 0, 60, 5 };
+  input.insert(input.end(), runs, runs + sizeof(runs));
+
+  itk::AnalyzeObjectMapRepacker repacker;
+  BufferType                    output;
+  itk::AnalyzeObjectEntryTable  trimmed;
+  for (unsigned int i = 0; i < 6; i++)
+  {
+    trimmed.GetRecords().push_back(table.GetRecords()[i]);
+  }
+  BufferType expected = EncodeHeader(dimensions, trimmed);
+  itk::AnalyzeObjectRunLengthCodec::EncodeVolume(voxels.data(), numberOfVoxels, 40, expected);
+  try
+  {
+    repacker.Repack(input.data(), input.size(), output);
+  }
+  catch (itk::ExceptionObject & err)
+  {
+    std::cerr << "ExceptionObject caught !" << std::endl << err << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (output != expected || repacker.GetNumberOfInputRunBytes() != 10 || repacker.GetNumberOfOutputRunBytes() != 8)
+  {
+    std::cerr << "The map was not repacked into the canonical encoding, or its entries were not trimmed" << std::endl;
+    error_count++;
+  }
+
+  // Renumbering removes the entry of label 3 and moves labels 2 and 5 to 1 and 2.
+  repacker.SetRenumberLabels(true);
+  repacker.Repack(input.data(), input.size(), output);
+  for (unsigned char & voxel : voxels)
+  {
+    voxel = voxel == 2 ? 1 : voxel == 5 ? 2 : voxel;
+  }
+  BufferType expectedRuns;
+  itk::AnalyzeObjectRunLengthCodec::EncodeVolume(voxels.data(), numberOfVoxels, 40, expectedRuns);
+  if (GetEntryNames(output) != std::vector<std::string>{ "Background", "Two", "Five" } ||
+      !std::equal(expectedRuns.begin(), expectedRuns.end(), output.end() - expectedRuns.size()))
+  {
+    std::cerr << "The labels were not renumbered" << std::endl;
+    error_count++;
+  }
+
+  // Without trimming, all the entries are kept, and runs longer than 255 voxels are split.
+  repacker.SetRenumberLabels(false);
+  repacker.SetTrimEntries(false);
+  const int  lineDimensions[4] = { 300, 1, 1, 1 };
+  BufferType line = EncodeHeader(lineDimensions, table);
+  for (unsigned int i = 0; i < 3; i++)
+  {
+    line.push_back(100);
+    line.push_back(7);
+  }
+  repacker.Repack(line.data(), line.size(), output);
+  const unsigned char lineRuns[] = { 255, 7, 45, 7 };
+  if (GetEntryNames(output).size() != 256 || repacker.GetNumberOfOutputRunBytes() != sizeof(lineRuns) ||
+      !std::equal(lineRuns, lineRuns + sizeof(lineRuns), output.end() - sizeof(lineRuns)))
+  {
+    std::cerr << "Runs longer than 255 voxels were not split" << std::endl;
+    error_count++;
+  }
+
+  // Runs that do not cover the map are an error.
+  bool caught = false;
+  try
+  {
+    repacker.Repack(input.data(), input.size() - 2, output);
+  }
+  catch (itk::ExceptionObject &)
+  {
+    caught = true;
+  }
+  if (!caught)
+  {
+    std::cerr << "A truncated map was repacked" << std::endl;
+    error_count++;
+  }
+
+  // A file, repacked into another file and then into itself, keeps its voxels.
+  repacker.SetTrimEntries(true);
+  itk::AnalyzeObjectMapComparator comparator;
+  try
+  {
+    repacker.RepackFile(InputObjectFileName, OutputObjectFileName);
+    comparator.CompareFiles(InputObjectFileName, OutputObjectFileName);
+    if (!comparator.VoxelsAreEqual() || repacker.GetNumberOfOutputRunBytes() > repacker.GetNumberOfInputRunBytes())
+    {
+      std::cerr << "The voxels of the repacked file differ" << std::endl;
+      comparator.Print(std::cerr);
+      error_count++;
+    }
+    const itk::SizeValueType numberOfRunBytes = repacker.GetNumberOfOutputRunBytes();
+    repacker.RepackFile(OutputObjectFileName, OutputObjectFileName);
+    comparator.CompareFiles(InputObjectFileName, OutputObjectFileName);
+    if (!comparator.VoxelsAreEqual() || repacker.GetNumberOfOutputRunBytes() != numberOfRunBytes ||
+        repacker.GetNumberOfInputRunBytes() != numberOfRunBytes)
+    {
+      std::cerr << "A file repacked into itself changed" << std::endl;
+      error_count++;
+    }
+  }
+  catch (itk::ExceptionObject & err)
+  {
+    std::cerr << "ExceptionObject caught !" << std::endl << err << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (error_count)
+  {
+    std::cerr << error_count << " errors repacking object maps" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
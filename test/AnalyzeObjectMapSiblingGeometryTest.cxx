@@ -0,0 +1,162 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#  pragma warning(disable : 4786)
+#endif
+
+#include "itkImageFileWriter.h"
+#include "itkAnalyzeObjectLabelMapImageIO.h"
+#include "itksys/SystemTools.hxx"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+// Reads the image information of fileName and returns the number of axes whose spacing and origin
+// differ from the expected ones.
+unsigned int
+CountGeometryErrors(const std::string & fileName,
+                    bool                useSiblingGeometry,
+                    const double        expectedSpacing[3],
+                    const double        expectedOrigin[3])
+{
+  itk::AnalyzeObjectLabelMapImageIO::Pointer io = itk::AnalyzeObjectLabelMapImageIO::New();
+  io->SetFileName(fileName);
+  io->SetUseSiblingGeometry(useSiblingGeometry);
+  io->ReadImageInformation();
+  unsigned int errors = 0;
+  for (unsigned int d = 0; d < io->GetNumberOfDimensions(); d++)
+  {
+    if (std::abs(io->GetSpacing(d) - expectedSpacing[d]) > 1e-6 ||
+        std::abs(io->GetOrigin(d) - expectedOrigin[d]) > 1e-6)
+    {
+      std::cerr << "Axis " << d << " of " << fileName << " has spacing " << io->GetSpacing(d) << " and origin "
+                << io->GetOrigin(d) << ", not " << expectedSpacing[d] << " and " << expectedOrigin[d] << std::endl;
+      errors++;
+    }
+  }
+  return errors;
+}
+} // namespace
+
+// Writes an object map next to a NIfTI image and checks that its geometry is taken from the header
+// of the image only when asked for, not when the image has another size, and no longer once the
+// image is removed.
+int
+AnalyzeObjectMapSiblingGeometryTest(int ac, char * av[])
+{
+  if (ac != 2)
+  {
+    std::cerr << "USAGE: " << av[0] << " <outputFileName>" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const std::string ObjectFileName = av[1];
+  const std::string SiblingFileName =
+    itksys::SystemTools::GetFilenamePath(ObjectFileName) + "/" +
+    itksys::SystemTools::GetFilenameWithoutLastExtension(itksys::SystemTools::GetFilenameName(ObjectFileName)) +
+    ".nii";
+
+  using ImageType = itk::Image<unsigned char, 3>;
+  const ImageType::SizeType size = { { 4, 3, 2 } };
+  ImageType::Pointer        image = ImageType::New();
+  image->SetRegions(size);
+  image->Allocate();
+  std::fill(image->GetBufferPointer(), image->GetBufferPointer() + 24, 1);
+  const double           siblingSpacing[3] = { 0.5, 2.0, 3.0 };
+  const double           siblingOrigin[3] = { 10.0, -5.0, 1.0 };
+  const double           defaultSpacing[3] = { 1.0, 1.0, 1.0 };
+  const double           defaultOrigin[3] = { 0.0, 0.0, 0.0 };
+  ImageType::SpacingType spacing;
+  ImageType::PointType   origin;
+  for (unsigned int d = 0; d < 3; d++)
+  {
+    spacing[d] = siblingSpacing[d];
+    origin[d] = siblingOrigin[d];
+  }
+  image->SetSpacing(spacing);
+  image->SetOrigin(origin);
+
+  unsigned int error_count = 0;
+  try
+  {
+    itk::AnalyzeObjectLabelMapImageIO::Pointer WriteIO = itk::AnalyzeObjectLabelMapImageIO::New();
+    WriteIO->SetNumberOfDimensions(3);
+    for (unsigned int d = 0; d < 3; d++)
+    {
+      WriteIO->SetDimensions(d, size[d]);
+    }
+    WriteIO->SetComponentType(itk::IOComponentEnum::UCHAR);
+    WriteIO->SetFileName(ObjectFileName);
+    WriteIO->Write(image->GetBufferPointer());
+
+    // Without a sibling image the geometry is left at its defaults.
+    itksys::SystemTools::RemoveFile(SiblingFileName);
+    error_count += CountGeometryErrors(ObjectFileName, true, defaultSpacing, defaultOrigin);
+
+    itk::ImageFileWriter<ImageType>::Pointer writer = itk::ImageFileWriter<ImageType>::New();
+    writer->SetInput(image);
+    writer->SetFileName(SiblingFileName);
+    writer->Update();
+    error_count += CountGeometryErrors(ObjectFileName, true, siblingSpacing, siblingOrigin);
+    error_count += CountGeometryErrors(ObjectFileName, true, siblingSpacing, siblingOrigin);
+    error_count += CountGeometryErrors(ObjectFileName, false, defaultSpacing, defaultOrigin);
+
+    itk::AnalyzeObjectSiblingGeometry::Geometry geometry;
+    if (!itk::AnalyzeObjectSiblingGeometry::GetInstance().Find(ObjectFileName, geometry) ||
+        geometry.FileName != SiblingFileName || geometry.GetNumberOfDimensions() != 3)
+    {
+      std::cerr << "The sibling of " << ObjectFileName << " was not found" << std::endl;
+      error_count++;
+    }
+
+    // A bounded lookup still finds the sibling.
+    itk::AnalyzeObjectSiblingGeometry::GetInstance().SetMaximumNumberOfEntries(1);
+    error_count += CountGeometryErrors(ObjectFileName, true, siblingSpacing, siblingOrigin);
+    itk::AnalyzeObjectSiblingGeometry::GetInstance().SetMaximumNumberOfEntries(4096);
+
+    // A sibling image of another size is not used.
+    const ImageType::SizeType otherSize = { { 5, 3, 2 } };
+    ImageType::Pointer        otherImage = ImageType::New();
+    otherImage->SetRegions(otherSize);
+    otherImage->Allocate();
+    otherImage->FillBuffer(1);
+    otherImage->SetSpacing(spacing);
+    otherImage->SetOrigin(origin);
+    writer->SetInput(otherImage);
+    writer->Update();
+    error_count += CountGeometryErrors(ObjectFileName, true, defaultSpacing, defaultOrigin);
+
+    // Removing the sibling image changes the directory, so it is no longer used.
+    itksys::SystemTools::RemoveFile(SiblingFileName);
+    error_count += CountGeometryErrors(ObjectFileName, true, defaultSpacing, defaultOrigin);
+  }
+  catch (itk::ExceptionObject & err)
+  {
+    std::cerr << "ExceptionObject caught !" << std::endl << err << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (error_count)
+  {
+    std::cerr << error_count << " errors taking the geometry of object maps from their siblings" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
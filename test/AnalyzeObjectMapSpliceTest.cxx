@@ -0,0 +1,182 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#  pragma warning(disable : 4786)
+#endif
+
+#include "itkAnalyzeObjectMapSplicer.h"
+#include "itkAnalyzeObjectEntryTable.h"
+#include "itkAnalyzeObjectLabelMapImageIO.h"
+#include "itkAnalyzeObjectRunLengthCodec.h"
+#include "itksys/SystemTools.hxx"
+
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace
+{
+// Decodes every voxel of fileName, whose header is read into header.  Returns an empty vector if the
+// runs do not hold exactly the voxels of the header.
+std::vector<unsigned char>
+ReadVoxels(const std::string & fileName, itk::AnalyzeObjectMapHeaderRecord & header)
+{
+  if (!itk::AnalyzeObjectLabelMapImageIO::ProbeHeader(fileName, header, true))
+  {
+    return {};
+  }
+  std::ifstream              inputFileStream(fileName.c_str(), std::ios::binary | std::ios::in);
+  std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(inputFileStream)), std::istreambuf_iterator<char>());
+  std::vector<unsigned char> voxels(static_cast<itk::SizeValueType>(header.Dimensions[0]) * header.Dimensions[1] *
+                                    header.Dimensions[2] * header.Dimensions[3]);
+  itk::SizeValueType         index = 0;
+  if (!itk::AnalyzeObjectRunLengthCodec::DecodeRuns(
+        bytes.data() + header.DataOffset, bytes.size() - header.DataOffset, voxels.data(), voxels.size(), index) ||
+      index != voxels.size())
+  {
+    return {};
+  }
+  return voxels;
+}
+} // namespace
+
+// Replaces a plane and a frame of an object map written in the little endian byte order of an old
+// version, then appends frames to it, and checks the voxels and header of the spliced file.
+int
+AnalyzeObjectMapSpliceTest(int ac, char * av[])
+{
+  if (ac != 2)
+  {
+    std::cerr << "USAGE: " << av[0] << " <outputFileName>" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const std::string OutputObjectFileName = av[1];
+  int               error_count = 0;
+
+  // A single frame of 8 by 6 by 3 voxels, in a VERSION6 file, whose header has no frame count.
+  constexpr itk::SizeValueType planeSize = 8 * 6;
+  constexpr itk::SizeValueType frameSize = planeSize * 3;
+  std::vector<unsigned char>   voxels(frameSize);
+  for (itk::SizeValueType i = 0; i < frameSize; i++)
+  {
+    voxels[i] = static_cast<unsigned char>(i % 7 < 3 ? 1 : 0);
+  }
+  itk::AnalyzeObjectEntryTable table;
+  table.AddEntry("Background");
+  table.AddEntry("Stripes");
+  table.AddEntry("Block");
+  itk::AnalyzeObjectMapHeaderRecord header;
+  header.Version = itk::VERSION6;
+  header.Dimensions[0] = 8;
+  header.Dimensions[1] = 6;
+  header.Dimensions[2] = 3;
+  header.Dimensions[3] = 1;
+  header.Entries = table.GetRecords();
+  std::vector<unsigned char> bytes;
+  header.Encode(bytes, false);
+  itk::AnalyzeObjectRunLengthCodec::EncodeVolume(voxels.data(), frameSize, planeSize, bytes);
+  std::ofstream outputFileStream(OutputObjectFileName.c_str(), std::ios::binary | std::ios::out | std::ios::trunc);
+  outputFileStream.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+  outputFileStream.close();
+
+  itk::AnalyzeObjectMapSplicer splicer;
+  try
+  {
+    // Plane 1 becomes a block of label 2; only its runs are encoded.
+    const std::vector<unsigned char> plane(planeSize, 2);
+    splicer.ReplacePlanes(OutputObjectFileName, 1, plane.data(), 1);
+    std::copy(plane.begin(), plane.end(), voxels.begin() + planeSize);
+    itk::AnalyzeObjectMapHeaderRecord spliced;
+    if (ReadVoxels(OutputObjectFileName, spliced) != voxels || spliced.Version != itk::VERSION6 ||
+        spliced.BigEndian || spliced.Entries.size() != 3 || splicer.GetNumberOfEncodedBytes() != 2 ||
+        splicer.GetNumberOfEncodedBytes() + splicer.GetNumberOfCopiedBytes() !=
+          static_cast<itk::SizeValueType>(itksys::SystemTools::FileLength(OutputObjectFileName)) - spliced.DataOffset)
+    {
+      std::cerr << "Plane 1 was spliced wrongly" << std::endl;
+      error_count++;
+    }
+
+    // The frame is replaced, then two frames are appended, which turns the file into a VERSION7 one.
+    std::vector<unsigned char> frames(frameSize * 3);
+    for (itk::SizeValueType i = 0; i < frames.size(); i++)
+    {
+      frames[i] = static_cast<unsigned char>(i / 5 % 3);
+    }
+    splicer.ReplaceFrames(OutputObjectFileName, 0, frames.data(), 1);
+    splicer.AppendFrames(OutputObjectFileName, frames.data() + frameSize, 2);
+    if (ReadVoxels(OutputObjectFileName, spliced) != frames || spliced.Version != itk::VERSION7 ||
+        spliced.Dimensions[3] != 3 || spliced.BigEndian || spliced.Entries.size() != 3 ||
+        splicer.GetNumberOfCopiedBytes() + splicer.GetNumberOfEncodedBytes() !=
+          static_cast<itk::SizeValueType>(itksys::SystemTools::FileLength(OutputObjectFileName)) - spliced.DataOffset)
+    {
+      std::cerr << "The frames were spliced wrongly" << std::endl;
+      error_count++;
+    }
+
+    // Frame 1 is replaced, then frames 2 and 3 are written from frames 0 and 1, which appends frame 3.
+    splicer.ReplaceFrames(OutputObjectFileName, 1, voxels.data(), 1);
+    splicer.ReplaceFrames(OutputObjectFileName, 2, frames.data(), 2);
+    std::vector<unsigned char> expected(frames.begin(), frames.begin() + frameSize);
+    expected.insert(expected.end(), voxels.begin(), voxels.end());
+    expected.insert(expected.end(), frames.begin(), frames.begin() + frameSize * 2);
+    if (ReadVoxels(OutputObjectFileName, spliced) != expected || spliced.Dimensions[3] != 4)
+    {
+      std::cerr << "A frame was not appended while replacing frames" << std::endl;
+      error_count++;
+    }
+  }
+  catch (itk::ExceptionObject & err)
+  {
+    std::cerr << "ExceptionObject caught !" << std::endl << err << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Planes past the end, and frames that would leave a gap, are refused and leave the file as it is.
+  const itk::SizeValueType   length = itksys::SystemTools::FileLength(OutputObjectFileName);
+  int                        caught = 0;
+  std::vector<unsigned char> frame(frameSize);
+  try
+  {
+    splicer.ReplacePlanes(OutputObjectFileName, 11, frame.data(), 2);
+  }
+  catch (itk::ExceptionObject &)
+  {
+    caught++;
+  }
+  try
+  {
+    splicer.ReplaceFrames(OutputObjectFileName, 5, frame.data(), 1);
+  }
+  catch (itk::ExceptionObject &)
+  {
+    caught++;
+  }
+  if (caught != 2 || itksys::SystemTools::FileLength(OutputObjectFileName) != length)
+  {
+    std::cerr << "An invalid splice was not refused" << std::endl;
+    error_count++;
+  }
+
+  if (error_count)
+  {
+    std::cerr << error_count << " errors splicing object maps" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
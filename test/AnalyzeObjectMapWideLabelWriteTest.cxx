@@ -0,0 +1,189 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#  pragma warning(disable : 4786)
+#endif
+
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+
+#include "itkAnalyzeObjectLabelMapImageIO.h"
+#include "itkAnalyzeObjectMap.h"
+#include "itkAnalyzeObjectLabelMapImageIOFactory.h"
+
+#include <limits>
+
+// Writes label images with wider pixel types and checks that they are narrowed, or compacted
+// when their values do not fit into an unsigned char.
+int
+AnalyzeObjectMapWideLabelWriteTest(int ac, char * av[])
+{
+  if (ac != 3)
+  {
+    std::cerr << "USAGE: " << av[0] << " <narrowedFileName> <compactedFileName>" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const char * NarrowedFileName = av[1];
+  const char * CompactedFileName = av[2];
+
+  using WideImageType = itk::Image<unsigned short, 3>;
+  using ImageType = itk::Image<unsigned char, 3>;
+  using WideWriterType = itk::ImageFileWriter<WideImageType>;
+  using ReaderType = itk::ImageFileReader<ImageType>;
+
+  itk::ObjectFactoryBase::RegisterFactory(itk::AnalyzeObjectLabelMapImageIOFactory::New());
+
+  WideImageType::Pointer         WideImage = WideImageType::New();
+  const WideImageType::SizeType  size = { { 300, 7, 3 } };
+  const WideImageType::IndexType orgin = { { 0, 0, 0 } };
+  WideImageType::RegionType      region;
+  region.SetSize(size);
+  region.SetIndex(orgin);
+  WideImage->SetRegions(region);
+  WideImage->Allocate();
+
+  // Values below 256: every voxel of a row gets the row number, so runs longer than 255 voxels are produced.
+  itk::ImageRegionIterator<WideImageType> wideIt(WideImage, region);
+  for (wideIt.GoToBegin(); !wideIt.IsAtEnd(); ++wideIt)
+  {
+    wideIt.Set(static_cast<unsigned short>(wideIt.GetIndex()[1] + 10 * wideIt.GetIndex()[2]));
+  }
+
+  WideWriterType::Pointer WideWriter = WideWriterType::New();
+  WideWriter->SetInput(WideImage);
+  WideWriter->SetFileName(NarrowedFileName);
+  ReaderType::Pointer Reader = ReaderType::New();
+  Reader->SetFileName(NarrowedFileName);
+  try
+  {
+    WideWriter->Update();
+    Reader->Update();
+  }
+  catch (itk::ExceptionObject & err)
+  {
+    std::cerr << "ExceptionObject caught !" << std::endl << err << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  int                                     error_count = 0;
+  itk::ImageRegionConstIterator<ImageType> readIt(Reader->GetOutput(), region);
+  for (wideIt.GoToBegin(), readIt.GoToBegin(); !wideIt.IsAtEnd(); ++wideIt, ++readIt)
+  {
+    if (wideIt.Get() != readIt.Get())
+    {
+      error_count++;
+    }
+  }
+  if (error_count)
+  {
+    std::cerr << error_count << " voxels differ after writing an unsigned short image" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Values above 255: three labels that must be compacted to 0, 1 and 2.
+  for (wideIt.GoToBegin(); !wideIt.IsAtEnd(); ++wideIt)
+  {
+    wideIt.Set(static_cast<unsigned short>(1000 * (wideIt.GetIndex()[2])));
+  }
+  itk::AnalyzeObjectLabelMapImageIO::Pointer WriteIO = itk::AnalyzeObjectLabelMapImageIO::New();
+  WideWriter->SetImageIO(WriteIO);
+  WideWriter->SetFileName(CompactedFileName);
+  Reader->SetFileName(CompactedFileName);
+  try
+  {
+    WideWriter->Update();
+    Reader->Update();
+  }
+  catch (itk::ExceptionObject & err)
+  {
+    std::cerr << "ExceptionObject caught !" << std::endl << err << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const itk::AnalyzeObjectLabelMapImageIO::LabelCompactionTableType & table = WriteIO->GetLabelCompactionTable();
+  if (table.size() != 3 || table[0] != 0 || table[1] != 1000 || table[2] != 2000)
+  {
+    std::cerr << "Unexpected label compaction table" << std::endl;
+    return EXIT_FAILURE;
+  }
+  for (wideIt.GoToBegin(), readIt.GoToBegin(); !wideIt.IsAtEnd(); ++wideIt, ++readIt)
+  {
+    if (table[readIt.Get()] != wideIt.Get())
+    {
+      error_count++;
+    }
+  }
+
+  itk::AnalyzeObjectMap<ImageType>::Pointer ObjectMap = itk::AnalyzeObjectMap<ImageType>::New();
+  ObjectMap->ImageToObjectMap(Reader->GetOutput());
+  if (ObjectMap->GetNumberOfObjects() != 3 || ObjectMap->GetObjectEntry(2)->GetName() != "Label 2000")
+  {
+    std::cerr << "The compacted labels were not written as object entries" << std::endl;
+    error_count++;
+  }
+
+  // Without compaction the same image has to be rejected.
+  WriteIO->UseLabelCompactionOff();
+  bool caught = false;
+  try
+  {
+    WideWriter->Update();
+  }
+  catch (itk::ExceptionObject &)
+  {
+    caught = true;
+  }
+  if (!caught)
+  {
+    std::cerr << "Writing values above 255 without compaction did not throw" << std::endl;
+    error_count++;
+  }
+
+  // An unsigned value above the largest long long cannot be compacted, and must not wrap around.
+  using HugeImageType = itk::Image<unsigned long long, 3>;
+  HugeImageType::Pointer HugeImage = HugeImageType::New();
+  HugeImage->SetRegions(region);
+  HugeImage->Allocate();
+  HugeImage->FillBuffer(0);
+  HugeImage->GetBufferPointer()[0] = std::numeric_limits<unsigned long long>::max();
+  itk::ImageFileWriter<HugeImageType>::Pointer HugeWriter = itk::ImageFileWriter<HugeImageType>::New();
+  HugeWriter->SetInput(HugeImage);
+  HugeWriter->SetImageIO(itk::AnalyzeObjectLabelMapImageIO::New());
+  HugeWriter->SetFileName(CompactedFileName);
+  caught = false;
+  try
+  {
+    HugeWriter->Update();
+  }
+  catch (itk::ExceptionObject &)
+  {
+    caught = true;
+  }
+  if (!caught)
+  {
+    std::cerr << "Writing an unsigned value above the largest long long did not throw" << std::endl;
+    error_count++;
+  }
+
+  if (error_count)
+  {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
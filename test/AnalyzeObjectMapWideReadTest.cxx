@@ -0,0 +1,112 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#if defined(_MSC_VER)
+#  pragma warning(disable : 4786)
+#endif
+
+#include "itkImageFileReader.h"
+
+#include "itkAnalyzeObjectLabelMapImageIO.h"
+#include "itkAnalyzeObjectLabelMapImageIOFactory.h"
+
+#include <vector>
+
+// Reads an object map into unsigned char, unsigned short and float buffers and checks that
+// they all hold the same labels.
+int
+AnalyzeObjectMapWideReadTest(int ac, char * av[])
+{
+  if (ac != 2)
+  {
+    std::cerr << "USAGE: " << av[0] << " <inputFileName>" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const char * InputObjectFileName = av[1];
+
+  using ImageType = itk::Image<unsigned char, 3>;
+  using WideImageType = itk::Image<unsigned short, 3>;
+  using ReaderType = itk::ImageFileReader<ImageType>;
+  using WideReaderType = itk::ImageFileReader<WideImageType>;
+
+  itk::ObjectFactoryBase::RegisterFactory(itk::AnalyzeObjectLabelMapImageIOFactory::New());
+
+  ReaderType::Pointer Reader = ReaderType::New();
+  Reader->SetFileName(InputObjectFileName);
+
+  itk::AnalyzeObjectLabelMapImageIO::Pointer WideIO = itk::AnalyzeObjectLabelMapImageIO::New();
+  WideIO->SetOutputComponentType(itk::IOComponentEnum::USHORT);
+  WideReaderType::Pointer WideReader = WideReaderType::New();
+  WideReader->SetImageIO(WideIO);
+  WideReader->SetFileName(InputObjectFileName);
+  try
+  {
+    Reader->Update();
+    WideReader->Update();
+  }
+  catch (itk::ExceptionObject & err)
+  {
+    std::cerr << "ExceptionObject caught !" << std::endl << err << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (WideIO->GetComponentType() != itk::IOComponentEnum::USHORT)
+  {
+    std::cerr << "The requested output component type was not reported" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Decode once more into a buffer that is not owned by an ITK image.
+  itk::AnalyzeObjectLabelMapImageIO::Pointer BufferIO = itk::AnalyzeObjectLabelMapImageIO::New();
+  BufferIO->SetFileName(InputObjectFileName);
+  std::vector<float> FloatBuffer;
+  try
+  {
+    BufferIO->ReadImageInformation();
+    FloatBuffer.resize(BufferIO->GetImageSizeInPixels());
+    BufferIO->ReadToBuffer(FloatBuffer.data(), itk::IOComponentEnum::FLOAT);
+  }
+  catch (itk::ExceptionObject & err)
+  {
+    std::cerr << "ExceptionObject caught !" << std::endl << err << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  int                                          error_count = 0;
+  const ImageType::RegionType                  region = Reader->GetOutput()->GetLargestPossibleRegion();
+  itk::ImageRegionConstIterator<ImageType>     it(Reader->GetOutput(), region);
+  itk::ImageRegionConstIterator<WideImageType> wideIt(WideReader->GetOutput(), region);
+  size_t                                       bufferIndex = 0;
+  for (it.GoToBegin(), wideIt.GoToBegin(); !it.IsAtEnd(); ++it, ++wideIt, ++bufferIndex)
+  {
+    if (it.Get() != wideIt.Get() || it.Get() != FloatBuffer[bufferIndex])
+    {
+      error_count++;
+    }
+  }
+  if (bufferIndex != FloatBuffer.size())
+  {
+    error_count++;
+  }
+
+  if (error_count)
+  {
+    std::cerr << error_count << " voxels differ between the decoded pixel types" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}